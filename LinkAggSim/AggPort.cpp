@@ -21,8 +21,16 @@ limitations under the License.
 // const unsigned char defaultPortState = 0x43; 
 
 AggPort::AggPort(unsigned char version, unsigned short systemNum, unsigned short portNum)
-	: Aggregator(version, systemNum, portNum)
+	: Aggregator(version, systemNum, portNum),
+	currentWhileTimer(timerSlot, CURRENT_WHILE),
+	waitWhileTimer(timerSlot, WAIT_WHILE),
+	waitToRestoreTimer(timerSlot, WAIT_TO_RESTORE),
+	periodicTimer(timerSlot, PERIODIC),
+	txLimitTimer(timerSlot, TX_LIMIT)
 {
+	timerSlot.pBank = make_shared<TimerBank>(numTimers);          // Private bank until the port's LinkAgg moves it to a shared bank
+	timerSlot.index = timerSlot.pBank->addSlot();
+
 	PortEnabled = false;                                           // Set by Receive State Machine based on ISS.Operational
 	LacpEnabled = true;                                            //TODO:  what changes LacpEnabled?
 	newPartner = false;
@@ -63,6 +71,7 @@ AggPort::AggPort(unsigned char version, unsigned short systemNum, unsigned short
 	//TODO:  LACPv2 variables
 	enableLongLacpduXmit = true;
 	longLacpduXmit = true;
+	currentWhileLongLacpTimer = 50;                  // Long LACPDUs until LinkAgg clears longLacpduXmit (timer is not ticked)
 	waitToRestoreTime = 0;
 	wtrRevertiveMode = true;
 	wtrRevertOK = true;
@@ -132,6 +141,7 @@ void AggPort::reset()
 	changePortLinkState = false;
 
 	longLacpduXmit = true;            // controlled by LinkAgg
+	currentWhileLongLacpTimer = 50;
 
 	portOperConversationMask.reset();
 	distributionConversationMask.reset();
@@ -148,6 +158,28 @@ void AggPort::timerTick()
 	AggPort::LacpTxSM::timerTick(*this);
 }
 
+int AggPort::nextWakeup() const
+{
+	int wakeup = SimLog::Never;
+
+	for (int timer : { (int)currentWhileTimer, (int)waitWhileTimer, (int)waitToRestoreTimer, (int)periodicTimer, (int)txLimitTimer })
+	{
+		if (timer > 0)                                          // A timer at value n reaches zero n-1 ticks from now,
+			wakeup = std::min(wakeup, SimLog::Time + timer - 1);  //    since timerTick() precedes run() in every tick
+	}
+	return (wakeup);
+}
+
+void AggPort::skipTicks(int ticks)
+{
+	currentWhileTimer = std::max(0, currentWhileTimer - ticks);
+	waitWhileTimer = std::max(0, waitWhileTimer - ticks);
+	waitToRestoreTimer = std::max(0, waitToRestoreTimer - ticks);
+	periodicTimer = std::max(0, periodicTimer - ticks);
+	txLimitTimer = std::max(0, txLimitTimer - ticks);
+	// currentWhileLongLacpTimer is not ticked by timerTick()
+}
+
 void AggPort::run(bool singleStep)
 {
 	AggPort::LacpRxSM::run(*this, singleStep);
@@ -377,7 +409,7 @@ void AggPort::set_aAggPortWTRTime(unsigned short wtr)
 {
 	waitToRestoreTime = wtr & 0x7fff;
 	wtrRevertiveMode = ((wtr & 0x8000) == 0);
-	if (SimLog::Debug > 4)
+	if (SimLog::debug<4>())
 	{
 		SimLog::logFile << "Time " << SimLog::Time << ":   Device:Port " << hex << actorSystem.addrMid
 			<< ":" << actorPort.num << " setting WTR to 0x" << wtr << dec
@@ -435,4 +467,27 @@ std::bitset<4096> AggPort::get_aAggPortPartnerAdminConversationMask()
 	return(partnerAdminConversationMask);
 }
 
+unsigned long long AggPort::get_aAggPortStatsLACPDUsRx()
+{
+	return (lacpdusRx.get());
+}
+
+unsigned long long AggPort::get_aAggPortStatsLACPDUsTx()
+{
+	return (lacpdusTx.get());
+}
+
+unsigned long long AggPort::get_stateMachineTransitions()
+{
+	return (stateMachineTransitions.get());
+}
+
+void AggPort::clearStatistics()
+{
+	Aggregator::clearStatistics();
+	lacpdusRx.clear();
+	lacpdusTx.clear();
+	stateMachineTransitions.clear();
+}
+
 
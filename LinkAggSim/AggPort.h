@@ -18,6 +18,8 @@ limitations under the License.
 #include "Mac.h"
 #include "Aggregator.h"
 #include "Lacpdu.h"
+#include "TimerBank.h"
+#include "ConversationMask.h"
 
 class Lacpdu;
 
@@ -25,6 +27,7 @@ class Lacpdu;
 class AggPort : public Aggregator
 {
 	friend class LinkAgg;
+	friend class TraceLog;
 
 public:
 	AggPort(unsigned char version = 2, unsigned short systemNum = 0, unsigned short portNum = 0);
@@ -37,8 +40,14 @@ public:
 	void reset();
 	void timerTick();
 	void run(bool singleStep);
+	int nextWakeup() const;              // Earliest Time at which a running state machine timer expires (Never if none running)
+	void skipTicks(int ticks);           // Advances all state machine timers as if timerTick() was called "ticks" times
+
+	enum timerIds { CURRENT_WHILE, WAIT_WHILE, WAIT_TO_RESTORE, PERIODIC, TX_LIMIT, numTimers };
 
 private:
+	TimerBank::Slot timerSlot;           // State machine timers are kept in a TimerBank (shared by all ports of a LinkAgg)
+
 	static const int fastPeriodicTime = 1900;
 	static const int slowPeriodicTime = 3 * fastPeriodicTime;
 	static const int shortTimeout = 3 * fastPeriodicTime;
@@ -92,12 +101,12 @@ private:
 	unsigned short adminLinkNumberID;
 	unsigned short LinkNumberID;
 	unsigned short partnerLinkNumberID;
-	std::bitset<4096> compOperConversationMask;
-	std::bitset<4096> portOperConversationMask;
-	std::bitset<4096> distributionConversationMask;
-	std::bitset<4096> collectionConversationMask;
-	std::bitset<4096> partnerAdminConversationMask;
-	std::bitset<4096> partnerOperConversationMask;
+	ConversationMask compOperConversationMask;
+	ConversationMask portOperConversationMask;
+	ConversationMask distributionConversationMask;
+	ConversationMask collectionConversationMask;
+	ConversationMask partnerAdminConversationMask;
+	ConversationMask partnerOperConversationMask;
 	bool actorPartnerSync;
 	bool partnerActorPartnerSync;
 	bool actorDWC;
@@ -106,6 +115,10 @@ private:
 	bool actorAttached;
 	bool updateLocal;
 
+	StatCounter lacpdusRx;
+	StatCounter lacpdusTx;
+	StatCounter stateMachineTransitions;  // Transitions taken by the Rx, Mux, Periodic, and Tx state machines
+
 	std::array<unsigned char, 16> actorOperConversationLinkListDigest;
 	std::array<unsigned char, 16> partnerOperConversationLinkListDigest;
 	std::array<unsigned char, 16> actorOperConversationServiceMappingDigest;
@@ -174,6 +187,11 @@ public:
 	void set_aAggPortPartnerAdminConversationMask(std::bitset<4096> mask);  // No managed object for this in standard
 	std::bitset<4096> get_aAggPortPartnerAdminConversationMask();
 
+	unsigned long long get_aAggPortStatsLACPDUsRx();
+	unsigned long long get_aAggPortStatsLACPDUsTx();
+	unsigned long long get_stateMachineTransitions();                       // not in standard
+	void clearStatistics();
+
 private:
 
 	static class LacpRxSM
@@ -218,7 +236,7 @@ private:
 	};
 
 	LacpRxSM::RxSmStates RxSmState;
-	int currentWhileTimer;
+	BankTimer currentWhileTimer;
 
 
 	static class LacpMuxSM
@@ -257,8 +275,8 @@ private:
 	};
 
 	LacpMuxSM::MuxSmStates MuxSmState;
-	int waitWhileTimer;
-	int waitToRestoreTimer;
+	BankTimer waitWhileTimer;
+	BankTimer waitToRestoreTimer;
 
 	static class LacpPeriodicSM
 	{
@@ -284,7 +302,7 @@ private:
 	};
 
 	LacpPeriodicSM::PerSmStates PerSmState;
-	int periodicTimer;
+	BankTimer periodicTimer;
 
 
 
@@ -315,7 +333,7 @@ private:
 
 	LacpTxSM::TxSmStates TxSmState;
 	int txCount;
-	int txLimitTimer;
+	BankTimer txLimitTimer;
 
 
 
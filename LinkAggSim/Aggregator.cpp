@@ -63,6 +63,7 @@ Aggregator::Aggregator(unsigned char version, unsigned short systemNum, unsigned
 	changeLinkState = false;
 	changeAggregationLinks = false;
 	changeCSDC = false;
+	changeDistributing = false;
 
 	//  cout << "Aggregator Constructor called." << endl;
 	//	SimLog::logFile << "Aggregator Constructor called." << endl;
@@ -117,8 +118,9 @@ void Aggregator::reset()
 	differentPortConversationDigests = false;
 	operDiscardWrongConversation = false;
 	activeLagLinks.clear();
-	conversationLinkVector.fill(0);
-	conversationPortVector.fill(0);
+	pConversationVectors.reset();
+	linkConversations.clear();
+	linkPorts.clear();
 
 	changeActorDistAlg = false;
 	changeConvLinkList = false;
@@ -127,6 +129,7 @@ void Aggregator::reset()
 	changeLinkState = false;
 	changeAggregationLinks = false;
 	changeCSDC = false;
+	changeDistributing = false;
 }
 
 bool Aggregator::digestIsNull(std::array<unsigned char, 16>& digest)
@@ -255,7 +258,27 @@ bool Aggregator::get_aAggAggregateOrIndividual()
 
 std::list<unsigned short> Aggregator::get_aAggPortList()   
 {
-	return (selectedLagPorts);  // List of Aggregation Port Identifiers attached to this aggregator  //TODO:  currently list includes selected or attached
+	return (std::list<unsigned short>(selectedLagPorts.begin(), selectedLagPorts.end()));  // List of Aggregation Port Identifiers attached to this aggregator  //TODO:  currently list includes selected or attached
+}
+
+unsigned long long Aggregator::get_aAggFramesTxOK()
+{
+	return (framesTxOK.get());
+}
+
+unsigned long long Aggregator::get_aAggFramesRxOK()
+{
+	return (framesRxOK.get());
+}
+
+unsigned long long Aggregator::get_aAggFramesDiscardedOnTx()
+{
+	return (framesDiscardedOnTx.get());
+}
+
+unsigned long long Aggregator::get_aAggFramesDiscardedOnRx()
+{
+	return (framesDiscardedOnRx.get());
 }
 
 
@@ -387,9 +410,23 @@ std::array<unsigned char, 16>Aggregator::get_aAggConversationListDigest()
 
 
 
+Aggregator::ConversationVectors::ConversationVectors()
+{
+	conversationLinkVector.fill(0);
+	conversationPortVector.fill(0);
+	conversationEgressPort.fill(-1);
+}
+
+Aggregator::ConversationVectors& Aggregator::conversationVectors()
+{
+	if (!pConversationVectors)
+		pConversationVectors = make_unique<ConversationVectors>();
+	return (*pConversationVectors);
+}
+
 unsigned short Aggregator::get_conversationLink(unsigned short cid)
 {
-	return (conversationLinkVector[cid]);
+	return (pConversationVectors ? pConversationVectors->conversationLinkVector[cid] : 0);
 }
 
 Aggregator::portAlgorithms Aggregator::get_aAggPartnerPortAlgorithm()
@@ -434,6 +471,14 @@ std::array<unsigned char, 16> Aggregator::get_aAggPartnerOperConversationListDig
 	return (partnerConversationLinkListDigest);
 }
 
+void Aggregator::clearStatistics()
+{
+	framesTxOK.clear();
+	framesRxOK.clear();
+	framesDiscardedOnTx.clear();
+	framesDiscardedOnRx.clear();
+}
+
 
 /*
 // Not in standard:
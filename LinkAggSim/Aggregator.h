@@ -16,6 +16,8 @@ limitations under the License.
 
 #pragma once
 #include "Mac.h"
+#include "PortList.h"
+#include "Metrics.h"
 
 const unsigned short defaultActorKey = 0x0088;
 const unsigned short defaultPartnerKey = 0x0070;
@@ -77,6 +79,7 @@ class Aggregator : public IssQ
 	friend class AggPort;
 	friend class LinkAgg;
 	friend class DistributedRelay;
+	friend class TraceLog;
 
 
 public:
@@ -111,8 +114,8 @@ protected:
 	unsigned short partnerOperAggregatorKey;
 	bool receiveState;
 	bool transmitState;
-	std::list<unsigned short> lagPorts;              // List of Aggregation Port index for all ports attached or selected
-	std::list<unsigned short> selectedLagPorts;      // List of Aggregation Port Identifiers for all ports attached or selected
+	PortList lagPorts;                               // List of Aggregation Port index for all ports attached or selected
+	PortList selectedLagPorts;                       // List of Aggregation Port Identifiers for all ports attached or selected
 	unsigned short collectorMaxDelay;
 
 	bool aggregatorReady;
@@ -147,11 +150,25 @@ protected:
 	bool differentConversationServiceDigests;
 	bool differentPortAlgorithms;
 	bool differentPortConversationDigests;
-	std::list<unsigned short> activeLagLinks;  // contains Link Number ID if AggPort attached and distributing, else Link Number = 0
-	std::array<unsigned short, 4096> conversationLinkVector;  // Contains LinkNumberID of AggPort for each Conversation ID.
-	std::array<unsigned short, 4096> conversationPortVector;  // Contains PortNumber of AggPort for each Conversation ID.
+	PortList activeLagLinks;                   // contains Link Number ID if AggPort attached and distributing, else Link Number = 0
+	struct ConversationVectors                                    // Per-Conversation ID tables, only needed while the LAG has active links
+	{
+		ConversationVectors();
+		std::array<unsigned short, 4096> conversationLinkVector;  // Contains LinkNumberID of AggPort for each Conversation ID.
+		std::array<unsigned short, 4096> conversationPortVector;  // Contains PortNumber of AggPort for each Conversation ID.
+		std::array<short, 4096> conversationEgressPort;           // Index (in LinkAgg pAggPorts) of the egress port for each Conversation ID, or -1.
+	};
+	unique_ptr<ConversationVectors> pConversationVectors;         // Null is equivalent to all entries cleared
+	ConversationVectors& conversationVectors();                   // Allocates the vectors on first use
+	std::map<unsigned short, std::vector<unsigned short>> linkConversations;  // Conversation IDs for each Link Number (inverse of conversationLinkVector)
+	std::map<unsigned short, unsigned short> linkPorts;       // PortNumber of AggPort for each Link Number used in conversationPortVector
 	convLinkMaps selectedconvLinkMap;
 
+	StatCounter framesTxOK;
+	StatCounter framesRxOK;
+	StatCounter framesDiscardedOnTx;
+	StatCounter framesDiscardedOnRx;
+
 
 	static bool digestIsNull(std::array<unsigned char, 16>& digest);
 
@@ -178,7 +195,10 @@ public:
 	unsigned short get_aAggCollectorMaxDelay();
 	bool get_aAggAggregateOrIndividual();
 	std::list<unsigned short> get_aAggPortList();             // List of Aggregation Port Identifiers attached to this aggregator  //TODO:  currently list includes selected or attached
-	//TODO:   maybe add all statistics counter attributes
+	unsigned long long get_aAggFramesTxOK();                  // Frames distributed to an Aggregation Port
+	unsigned long long get_aAggFramesRxOK();                  // Frames collected and passed to the Aggregator client
+	unsigned long long get_aAggFramesDiscardedOnTx();         // Frames with no Aggregation Port for their Conversation ID
+	unsigned long long get_aAggFramesDiscardedOnRx();         // Frames discarded by Discard Wrong Conversation
 
 	// Version 2 attributes
 	void set_aAggPortAlgorithm(portAlgorithms alg);
@@ -210,6 +230,7 @@ public:
 	convLinkMaps get_convLinkMap();
 	std::array<unsigned char, 16> get_aAggOperConversationListDigest();
 	std::array<unsigned char, 16> get_aAggPartnerOperConversationListDigest();
+	void clearStatistics();
 
 	/*
 	portAlgorithms get_aAggPartnerPortAlgorithm();
@@ -18,10 +18,15 @@ limitations under the License.
 #include "Bridge.h"
 
 
+const unsigned long long groupAddressBit = 0x010000000000;   // I/G bit of the first octet of a MAC address
+
+
 Bridge::Bridge(unsigned short devNum, unsigned short sysNum, int nPorts)
 	: Component(ComponentTypes::BRIDGE)
 {
 	vlanType = 0;   // Type = 0 means MAC Bridge.  Can change to CVlanEthertype or SVlanEthertype
+	maxHops = 0;    // Loop guard disabled
+	loopDiscards = 0;
 	SystemId.id = defaultBrdgAddr + (0x10000 * devNum) + (0x1000 * sysNum);
 
 	for (int i = 0; i < nPorts; i++)
@@ -40,7 +45,7 @@ Bridge::~Bridge()
 
 void Bridge::reset()
 {
-	//TODO:
+	fdb.clear();
 }
 
 
@@ -53,33 +58,226 @@ void Bridge::timerTick()
 }
 
 
+int Bridge::nextWakeup() const
+{
+	return (SimLog::Never);          // No timers.  Received frames wake up the Device through the Mac or LinkAgg they arrive on.
+}
+
 void Bridge::run(bool singleStep)
 {
 	if (!suspended)
 	{
-		for (auto& ingress : bPorts)                            // For each BridgePort that may have an ingress Frame
+		for (unsigned short inPort = 0; inPort < bPorts.size(); inPort++)   // For each BridgePort that may have an ingress Frame
 		{
+			auto& ingress = bPorts[inPort];
 			unique_ptr<Frame> thisFrame = nullptr;              //      Check for an ingress Frame
 			if (ingress->pIss)
 			{
 				thisFrame = std::move(ingress->pIss->Indication());
 			}
-			if (thisFrame)                                      //      If there is an ingress frame
+			if (!thisFrame)                                     //      If there is no ingress frame
+				continue;                                       //         Then go on to next port
+
+			if (maxHops && (thisFrame->HopCount >= maxHops))    //      If loop guard enabled and frame has been relayed too often
+			{
+				loopDiscards++;                                 //         Then count and discard the frame
+				continue;
+			}
+			if (thisFrame->HopCount < 0xff)
+				thisFrame->HopCount++;                          //      Every copy transmitted carries the incremented count
+
+			unsigned short vid = classify(*thisFrame, *ingress);
+			const VlanMembers* pVlan = findVlan(vid);
+			if (pVlan && !pVlan->members.contains(inPort))      //      If ingress port is not in the VLAN's member set
+				continue;                                       //         Then discard the frame
+			if (pVlan && isTagged(*thisFrame) && (VlanTag::getVlanTag(*thisFrame).Vtag.id != vid))
+			{                                                   //      If priority-tagged then tag the frame with its VLAN
+				const VlanTag& tag = VlanTag::getVlanTag(*thisFrame);
+				thisFrame = thisFrame->RemoveTag()->InsertTag(FramePool::makeShared<VlanTag>(vlanType, vid, tag.Vtag.pri, tag.Vtag.de));
+			}
+
+			if (!(thisFrame->MacSA & groupAddressBit))
+				fdb.learn(thisFrame->MacSA, vid, inPort);       //      Learn the port for its source address
+
+			int outPort = -1;
+			if (!(thisFrame->MacDA & groupAddressBit))
+				outPort = fdb.lookup(thisFrame->MacDA, vid);    //      and look up the port for its destination address
+			if ((outPort >= 0) && (!bPorts[outPort]->pIss || !bPorts[outPort]->pIss->getOperational() ||
+				(pVlan && !pVlan->members.contains(outPort))))
+				outPort = -1;                                   //      Can only use a learned port that can transmit on the VLAN
+
+			if (outPort == inPort)                              //      If destination is on the ingress port
+			{
+				thisFrame = nullptr;                            //         Then discard the frame
+			}
+			else if (outPort >= 0)                              //      Else if destination known then transmit on that port
 			{
+				if (pVlan)
+				{
+					unique_ptr<Frame> pConverted = nullptr;
+					transmitOnVlan(outPort, *thisFrame, vid, *pVlan, pConverted);
+				}
+				else
+					bPorts[outPort]->pIss->Request(move(thisFrame));
+			}
+			else if (pVlan)                                     //      Otherwise flood to VLAN's other operational member ports
+			{
+				unique_ptr<Frame> pConverted = nullptr;
+				for (auto port : pVlan->members)
+				{
+					if ((port != inPort) && (port < bPorts.size()) &&
+						bPorts[port]->pIss && bPorts[port]->pIss->getOperational())
+					{
+						transmitOnVlan(port, *thisFrame, vid, *pVlan, pConverted);
+					}
+				}
+			}
+			else                                                //      Or if VLAN not configured flood to all other ports:
+			{
+				Iss* pLastEgress = nullptr;
 				for (auto& egress : bPorts)
 				{
 					if ((ingress != egress) &&
-						egress->pIss && egress->pIss->getOperational())  // Then at every other operational BridgePort
+						egress->pIss && egress->pIss->getOperational())  // At every other operational BridgePort
 					{
-						unique_ptr<Frame> frameCopy = make_unique<Frame>(*thisFrame);  // Transmit a copy of the frame
-						egress->pIss->Request(move(frameCopy));
+						if (pLastEgress)
+							pLastEgress->Request(make_unique<Frame>(*thisFrame));  // Transmit a copy of the frame
+						pLastEgress = egress->pIss.get();
 					}
 				}
+				if (pLastEgress)
+					pLastEgress->Request(move(thisFrame));      //         The last port gets the original rather than a copy
 			}
 		}
 	}
 }
 
+void Bridge::transmitOnVlan(unsigned short port, const Frame& thisFrame, unsigned short vid, const VlanMembers& vlan,
+	unique_ptr<Frame>& pConverted)
+{
+	bool tagged = isTagged(thisFrame);
+	if (tagged == vlan.untagged.contains(port))              // If the port needs the frame in the other format
+	{
+		if (!pConverted)                                      //    Then make that format once for all such ports
+		{
+			if (tagged)
+				pConverted = thisFrame.RemoveTag();
+			else
+				pConverted = thisFrame.InsertTag(FramePool::makeShared<VlanTag>(vlanType, vid, thisFrame.Priority, thisFrame.DropEligible));
+		}
+		bPorts[port]->pIss->Request(make_unique<Frame>(*pConverted));
+	}
+	else
+		bPorts[port]->pIss->Request(make_unique<Frame>(thisFrame));
+}
+
+bool Bridge::isTagged(const Frame& thisFrame) const
+{
+	return (vlanType && (thisFrame.getNextEtherType() == vlanType));
+}
+
+unsigned short Bridge::classify(Frame& thisFrame, BridgePort& ingress) const
+{
+	unsigned short vid = 0;
+	if (isTagged(thisFrame))
+		vid = VlanTag::getVlanTag(thisFrame).Vtag.id;
+	if ((vid == 0) && vlanType)                               // Untagged or priority-tagged
+		vid = ingress.pvid;
+	return (vid);
+}
+
+const Bridge::VlanMembers* Bridge::findVlan(unsigned short vid) const
+{
+	if (vlans.empty() || (vid == 0))
+		return (nullptr);
+	auto found = vlans.find(vid);
+	return ((found == vlans.end()) ? nullptr : &found->second);
+}
+
+void Bridge::setVlanMember(unsigned short vid, unsigned short port, bool untagged)
+{
+	VlanMembers& vlan = vlans[vid];
+	if (!vlan.members.contains(port))
+	{
+		vlan.members.push_back(port);
+		vlan.members.sort();
+	}
+	vlan.untagged.remove(port);
+	if (untagged)
+		vlan.untagged.push_back(port);
+}
+
+void Bridge::removeVlanMember(unsigned short vid, unsigned short port)
+{
+	auto found = vlans.find(vid);
+	if (found != vlans.end())
+	{
+		found->second.members.remove(port);
+		found->second.untagged.remove(port);
+	}
+}
+
+void Bridge::removeVlan(unsigned short vid)
+{
+	vlans.erase(vid);
+}
+
+bool Bridge::isVlanMember(unsigned short vid, unsigned short port) const
+{
+	const VlanMembers* pVlan = findVlan(vid);
+	return (!pVlan || pVlan->members.contains(port));       // Every port is a member of an unconfigured VLAN
+}
+
+
+
+/**/
+
+
+FilteringDatabase::FilteringDatabase()
+{
+	agingTime = defaultAgingTime;
+}
+
+FilteringDatabase::~FilteringDatabase()
+{
+	entries.clear();
+}
+
+unsigned long long FilteringDatabase::key(unsigned long long addr, unsigned short vid)
+{
+	return (((unsigned long long)(vid & 0x0fff) << 48) | (addr & 0x0000ffffffffffff));
+}
+
+void FilteringDatabase::learn(unsigned long long addr, unsigned short vid, unsigned short port)
+{
+	Entry& entry = entries[key(addr, vid)];         // Creates the entry if not already there
+	entry.port = port;
+	entry.lastSeen = SimLog::Time;
+}
+
+int FilteringDatabase::lookup(unsigned long long addr, unsigned short vid)
+{
+	auto found = entries.find(key(addr, vid));
+	if (found == entries.end())
+		return (-1);
+	if ((SimLog::Time - found->second.lastSeen) > agingTime)   // Entry has aged out
+	{
+		entries.erase(found);
+		return (-1);
+	}
+	return (found->second.port);
+}
+
+void FilteringDatabase::clear()
+{
+	entries.clear();
+}
+
+size_t FilteringDatabase::size() const
+{
+	return (entries.size());
+}
+
 
 
 /**/
@@ -88,6 +286,7 @@ void Bridge::run(bool singleStep)
 BridgePort::BridgePort()
 {
 	pIss = nullptr;
+	pvid = 0;
 
 //	cout << "BridgePort Constructor called." << endl;
 //	SimLog::logFile << "BridgePort Constructor called." << endl;
@@ -16,6 +16,7 @@ limitations under the License.
 
 #pragma once
 #include "Mac.h"
+#include "PortList.h"
 
 /*
 *   Class BridgePort is a "port" on a Bridge. A "port" is an interface pointing to an ISS Service Access Point.
@@ -33,18 +34,66 @@ public:
 	BridgePort& operator= (const BridgePort&) = delete;      // Disable assignment operator
 
 	shared_ptr<Iss> pIss;
+	unsigned short pvid;          // VLAN Identifier for untagged and priority-tagged frames received on this port (0 for none)
 
 };
 /**/
 
+/*
+*   Class FilteringDatabase holds the dynamic entries learned by a Bridge:  the BridgePort on which each
+*       individual MAC address was last seen as a source address, keyed by address and VLAN Identifier.
+*   Entries are aged lazily.  An entry records the Time it was last refreshed, and a lookup that finds an entry
+*       older than agingTime deletes it and reports the address as unknown, so the Bridge needs no aging timer.
+*/
+/**/
+class FilteringDatabase
+{
+public:
+	FilteringDatabase();
+	~FilteringDatabase();
+	FilteringDatabase(const FilteringDatabase& copySource) = delete;       // Disable copy constructor
+	FilteringDatabase& operator= (const FilteringDatabase&) = delete;      // Disable assignment operator
+
+	static const int defaultAgingTime = 300000;   // Ticks
+
+	int agingTime;
+
+	void learn(unsigned long long addr, unsigned short vid, unsigned short port);
+	int lookup(unsigned long long addr, unsigned short vid);    // BridgePort index, or -1 if unknown
+	void clear();
+	size_t size() const;
+
+private:
+	struct Entry
+	{
+		unsigned short port;
+		int lastSeen;
+	};
+	std::unordered_map<unsigned long long, Entry> entries;      // Keyed by VLAN Identifier and 48 bit address
+
+	static unsigned long long key(unsigned long long addr, unsigned short vid);
+};
+/**/
+
 /*
 *   Class Bridge is a system component that can be contained in a Device.
 *       A  Bridge has two or more BridgePorts.
 *
-*       Currently the Bridge is not VLAN-aware, and does not learn addresses, so it simply
-*           replicates a Frame received at one port to be transmitted on all other ports.
+*       The Bridge learns the source address of each received Frame in a FilteringDatabase, and forwards
+*           a Frame with a known individual destination address only on the port where that address was learned.
+*           Frames with group or unknown destination addresses are replicated to all other ports.
+*       If the Bridge has a vlanType (C-VLAN or S-VLAN) it classifies each received Frame to a VLAN using
+*           the Frame's tag of that type, or the pvid of the ingress port if the Frame is untagged or priority-tagged.
+*           A VLAN configured with setVlanMember has a member set and an untagged set of BridgePorts.  Frames on
+*           such a VLAN are discarded at a port that is not a member, are only transmitted on member ports, and are
+*           tagged or untagged at each egress port as configured (a priority-tagged Frame is transmitted with a tag
+*           carrying its VLAN Identifier).  Frames on a VLAN that has not been configured
+*           (including all Frames of a MAC Bridge) are relayed unchanged to all ports, as by a VLAN-unaware Bridge.
 *       Currently it does not implement any loop prevention protocols, so beware of
 *           generating data frames in a simulation with Bridges connected in a loop!
+*           Setting maxHops enables a loop guard:  each Frame counts the Bridges that relay it, and a Bridge
+*           discards (and counts in loopDiscards) a received Frame that has already been relayed maxHops times.
+*           This keeps looping frames from growing the queues without bound, but does not stop the loop itself.
 */
 /**/
 class Bridge : public Component
@@ -57,12 +106,35 @@ public:
 
 	unsigned short vlanType;
 	sysId SystemId;
+	unsigned char maxHops;             // Loop guard hop limit (0 disables the loop guard)
+	unsigned long long loopDiscards;   // Frames discarded by the loop guard
 	std::vector<unique_ptr<BridgePort>> bPorts;
+	FilteringDatabase fdb;
+
+	void setVlanMember(unsigned short vid, unsigned short port, bool untagged = false);  // Add port to VLAN (configures the VLAN)
+	void removeVlanMember(unsigned short vid, unsigned short port);
+	void removeVlan(unsigned short vid);                  // VLAN becomes unconfigured
+	bool isVlanMember(unsigned short vid, unsigned short port) const;
 
 	void reset();
 	void timerTick();
-	void run(bool singleStep);    // Receives a Frame from each BridgePort, replicates
-	                                    //     and transmits the Frame on all other BridgePorts
+	int nextWakeup() const;
+	void run(bool singleStep);    // Receives a Frame from each BridgePort, learns its source address, and transmits
+	                                    //     the Frame on the BridgePort for its destination address or all other BridgePorts
+
+private:
+	struct VlanMembers
+	{
+		PortList members;                                // BridgePorts in the VLAN's member set, in ascending order
+		PortList untagged;                               // Member BridgePorts that transmit the VLAN's frames untagged
+	};
+	std::map<unsigned short, VlanMembers> vlans;         // Configured VLANs, keyed by VLAN Identifier
+
+	bool isTagged(const Frame& thisFrame) const;               // True if the Frame has a tag of the Bridge's vlanType
+	unsigned short classify(Frame& thisFrame, BridgePort& ingress) const;    // VLAN Identifier of the Frame
+	const VlanMembers* findVlan(unsigned short vid) const;   // nullptr if the VLAN is not configured
+	void transmitOnVlan(unsigned short port, const Frame& thisFrame, unsigned short vid, const VlanMembers& vlan,
+		unique_ptr<Frame>& pConverted);                  // Transmits a copy of the Frame tagged or untagged for the port
 
 };
 /**/
@@ -0,0 +1,126 @@
+/*
+Copyright 2017 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include "stdafx.h"
+#include "ConsoleReport.h"
+
+
+ConsoleReport::ConsoleReport()
+{
+}
+
+
+ConsoleReport::~ConsoleReport()
+{
+}
+
+bool ConsoleReport::lineByLine = true;
+ConsoleReport::modes ConsoleReport::mode = ConsoleReport::DIRECT;
+int ConsoleReport::summaryInterval = 10000;
+int ConsoleReport::nextSummary = SimLog::Never;
+int ConsoleReport::lastSummary = 0;
+std::atomic<unsigned int> ConsoleReport::counts[ConsoleReport::numEvents];
+ConsoleReport::BufferedSink ConsoleReport::buffer;
+
+
+void ConsoleReport::setMode(modes newMode, int interval)
+{
+	flush();                                    // Finish reporting in the old mode
+
+	mode = newMode;
+	lineByLine = (newMode == DIRECT) || (newMode == BUFFERED);
+	summaryInterval = std::max(interval, 1);
+	nextSummary = (newMode == SUMMARY) ? (SimLog::Time + summaryInterval) : SimLog::Never;
+	lastSummary = SimLog::Time;
+	for (auto& eventCount : counts)
+		eventCount.store(0, std::memory_order_relaxed);
+
+	if (newMode == BUFFERED)
+		SimLog::console.rdbuf(&buffer);
+	else
+		SimLog::console.rdbuf(std::cout.rdbuf());
+}
+
+ConsoleReport::modes ConsoleReport::getMode()
+{
+	return (mode);
+}
+
+void ConsoleReport::count(events event)
+{
+	counts[event].fetch_add(1, std::memory_order_relaxed);
+}
+
+void ConsoleReport::update()
+{
+	if (SimLog::Time >= nextSummary)            // Only reached in SUMMARY mode
+	{
+		writeSummary();
+		nextSummary = SimLog::Time + summaryInterval;
+	}
+}
+
+void ConsoleReport::flush()
+{
+	if (mode == BUFFERED)
+		buffer.drain();
+	else if (mode == SUMMARY)
+		writeSummary();
+}
+
+void ConsoleReport::flushBuffer()
+{
+	if (mode == BUFFERED)
+		buffer.drain();
+}
+
+void ConsoleReport::writeSummary()
+{
+	unsigned int eventCounts[numEvents];
+	bool anyEvents = false;
+	for (int i = 0; i < numEvents; i++)
+	{
+		eventCounts[i] = counts[i].exchange(0, std::memory_order_relaxed);
+		anyEvents |= (eventCounts[i] != 0);
+	}
+
+	if (anyEvents)
+	{
+		cout << "Time " << SimLog::Time << ":   Since Time " << lastSummary
+			<< ":  Links connected " << eventCounts[LINK_CONNECT] << "  disconnected " << eventCounts[LINK_DISCONNECT]
+			<< ";  Aggregators UP " << eventCounts[AGGREGATOR_UP] << "  DOWN " << eventCounts[AGGREGATOR_DOWN]
+			<< ";  Ports UP " << eventCounts[PORT_UP] << "  DOWN " << eventCounts[PORT_DOWN] << endl;
+	}
+	lastSummary = SimLog::Time;
+}
+
+void ConsoleReport::BufferedSink::drain()
+{
+	if (pptr() > pbase())
+	{
+		cout.write(pbase(), pptr() - pbase());
+		cout.flush();
+		str(std::string());
+	}
+}
+
+int ConsoleReport::BufferedSink::sync()           // Called for every endl or flush written to SimLog::console
+{
+	if ((size_t)(pptr() - pbase()) >= bufferLimit)
+		drain();
+	return (0);
+}
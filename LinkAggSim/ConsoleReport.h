@@ -0,0 +1,77 @@
+/*
+Copyright 2017 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#pragma once
+#include <atomic>
+
+
+/*
+*   Class ConsoleReport decides how the events reported on the console (links connecting and disconnecting, Aggregators
+*       and Aggregation Ports going UP or DOWN) reach the console window.  The mode is selected at run time:
+*       -- DIRECT:  each event's message is written to SimLog::console as it happens (the default).
+*       -- NONE:  nothing is written.
+*       -- BUFFERED:  each event's message is written to SimLog::console, but the console is only flushed when a
+*             large amount of text has built up, before each scheduled action (which may write to cout directly),
+*             and at the end of each SimulationEngine::runUntil.
+*       -- SUMMARY:  no message is written for individual events.  Instead the number of each kind of event is
+*             written once every summaryInterval ticks (if anything happened), and at the end of each runUntil.
+*   The code reporting an event writes its message only if lineByLine is true, and calls count() in every mode.
+*   setMode, update, and flush are called only from the main thread.  count may be called while Devices run in
+*       parallel;  the counts are totals, so the summaries are the same for any number of threads.
+*/
+/**/
+class ConsoleReport
+{
+public:
+	ConsoleReport();
+	~ConsoleReport();
+	ConsoleReport(ConsoleReport& copySource) = delete;             // Disable copy constructor
+	ConsoleReport& operator= (const ConsoleReport&) = delete;      // Disable assignment operator
+
+	enum modes { DIRECT, NONE, BUFFERED, SUMMARY };
+	enum events { LINK_CONNECT, LINK_DISCONNECT, AGGREGATOR_UP, AGGREGATOR_DOWN, PORT_UP, PORT_DOWN, numEvents };
+
+	static bool lineByLine;                  // True if each event's message is written to SimLog::console (DIRECT or BUFFERED)
+
+	static void setMode(modes newMode, int interval = 10000);   // interval is the ticks between summaries in SUMMARY mode
+	static modes getMode();
+	static void count(events event);
+	static void update();                    // Called each tick:  writes a summary if summaryInterval ticks have passed
+	static void flush();                     // Writes buffered messages or a summary of the events not yet reported
+	static void flushBuffer();               // Writes buffered messages (but not a summary)
+
+private:
+	class BufferedSink : public std::stringbuf     // Holds console text until bufferLimit characters have built up
+	{
+	public:
+		void drain();
+	protected:
+		virtual int sync() override;
+	};
+
+	static const size_t bufferLimit = 0x10000;
+
+	static void writeSummary();
+
+	static modes mode;
+	static int summaryInterval;
+	static int nextSummary;
+	static int lastSummary;                  // Time of the last summary
+	static std::atomic<unsigned int> counts[numEvents];
+	static BufferedSink buffer;
+};
+/**/
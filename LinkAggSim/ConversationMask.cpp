@@ -0,0 +1,136 @@
+/*
+Copyright 2017 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include "stdafx.h"
+#include "ConversationMask.h"
+
+
+const int ConversationMask::nWords;
+
+
+ConversationMask& ConversationMask::operator= (const ConversationMask& other)
+{
+	if (this == &other)
+		return (*this);
+	if (other.pWords)
+		words() = *other.pWords;
+	else
+		pWords.reset();
+	return (*this);
+}
+
+ConversationMask& ConversationMask::operator= (const std::bitset<4096>& mask)
+{
+	if (mask.none())
+	{
+		pWords.reset();
+		return (*this);
+	}
+
+	static const std::bitset<4096> lowWord(~0ULL);
+	std::bitset<4096> remaining = mask;
+	std::array<unsigned long long, nWords>& bits = words();
+	for (int w = 0; w < nWords; w++)            // Take the mask apart 64 bits at a time, starting from Conversation ID 0
+	{
+		bits[w] = (remaining & lowWord).to_ullong();
+		remaining >>= 64;
+	}
+	return (*this);
+}
+
+ConversationMask& ConversationMask::operator&= (const ConversationMask& other)
+{
+	if (pWords)
+	{
+		if (!other.pWords)
+			pWords.reset();
+		else
+		{
+			for (int w = 0; w < nWords; w++)
+				(*pWords)[w] &= (*other.pWords)[w];
+			releaseIfNone();
+		}
+	}
+	return (*this);
+}
+
+bool ConversationMask::operator== (const ConversationMask& other) const
+{
+	if (pWords && other.pWords)
+		return (*pWords == *other.pWords);
+	return (!pWords && !other.pWords);           // Allocated masks are never all zeros
+}
+
+bool ConversationMask::operator[] (size_t cid) const
+{
+	return (pWords && ((((*pWords)[cid / 64]) >> (cid % 64)) & 1));
+}
+
+ConversationMask::operator std::bitset<4096>() const
+{
+	std::bitset<4096> mask;
+	if (pWords)
+	{
+		for (int w = nWords - 1; w >= 0; w--)    // Shift in 64 bits at a time, ending with Conversation IDs 0 to 63
+		{
+			mask <<= 64;
+			mask |= std::bitset<4096>((*pWords)[w]);
+		}
+	}
+	return (mask);
+}
+
+void ConversationMask::set()
+{
+	words().fill(~0ULL);
+}
+
+void ConversationMask::reset()
+{
+	pWords.reset();
+}
+
+void ConversationMask::assign(const std::vector<unsigned short>& convIDs)
+{
+	if (convIDs.empty())
+	{
+		pWords.reset();
+		return;
+	}
+
+	std::array<unsigned long long, nWords>& bits = words();
+	bits.fill(0);
+	for (auto cid : convIDs)
+		bits[cid / 64] |= (1ULL << (cid % 64));
+}
+
+std::array<unsigned long long, ConversationMask::nWords>& ConversationMask::words()
+{
+	if (!pWords)
+		pWords = std::make_unique<std::array<unsigned long long, nWords>>();
+	return (*pWords);
+}
+
+void ConversationMask::releaseIfNone()
+{
+	for (int w = 0; w < nWords; w++)
+	{
+		if ((*pWords)[w])
+			return;
+	}
+	pWords.reset();
+}
@@ -0,0 +1,59 @@
+/*
+Copyright 2017 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#pragma once
+#include <bitset>
+#include <memory>
+#include <array>
+#include <vector>
+
+
+/*
+*   Class ConversationMask is a 4096-bit Conversation ID mask that only allocates storage when some bit is set.
+*       A null mask reads as all zeros, which is the state of every mask on an AggPort that is not attached to an
+*       Aggregator or is not running DRNI/conversation-sensitive operation, so those ports carry a pointer rather 
+*       than 512 octets per mask.  Setting a mask to all zeros releases the storage.
+*   The bits are kept in 64-bit words (bit n in word n / 64, bit position n % 64), so a mask can be built, compared 
+*       and combined a word at a time without depending on the layout of std::bitset.  Conversion to and from 
+*       std::bitset is provided for the management interface and LACPDUs.
+*/
+/**/
+class ConversationMask
+{
+public:
+	static const int nWords = 4096 / 64;
+
+	ConversationMask() = default;
+	ConversationMask& operator= (const ConversationMask& other);
+	ConversationMask& operator= (const std::bitset<4096>& mask);
+	ConversationMask& operator&= (const ConversationMask& other);
+	bool operator== (const ConversationMask& other) const;
+	bool operator[] (size_t cid) const;
+	operator std::bitset<4096>() const;
+	void set();                                  // Set all bits
+	void reset();                                // Clear all bits and release storage
+	void assign(const std::vector<unsigned short>& convIDs);   // Set the listed Conversation IDs and clear all others
+
+private:
+	std::unique_ptr<std::array<unsigned long long, nWords>> pWords;
+
+	std::array<unsigned long long, nWords>& words();           // Allocates storage if there is none
+	void releaseIfNone();                                       // Releases storage if all words are zero
+
+	ConversationMask(const ConversationMask&) = delete;
+};
+/**/
@@ -24,6 +24,7 @@ limitations under the License.
 
 
 unsigned short Device::devCnt = 0;
+unique_ptr<ThreadPool> Device::pThreadPool = make_unique<ThreadPool>(1);
 
 Device::Device(int numMacs)	
 	: Component(ComponentTypes::DEVICE)
@@ -111,6 +112,145 @@ void Device::run(bool singleStep)                 // If not suspended, Make one
 	}
 }
 
+int Device::nextWakeup() const                    // Earliest wakeup time of any Component or Mac (Never if suspended)
+{
+	int wakeup = SimLog::Never;
+
+	if (!suspended)
+	{
+		for (auto& pComp : pComponents)
+		{
+			wakeup = std::min(wakeup, pComp->nextWakeup());
+		}
+		for (auto& pMac : pMacs)
+		{
+			wakeup = std::min(wakeup, pMac->nextWakeup());
+		}
+	}
+	return (wakeup);
+}
+
+void Device::skipTicks(int ticks)                 // If not suspended, Advance timers in all Components and Macs
+{
+	if (!suspended)
+	{
+		for (auto& pComp : pComponents)
+		{
+			pComp->skipTicks(ticks);
+		}
+		for (auto& pMac : pMacs)
+		{
+			pMac->skipTicks(ticks);
+		}
+	}
+}
+
+/*
+*   skipIdleTicks jumps the simulation Time forward to the earliest wakeup time of any Device, so a simulation 
+*      loop does not spend a timerTick/run/transmit pass on every tick in which nothing can change.
+*      Time never advances beyond limit, so the caller can stop at its next scheduled event (e.g. Connect or Disconnect).
+*      Ticks that are skipped are applied to all timers, so the result is identical to running each tick.
+*/
+int Device::skipIdleTicks(std::vector<unique_ptr<Device>>& Devices, int limit)
+{
+	int wakeup = limit;
+
+	for (auto& pDev : Devices)
+	{
+		wakeup = std::min(wakeup, pDev->nextWakeup());
+		if (wakeup <= SimLog::Time)                   // No need to look further if some Device has to run now
+			return (0);
+	}
+
+	int ticks = wakeup - SimLog::Time;
+	for (auto& pDev : Devices)
+	{
+		pDev->skipTicks(ticks);
+	}
+	SimLog::Time = wakeup;
+
+	return (ticks);
+}
+
+/*
+*   tick runs one Time step of the simulation:  timerTick and run in every Device, then transmit in every Device.
+*      With more than one thread the Devices of each phase are spread across the thread pool, and the pool's barrier
+*      between the phases stands in for the end of the loop over Devices.  This gives the same result as running the
+*      Devices one at a time because during the run phase a Device only touches its own Components and Macs (frames
+*      cross between Devices only in the transmit phase, and each Mac only queues to its own link partner).
+*      The one shared resource is the text output, so while running in parallel each Device writes its SimLog::logFile
+*      and SimLog::console messages (and TraceLog records) to its own buffer, and the buffers are copied out in Device order
+*      after the barrier.
+*/
+void Device::tick(std::vector<unique_ptr<Device>>& Devices)
+{
+	if (pThreadPool->getThreadCount() == 1)
+	{
+		for (auto& pDev : Devices)
+		{
+			pDev->timerTick();     // Decrement timers
+			pDev->run(true);       // Run device with single-step true
+		}
+		for (auto& pDev : Devices)
+		{
+			pDev->transmit();
+		}
+		return;
+	}
+
+	pThreadPool->parallelFor(Devices.size(), [&Devices](size_t i)
+	{
+		Device& dev = *Devices[i];
+		std::streambuf* pLogBuf = SimLog::logFile.rdbuf(&dev.logCapture);
+		std::streambuf* pConsoleBuf = SimLog::console.rdbuf(&dev.consoleCapture);
+		TraceBuffer* pTraceBuf = TraceLog::redirect(&dev.traceCapture);
+
+		dev.timerTick();
+		dev.run(true);
+
+		SimLog::logFile.rdbuf(pLogBuf);
+		SimLog::console.rdbuf(pConsoleBuf);
+		TraceLog::redirect(pTraceBuf);
+	});
+
+	for (auto& pDev : Devices)                      // Copy out messages in the order they would have been written serially
+	{
+		std::string text = pDev->logCapture.str();
+		if (!text.empty())
+		{
+			SimLog::logFile << text;
+			pDev->logCapture.str(std::string());
+		}
+		text = pDev->consoleCapture.str();
+		if (!text.empty())
+		{
+			SimLog::console << text;
+			pDev->consoleCapture.str(std::string());
+		}
+		TraceLog::append(pDev->traceCapture);
+	}
+	SimLog::logFile.flush();
+	SimLog::console.flush();
+
+	pThreadPool->parallelFor(Devices.size(), [&Devices](size_t i)
+	{
+		Devices[i]->transmit();
+	});
+}
+
+void Device::setThreadCount(unsigned int nThreads)
+{
+	if (nThreads < 1)
+		nThreads = 1;
+	if (nThreads != pThreadPool->getThreadCount())
+		pThreadPool = make_unique<ThreadPool>(nThreads);
+}
+
+unsigned int Device::getThreadCount()
+{
+	return (pThreadPool->getThreadCount());
+}
+
 void Device::transmit()                           // If not suspended, Transmit a Frame from any Macs in Device with a Frame ready to transmit
 {
 	for (auto& pMac : pMacs)
@@ -129,12 +269,15 @@ void Device::disconnect()                         // Disconnect all Macs in the
 
 
 
-void Device::createBridge(unsigned short type)
+void Device::createBridge(unsigned short type, unsigned short nAggregators)
 {
 	/**/
 	unsigned short sysNum = 0;       // This is a single system device
-	int nPorts = pMacs.size();       // Number of Bridge Ports = number of Macs in Device
-	unique_ptr<Bridge> pBridge = make_unique<Bridge>(devNum, sysNum, nPorts);  // Make a Bridge with a BridgePort for each Mac
+	int nPorts = pMacs.size();       // Number of Aggregation Ports = number of Macs in Device
+	bool paired = (nAggregators == 0);                 // Default is an Aggregation Port/Aggregator pair for each Mac
+	if (paired)
+		nAggregators = nPorts;                         // Number of Bridge Ports = number of Aggregators
+	unique_ptr<Bridge> pBridge = make_unique<Bridge>(devNum, sysNum, nAggregators);  // Make a Bridge with a BridgePort for each Aggregator
 	pBridge->vlanType = type;							               // Set as MAC, C-VLAN, or S-VLAN Bridge
 
 	unsigned char LacpVersion = 2;
@@ -145,14 +288,14 @@ void Device::createBridge(unsigned short type)
 
 	for (unsigned short i = 0; i < nPorts; i++)    // For each Mac:
 	{
-//		shared_ptr<Aggregator> pAggregator = make_shared<Aggregator>();    // Create an Aggregator
-		shared_ptr<AggPort> pAggPort = make_shared<AggPort>(pLag->LacpVersion, sysNum, i);    // Create an Aggregation Port/Aggregator pair
-		pAggPort->setActorSystem(pBridge->SystemId);                       // Assign Aggregation Port/Aggregator to this bridge
-		pBridge->bPorts[i]->pIss = pAggPort;                               // Attach the Aggregation Port/Aggregator to a BridgePort
-		pAggPort->pIss = pMacs[i];                                         // Attach the Mac to the Aggregation Port
+		pLag->addAggPort(pMacs[i], pBridge->SystemId, paired, sysNum);     // Create an Aggregation Port (or Aggregation Port/Aggregator pair)
 		pMacs[i]->updateMacSystemId(pBridge->SystemId.id);                 // Update Mac address/sapId with device type and sysNum
-		pLag->pAggregators.push_back(pAggPort);                              // Put Aggregator in the Device's Lag shim
-		pLag->pAggPorts.push_back(pAggPort);                                 // Put Aggregation Port in the Device's Lag shim
+	}
+	for (unsigned short i = 0; i < nAggregators; i++)    // For each Aggregator:
+	{
+		if (!paired)
+			pLag->addAggregator(pBridge->SystemId, sysNum);                // Create an Aggregator
+		pBridge->bPorts[i]->pIss = pLag->pAggregators[i];                  // Attach the Aggregator to a BridgePort
 	}
 
 	pComponents.push_back(move(pBridge));                             // Put the Bridge in the Device Components vector
@@ -208,6 +351,7 @@ EndStn::EndStn(unsigned short devNum, unsigned short sysNum)
 	SystemId.id = defaultEndStnAddr + (0x10000 * devNum) + (0x1000 * sysNum);
 	sequenceNumber = 0;
 	rxFrameCount = 0;
+	lastFlowId = 0;
 	pIss = nullptr;
 
 //	cout << "EndStn Constructor called." << endl;
@@ -246,6 +390,20 @@ void EndStn::timerTick()
 }
 
 
+int EndStn::nextWakeup() const
+{
+	int wakeup = SimLog::Never;      // No timers.  Received frames wake up the Device through the Mac or LinkAgg they arrive on.
+
+	if (!suspended)
+	{
+		for (auto& pFlow : flows)    // Wake up when the next frame of any flow is due
+		{
+			wakeup = std::min(wakeup, std::max(pFlow->nextDue(), SimLog::Time));
+		}
+	}
+	return (wakeup);
+}
+
 void EndStn::run(bool singleStep)
 {
 	if (!suspended) 
@@ -255,8 +413,9 @@ void EndStn::run(bool singleStep)
 		if (pFrame)
 		{
 			rxFrameCount++;
+			recordRxFlow(*pFrame);
 
-			if (SimLog::Debug > 5)
+			if (SimLog::debug<5>())
 			{
 				SimLog::logFile << "Time " << SimLog::Time << "    EndStation " << hex << SystemId.addr << " received frame ";
 				pFrame->PrintFrameHeader();
@@ -273,16 +432,64 @@ void EndStn::run(bool singleStep)
 
 			}
 		}
+
+		for (auto& pFlow : flows)                        // Generate every flow frame that is due
+		{
+			while (pFlow->nextDue() <= SimLog::Time)
+			{
+				unique_ptr<Frame> pFlowFrame = pFlow->nextFrame();
+				if (pIss->getOperational())              // Transmit frame only if MAC won't immediately discard
+					pIss->Request(move(pFlowFrame));
+			}
+		}
 	}
 }
 
+void EndStn::recordRxFlow(Frame& rxFrame)
+{
+	const Sdu* pSdu = &rxFrame.getNextSdu();
+	unsigned short vid = 0;
+	if ((rxFrame.getNextEtherType() == CVlanEthertype) || (rxFrame.getNextEtherType() == SVlanEthertype))
+	{
+		vid = VlanTag::getVlanTag(rxFrame).Vtag.id;
+		pSdu = &pSdu->getNextSdu();                  // Test frames have at most one tag
+	}
+	if ((pSdu->getEtherType() == PlaypenEthertypeA) && (pSdu->getSubType() == 1))
+	{
+		const TestSdu* pTestSdu = (const TestSdu*)pSdu;
+		unique_ptr<FlowRxStats>& pStats = rxFlows[std::make_tuple((unsigned long long)rxFrame.MacSA, pTestSdu->flowId, vid)];
+		if (!pStats)
+			pStats = make_unique<FlowRxStats>();
+		pStats->record(pTestSdu->scratchPad, SimLog::Time - pSdu->TimeStamp);
+	}
+}
+
+const FlowRxStats* EndStn::getRxFlowStats(unsigned long long sourceAddr, unsigned short vid, unsigned short flowId) const
+{
+	auto found = rxFlows.find(std::make_tuple(sourceAddr, flowId, vid));
+	return ((found == rxFlows.end()) ? nullptr : found->second.get());
+}
+
+const FlowRxStats* EndStn::getRxFlowStats(const TrafficFlow& flow, unsigned short vid) const
+{
+	return (getRxFlowStats(flow.MacSA, vid, flow.flowId));
+}
+
+TrafficFlow& EndStn::addFlow(unsigned long long flowDA, unsigned short vid, unsigned short priority)
+{
+	unsigned long long flowSA = SystemId.addr;
+	flows.push_back(make_unique<TrafficFlow>(flowDA, flowSA, vid, priority));
+	flows.back()->flowId = ++lastFlowId;
+	return (*flows.back());
+}
+
 void EndStn::generateTestFrame(shared_ptr<Sdu> pTag)
 {
 	if (pIss->getOperational())  // Transmit frame only if MAC won't immediately discard
 	{
 		unsigned long long thisSA = SystemId.addr;
-		shared_ptr<Sdu> thisSdu = std::make_shared<TestSdu>(sequenceNumber);
-		unique_ptr<Frame> thisFrame = make_unique<Frame>(defaultDA, thisSA, thisSdu);
+		shared_ptr<Sdu> thisSdu = FramePool::makeShared<TestSdu>(sequenceNumber);
+		unique_ptr<Frame> thisFrame = make_unique<Frame>(defaultDA, thisSA, move(thisSdu));
 //		unique_ptr<Frame> thisFrame = make_unique<Frame>(defaultDA, SystemId.addr, thisSdu);  // Why won't SystemId.addr work?
 		if (pTag) 
 			thisFrame = thisFrame->InsertTag(pTag);
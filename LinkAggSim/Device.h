@@ -19,6 +19,9 @@ limitations under the License.
 #include "Bridge.h"
 #include "Frame.h"
 #include "LinkAgg.h"
+#include "ThreadPool.h"
+#include "Traffic.h"
+#include "Trace.h"
 
 
 /*
@@ -26,8 +29,11 @@ limitations under the License.
 *       An End Station has a single port (Iss interface).
 *
 *       Currently the End Station serves simply as a frame generator and receiver.
-*           It generates test frames with a sequence number.
-*           When a frame is received it is counted and discarded.
+*           It generates test frames with a sequence number, either one at a time (generateTestFrame)
+*           or from a set of TrafficFlows that are transmitted from run() as their frames become due.
+*           When a frame is received it is counted and discarded.  A received test frame is also recorded in
+*           the FlowRxStats for its source address, flow, and VLAN, to measure loss, reordering, and latency.
+*           Frames from generateTestFrame are flow 0, and addFlow numbers each TrafficFlow from 1.
 */
 /**/
 class EndStn : public Component
@@ -45,11 +51,23 @@ public:
 	void reset();
 	void timerTick();
 	void run(bool singleStep);
+	int nextWakeup() const;
 
 	void generateTestFrame(shared_ptr<Sdu> pTag = nullptr);
 
+	std::vector<unique_ptr<TrafficFlow>> flows;
+	TrafficFlow& addFlow(unsigned long long flowDA, unsigned short vid = 0, unsigned short priority = 0);  // Flow from this End Station
+
+	std::map<std::tuple<unsigned long long, unsigned short, unsigned short>, unique_ptr<FlowRxStats>> rxFlows;   // Keyed by source address, flowId, and VID
+	const FlowRxStats* getRxFlowStats(unsigned long long sourceAddr, unsigned short vid = 0, unsigned short flowId = 0) const;  // nullptr if none received
+	const FlowRxStats* getRxFlowStats(const TrafficFlow& flow, unsigned short vid) const;     // Frames of flow received with VID vid
+
 	// protected:
 	shared_ptr<Iss> pIss;
+
+private:
+	unsigned short lastFlowId;           // Never reused, so a new flow does not share a receiver's statistics with an old one
+	void recordRxFlow(Frame& rxFrame);
 };
 
 
@@ -82,17 +100,31 @@ public:
 	       //   Should I add a restoreDefault() routine?
 	virtual void timerTick() override;                     // If not suspended, Tick timers in all Components and Macs
 	virtual void run(bool singleStep) override;            // If not suspended, Make one or more pass through all state machines in all Components and Macs
+	virtual int nextWakeup() const override;               // Earliest wakeup time of any Component or Mac (Never if suspended)
+	virtual void skipTicks(int ticks) override;            // If not suspended, Advance timers in all Components and Macs
 
 	void transmit();                      // If not suspended, Transmit a Frame from any Macs in Device with a Frame ready to transmit
 	void disconnect();                    // Disconnect all Macs in the Device that are connected to other Macs
 
-	void createBridge(unsigned short type = 0);     // Helper function for creating a Device with a single Bridge Component
+	void createBridge(unsigned short type = 0, unsigned short nAggregators = 0);   // Helper function for creating a Device with a single Bridge Component
+	                                                // (with an Aggregator and BridgePort for each Mac, or nAggregators if non-zero)
 	void createEndStation();                        // Helper function for creating a Device with a single End Station Component
 
+	static int skipIdleTicks(std::vector<unique_ptr<Device>>& Devices, int limit);  // Advance Time to the next wakeup of any Device,
+	                                                // but not beyond limit (e.g. the next scheduled event).  Returns number of ticks skipped.
+	static void tick(std::vector<unique_ptr<Device>>& Devices);   // One Time step:  timerTick and run all Devices, then transmit from all Devices
+	static void setThreadCount(unsigned int nThreads);             // Number of threads tick() uses (1, the default, runs Devices one at a time)
+	static unsigned int getThreadCount();
+
 protected:
 	static unsigned short devCnt;
 	unsigned short devNum;
 
+	static unique_ptr<ThreadPool> pThreadPool;
+	std::stringbuf logCapture;             // SimLog::logFile messages from this Device while Devices run in parallel
+	std::stringbuf consoleCapture;         // SimLog::console messages from this Device while Devices run in parallel
+	TraceBuffer traceCapture;              // TraceLog records from this Device while Devices run in parallel
+
 };
 /**/
 
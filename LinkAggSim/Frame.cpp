@@ -55,6 +55,11 @@ unsigned short Sdu::getSubType() const
 	return (subType);
 }
 
+unsigned short Sdu::getLength() const
+{
+	return ((subType == 0) ? 2 : 3);      // EtherType plus SubType (if any);  derived classes add their contents
+}
+
 const Sdu& Sdu::getNextSdu() const
 {
 	if (pNextSdu == nullptr)
@@ -87,12 +92,13 @@ unsigned short Sdu::getNextSubType() const
 
 
 Frame::Frame(unsigned long long frameDA, unsigned long long frameSA, shared_ptr<Sdu> pframeSdu)
-	: MacDA(frameDA), MacSA(frameSA), pNextSdu(pframeSdu)
+	: MacDA(frameDA), MacSA(frameSA), pNextSdu(move(pframeSdu))
 {
 	TimeStamp = SimLog::Time;   // Frame TimeStamp is initially time of construction; may be overwritten when queued
 	VlanIdentifier = 0;
 	Priority = 0;
 	DropEligible = false;
+	HopCount = 0;
 	//	cout << "Frame constructor called" << endl;
 }
 
@@ -104,6 +110,7 @@ Frame::Frame(const Frame& CopySource)
 	VlanIdentifier = CopySource.VlanIdentifier;
 	Priority = CopySource.Priority;
 	DropEligible = CopySource.DropEligible;
+	HopCount = CopySource.HopCount;
 	pNextSdu = CopySource.pNextSdu;           // shallow copy is fine
 	//	cout << "Frame copy constructor called" << endl;
 }
@@ -123,6 +130,25 @@ Frame::~Frame()
 	//	cout << "Frame destructor called" << endl;
 }
 
+void* Frame::operator new(size_t size)
+{
+	return (FramePool::allocate(size));
+}
+
+void Frame::operator delete(void* pFrame, size_t size)
+{
+	FramePool::deallocate(pFrame, size);
+}
+
+unsigned short Frame::getLength() const
+{
+	unsigned short length = 12;           // Destination and source MAC addresses
+	for (const Sdu* pSdu = pNextSdu.get(); pSdu != nullptr; pSdu = pSdu->pNextSdu.get())
+		length += pSdu->getLength();
+	length = std::max(length, (unsigned short)60);    // Pad to minimum frame size
+	return (length + 4);                  // Frame Check Sequence
+}
+
 /**/
 const Sdu& Frame::getNextSdu() const
 {
@@ -155,7 +181,7 @@ unique_ptr<Frame> Frame::InsertTag(shared_ptr<Sdu> pNewSdu) const
 {
 	unique_ptr<Frame> pNewFrame = make_unique<Frame>(*this);
 	pNewSdu->pNextSdu = pNewFrame->pNextSdu;
-	pNewFrame->pNextSdu = pNewSdu;
+	pNewFrame->pNextSdu = move(pNewSdu);
 	return (std::move(pNewFrame));
 }
 
@@ -239,9 +265,14 @@ const VlanTag& VlanTag::getVlanTag(Frame& taggedFrame)        // Returns a const
 	//	return ((const Lacpdu&)*(taggedFrame.pNextSdu));
 }
 
+unsigned short VlanTag::getLength() const
+{
+	return (4);                           // EtherType and Tag Control Information
+}
+
 /**/
-TestSdu::TestSdu(int scratchData) 
-	: Sdu(PlaypenEthertypeA, 1), scratchPad(scratchData)
+TestSdu::TestSdu(int scratchData, unsigned short flow) 
+	: Sdu(PlaypenEthertypeA, 1), scratchPad(scratchData), flowId(flow)
 {
 //	cout << "    TestSdu Constructor called" << endl;
 
@@ -261,4 +292,9 @@ const TestSdu& TestSdu::getTestSdu(Frame& testFrame)        // Returns a constan
 	//	return ((const TestSdu&)*(testFrame.pNextSdu));
 }
 
+unsigned short TestSdu::getLength() const
+{
+	return (Sdu::getLength() + sizeof(scratchPad) + sizeof(flowId));
+}
+
 /**/
\ No newline at end of file
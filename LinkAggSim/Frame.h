@@ -15,6 +15,7 @@ limitations under the License.
 */
 
 #pragma once
+#include "FramePool.h"
 
 /*
 *   The structure of a Frame in this simulation is a Frame header that includes a pointer to the first Sdu in a chain
@@ -27,7 +28,8 @@ limitations under the License.
 *       There is no difference between a "tag", a "Protocol Data Unit (PDU)", and a "Service Data Unit (SDU)" as far as this
 *       simulation is concerned.
 *   A Frame object is instantiated using "std::make_unique<Frame>" and is accessed via a "std::unique_ptr<Frame>" (or a reference).
-*       An object of a class derived from Sdu is created using, for example, "std::make_shared<Lacpdu>" and is accessed via a 
+*       An object of a class derived from Sdu is created using, for example, "FramePool::makeShared<Lacpdu>" (a pooled
+*       equivalent of "std::make_shared<Lacpdu>") and is accessed via a 
 *       a "std::shared_ptr<Lacpdu>" or "std::shared_ptr<Sdu>" (or a reference). This means there is a single "owner" of any Frame,
 *       and that Frame can be modified by inserting or removing "tags" without affecting other Frames in the simulation.  When a 
 *       Frame is replicated (for example within a Bridge), a "shallow" copy is made.  This means the pointer to the Sdu in the 
@@ -49,6 +51,7 @@ public:
 
 	unsigned short getEtherType() const;
 	unsigned short getSubType() const;
+	virtual unsigned short getLength() const;    // Octets in this Sdu on the wire, starting with its EtherType
 	const Sdu& getNextSdu() const;
 	unsigned short getNextEtherType() const;
 	unsigned short getNextSubType() const;
@@ -59,6 +62,7 @@ protected:
 	std::shared_ptr<Sdu> pNextSdu;
 
 	friend class Frame;
+	friend class TraceLog;
 };
 
 
@@ -71,6 +75,9 @@ public:
 	//	Frame(const Frame&& frameCopy);     // move constructor
 	~Frame();
 
+	static void* operator new(size_t size);                  // Frames are allocated from the FramePool
+	static void operator delete(void* pFrame, size_t size);
+
 	int TimeStamp;
 
 
@@ -80,10 +87,12 @@ public:
 	unsigned short VlanIdentifier;  // Always zero in frames at an ISS; Always non-zero in frames at an EISS
 	unsigned short Priority;
 	bool DropEligible;
+	unsigned char HopCount;         // Number of Bridges that have relayed the frame (simulation only; not on the wire)
 	//	unsigned short sapIdentifier;         //TODO:  ISS primitive SAP Identifier
 	//	unsigned long connectionIdentifier;   //TODO:  ISS primitive Connection Identifier
 
 	const Sdu& getNextSdu() const;
+	unsigned short getLength() const;            // Octets on the wire from DA through FCS (padded to minimum frame size)
 	unsigned short Frame::getNextEtherType() const;
 	unsigned short Frame::getNextSubType() const;
 	unique_ptr<Frame> InsertTag(shared_ptr<Sdu> pNewSdu) const;
@@ -93,6 +102,8 @@ public:
 
 protected:
 	std::shared_ptr<Sdu> pNextSdu;
+
+	friend class TraceLog;
 };
 
 /**/
@@ -116,6 +127,7 @@ public:
 
 	vlanControlWord Vtag;
 	static const VlanTag& getVlanTag(Frame& taggedFrame);        // Returns a constant reference to the Vlan tag
+	virtual unsigned short getLength() const override;
 
 };
 
@@ -126,11 +138,13 @@ public:
 class TestSdu : public Sdu
 {
 public:
-	TestSdu(int scratchData = 0);
+	TestSdu(int scratchData = 0, unsigned short flow = 0);
 	~TestSdu();
 
 	static const TestSdu& getTestSdu(Frame& testFrame);        // Returns a constant reference to the Test Sdu
+	virtual unsigned short getLength() const override;
 	int scratchPad;
+	unsigned short flowId;        // TrafficFlow that generated the Sdu (0 for EndStn::generateTestFrame)
 };
 /**/
 
@@ -0,0 +1,156 @@
+/*
+Copyright 2017 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "stdafx.h"
+#include "FramePool.h"
+
+
+const size_t FramePool::blockGranularity;
+const size_t FramePool::maxBlockSize;
+const size_t FramePool::chunkSize;
+thread_local FramePool::FreeBlock* FramePool::freeLists[FramePool::sizeClasses] = {};
+thread_local char* FramePool::pChunkNext = nullptr;
+thread_local size_t FramePool::chunkRemaining = 0;
+thread_local bool FramePool::threadExitArmed = false;
+thread_local FramePool::ThreadExit FramePool::threadExit;
+std::atomic<unsigned long> FramePool::chunkCount(0);
+std::atomic<unsigned long> FramePool::orphanCount(0);
+bool FramePool::released = false;
+
+
+void* FramePool::allocate(size_t size)
+{
+	if ((size == 0) || (size > maxBlockSize))
+		return (::operator new(size));
+
+	size_t sizeClass = (size - 1) / blockGranularity;
+	FreeBlock* pBlock = freeLists[sizeClass];
+	if (pBlock)                                   // Reuse a freed block of this size class
+	{
+		freeLists[sizeClass] = pBlock->pNext;
+		return (pBlock);
+	}
+
+	if (orphanCount.load(std::memory_order_relaxed) != 0)
+	{
+		void* pOrphan = takeOrphans(sizeClass);
+		if (pOrphan)
+			return (pOrphan);
+	}
+
+	size_t blockSize = (sizeClass + 1) * blockGranularity;
+	if (chunkRemaining < blockSize)               // Start a new chunk (any remainder of the old one is abandoned)
+	{
+		pChunkNext = static_cast<char*>(newChunk());
+		chunkRemaining = chunkSize;
+	}
+	void* pNew = pChunkNext;
+	pChunkNext += blockSize;
+	chunkRemaining -= blockSize;
+	return (pNew);
+}
+
+void FramePool::deallocate(void* pBlock, size_t size)
+{
+	if (pBlock == nullptr)
+		return;
+	if ((size == 0) || (size > maxBlockSize))
+	{
+		::operator delete(pBlock);
+		return;
+	}
+
+	if (!threadExitArmed)                         // This thread may never allocate, but its free lists must still be handed on
+		armThreadExit();
+	size_t sizeClass = (size - 1) / blockGranularity;
+	FreeBlock* pFree = static_cast<FreeBlock*>(pBlock);
+	pFree->pNext = freeLists[sizeClass];
+	freeLists[sizeClass] = pFree;
+}
+
+unsigned long FramePool::getChunkCount()
+{
+	return (chunkCount.load());
+}
+
+FramePool::Registry& FramePool::getRegistry()
+{
+	static Registry registry;                     // Constructed by the first chunk, so destroyed after any use at exit
+	return (registry);
+}
+
+void FramePool::armThreadExit()
+{
+	threadExitArmed = true;
+	threadExit.armed = true;                      // First use constructs threadExit, so its destructor runs at thread end
+}
+
+void* FramePool::takeOrphans(size_t sizeClass)    // Adopts one free list left by an ended thread and returns its first block
+{
+	Registry& registry = getRegistry();
+	std::lock_guard<std::mutex> guard(registry.lock);
+	if (registry.orphans[sizeClass].empty())
+		return (nullptr);
+
+	FreeBlock* pBlock = registry.orphans[sizeClass].back();
+	registry.orphans[sizeClass].pop_back();
+	orphanCount--;
+	freeLists[sizeClass] = pBlock->pNext;
+	return (pBlock);
+}
+
+void* FramePool::newChunk()
+{
+	if (!threadExitArmed)
+		armThreadExit();
+	void* pChunk = ::operator new(chunkSize);
+	Registry& registry = getRegistry();
+	std::lock_guard<std::mutex> guard(registry.lock);
+	registry.chunks.push_back(pChunk);
+	chunkCount++;
+	return (pChunk);
+}
+
+FramePool::ThreadExit::~ThreadExit()
+{
+	if (released)                                 // Program exit has already freed every chunk
+		return;
+	Registry& registry = getRegistry();
+	std::lock_guard<std::mutex> guard(registry.lock);
+	for (size_t sizeClass = 0; sizeClass < sizeClasses; sizeClass++)
+	{
+		if (freeLists[sizeClass])
+		{
+			registry.orphans[sizeClass].push_back(freeLists[sizeClass]);
+			orphanCount++;
+			freeLists[sizeClass] = nullptr;
+		}
+	}
+	pChunkNext = nullptr;
+	chunkRemaining = 0;
+}
+
+/*
+*   Runs at program exit, after the thread_local objects of the main thread.  Any Frame or Sdu still alive at this point (none are, once
+*       the Devices have been destroyed) would be left pointing at freed memory.
+*/
+FramePool::Registry::~Registry()
+{
+	for (void* pChunk : chunks)
+		::operator delete(pChunk);
+	chunks.clear();
+	released = true;
+}
@@ -0,0 +1,125 @@
+/*
+Copyright 2017 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+
+/*
+*   Class FramePool is a pool allocator for the small objects that are created and destroyed for every frame in the
+*       simulation:  Frames, and Sdus (VlanTag, TestSdu, Lacpdu, ...) together with their shared_ptr control blocks.
+*   Blocks are carved from large chunks and, when freed, kept on a free list for their size class (16 byte granularity),
+*       so after the first few ticks no frame allocation reaches the heap.  Requests larger than maxBlockSize go to the heap.
+*   The free lists and the current chunk are per-thread, so no locking is needed when Devices run in parallel.
+*       A block freed on a different thread from the one that allocated it simply joins the freeing thread's free list.
+*       For that reason a chunk cannot be returned to the heap while the program runs.  Instead every chunk is recorded
+*       in a shared registry, and all chunks are freed together when the program exits.  When a thread ends (e.g. when
+*       Device::setThreadCount replaces the thread pool) its free lists are handed to the registry, and other threads
+*       take them back before carving new blocks.
+*   Frame uses the pool through its class operator new/delete, so make_unique<Frame> and unique_ptr<Frame> are unchanged.
+*   Sdus are created with FramePool::makeShared<T>(...) in place of make_shared<T>(...).
+*/
+/**/
+class FramePool
+{
+public:
+	static const size_t blockGranularity = 16;
+	static const size_t maxBlockSize = 1024;
+	static const size_t chunkSize = 64 * 1024;
+
+	static void* allocate(size_t size);
+	static void deallocate(void* pBlock, size_t size);
+	static unsigned long getChunkCount();        // Number of chunks taken from the heap by all threads
+
+	template <class T, class... Args> static shared_ptr<T> makeShared(Args&&... args);
+
+private:
+	static const size_t sizeClasses = maxBlockSize / blockGranularity;
+
+	struct FreeBlock
+	{
+		FreeBlock* pNext;
+	};
+	struct Registry                              // Chunks of all threads, and free lists left by threads that have ended
+	{
+		std::mutex lock;
+		std::vector<void*> chunks;
+		std::vector<FreeBlock*> orphans[sizeClasses];
+		~Registry();
+	};
+	struct ThreadExit                            // Destroyed when a thread that has used the pool ends
+	{
+		bool armed;
+		~ThreadExit();
+	};
+	static thread_local FreeBlock* freeLists[sizeClasses];
+	static thread_local char* pChunkNext;        // Unused part of this thread's current chunk
+	static thread_local size_t chunkRemaining;
+	static thread_local bool threadExitArmed;
+	static thread_local ThreadExit threadExit;
+	static std::atomic<unsigned long> chunkCount;
+	static std::atomic<unsigned long> orphanCount;
+	static bool released;                        // Set once the Registry has freed all chunks at program exit
+
+	static Registry& getRegistry();
+	static void armThreadExit();
+	static void* takeOrphans(size_t sizeClass);
+	static void* newChunk();
+};
+/**/
+
+
+/*
+*   PoolAllocator is a standard allocator that takes its memory from FramePool, for use with std::allocate_shared.
+*/
+template <class T>
+class PoolAllocator
+{
+public:
+	typedef T value_type;
+
+	PoolAllocator() {}
+	template <class U> PoolAllocator(const PoolAllocator<U>&) {}
+
+	T* allocate(size_t n)
+	{
+		return (static_cast<T*>(FramePool::allocate(n * sizeof(T))));
+	}
+	void deallocate(T* p, size_t n)
+	{
+		FramePool::deallocate(p, n * sizeof(T));
+	}
+};
+
+template <class T, class U>
+bool operator== (const PoolAllocator<T>&, const PoolAllocator<U>&)
+{
+	return (true);
+}
+
+template <class T, class U>
+bool operator!= (const PoolAllocator<T>&, const PoolAllocator<U>&)
+{
+	return (false);
+}
+
+template <class T, class... Args>
+shared_ptr<T> FramePool::makeShared(Args&&... args)
+{
+	return (std::allocate_shared<T>(PoolAllocator<T>(), std::forward<Args>(args)...));
+}
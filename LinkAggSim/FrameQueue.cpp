@@ -0,0 +1,127 @@
+/*
+Copyright 2017 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "stdafx.h"
+#include "FrameQueue.h"
+
+
+const size_t FrameQueue::defaultDepth;
+
+FrameQueue::FrameQueue(size_t depth)
+	: mask(0),
+	head(0),
+	tail(0),
+	drops(0),
+	highWater(0)
+{
+	setDepth(depth);
+}
+
+FrameQueue::~FrameQueue()
+{
+}
+
+bool FrameQueue::push(unique_ptr<Frame> pFrame)
+{
+	size_t myTail = tail.load(std::memory_order_relaxed);
+	size_t queued = myTail - head.load(std::memory_order_acquire);
+
+	if (queued > mask)                           // Full:  tail drop
+	{
+		drops.fetch_add(1, std::memory_order_relaxed);
+		return (false);
+	}
+	slots[myTail & mask] = move(pFrame);
+	tail.store(myTail + 1, std::memory_order_release);      // Publish the frame to the consumer
+
+	if (queued + 1 > highWater.load(std::memory_order_relaxed))
+		highWater.store(queued + 1, std::memory_order_relaxed);
+	return (true);
+}
+
+unique_ptr<Frame>& FrameQueue::front()
+{
+	return (slots[head.load(std::memory_order_relaxed) & mask]);
+}
+
+const unique_ptr<Frame>& FrameQueue::front() const
+{
+	return (slots[head.load(std::memory_order_relaxed) & mask]);
+}
+
+void FrameQueue::pop()
+{
+	size_t myHead = head.load(std::memory_order_relaxed);
+
+	slots[myHead & mask].reset();                // Frame (if not moved out by the consumer) is destroyed here
+	head.store(myHead + 1, std::memory_order_release);      // Return the slot to the producer
+}
+
+void FrameQueue::clear()
+{
+	while (!empty())
+		pop();
+}
+
+bool FrameQueue::empty() const
+{
+	return (head.load(std::memory_order_relaxed) == tail.load(std::memory_order_acquire));
+}
+
+bool FrameQueue::full() const
+{
+	return (size() > mask);
+}
+
+size_t FrameQueue::size() const
+{
+	return (tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire));
+}
+
+size_t FrameQueue::getDepth() const
+{
+	return (mask + 1);
+}
+
+void FrameQueue::setDepth(size_t depth)
+{
+	size_t slotCount = 1;
+	while (slotCount < depth)
+		slotCount <<= 1;
+
+	clear();
+	slots.clear();
+	slots.resize(slotCount);
+	mask = slotCount - 1;
+	head.store(0);
+	tail.store(0);
+}
+
+unsigned long FrameQueue::getDrops() const
+{
+	return (drops.load(std::memory_order_relaxed));
+}
+
+size_t FrameQueue::getHighWater() const
+{
+	return (highWater.load(std::memory_order_relaxed));
+}
+
+void FrameQueue::clearStatistics()
+{
+	drops.store(0);
+	highWater.store(0);
+}
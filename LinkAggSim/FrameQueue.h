@@ -0,0 +1,67 @@
+/*
+Copyright 2017 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+#include <atomic>
+#include <vector>
+#include "Frame.h"
+
+
+/*
+*   Class FrameQueue is a fixed-capacity ring buffer of Frames used for the request and indication queues of an IssQ.
+*       It replaces std::queue<unique_ptr<Frame>> (same push/front/pop/empty methods) but allocates all of its slots once,
+*       so pushing a frame does not allocate.
+*   The queue is single-producer/single-consumer:  one thread may push while another thread fronts and pops, with no locks.
+*       (E.g. a Mac transmitting to its link partner's indications while the partner's Device runs in another thread.)
+*       Changing the depth, or clearing from any thread other than the consumer, is only allowed while neither end is active.
+*   When the queue is full a pushed frame is discarded (tail drop) and counted.  A producer that would rather apply
+*       backpressure can test full() before pushing.  The high water mark records the maximum number of frames queued.
+*/
+/**/
+class FrameQueue
+{
+public:
+	FrameQueue(size_t depth = defaultDepth);
+	~FrameQueue();
+	FrameQueue(FrameQueue& copySource) = delete;             // Disable copy constructor
+	FrameQueue& operator= (const FrameQueue&) = delete;      // Disable assignment operator
+
+	static const size_t defaultDepth = 256;
+
+	bool push(unique_ptr<Frame> pFrame);         // Producer:  queue frame, or discard it and return false if queue is full
+	unique_ptr<Frame>& front();                  // Consumer:  oldest frame (queue must not be empty)
+	const unique_ptr<Frame>& front() const;
+	void pop();                                  // Consumer:  discard oldest frame (queue must not be empty)
+	void clear();                                // Consumer:  discard all frames
+	bool empty() const;
+	bool full() const;
+	size_t size() const;
+
+	size_t getDepth() const;
+	void setDepth(size_t depth);                 // Rounded up to a power of two;  discards any queued frames
+	unsigned long getDrops() const;              // Frames discarded because the queue was full
+	size_t getHighWater() const;                 // Maximum number of frames that have been in the queue
+	void clearStatistics();
+
+private:
+	std::vector<unique_ptr<Frame>> slots;
+	size_t mask;                                 // Number of slots minus one
+	std::atomic<size_t> head;                    // Count of frames popped;  written only by the consumer
+	std::atomic<size_t> tail;                    // Count of frames pushed;  written only by the producer
+	std::atomic<unsigned long> drops;
+	std::atomic<size_t> highWater;
+};
+/**/
@@ -16,6 +16,7 @@ limitations under the License.
 
 #include "stdafx.h"
 #include "AggPort.h"
+#include "ConsoleReport.h"
 
 
 
@@ -50,6 +51,7 @@ int AggPort::LacpMuxSM::run(AggPort& port, bool singleStep)
 		loop++;
 	} while (!singleStep && transitionTaken && loop < 10);
 	if (!transitionTaken) loop--;
+	port.stateMachineTransitions.add(loop);
 	return (loop);
 }
 
@@ -182,7 +184,7 @@ bool AggPort::LacpMuxSM::stepMuxSM(AggPort& port)
 
 AggPort::LacpMuxSM::MuxSmStates AggPort::LacpMuxSM::enterDetached(AggPort& port)
 {
-	if (SimLog::Debug > 3)
+	if (SimLog::debug<3>())
 	{
 		SimLog::logFile << "Time " << SimLog::Time << hex << ":  *** Port " << port.actorSystem.addrMid << ":" << port.actorPort.num
 		    << " is DETACHED from Aggregator "  << port.actorPortAggregatorIdentifier << "  ***" << dec << endl;
@@ -227,7 +229,7 @@ AggPort::LacpMuxSM::MuxSmStates AggPort::LacpMuxSM::enterDetached(AggPort& port)
 
 AggPort::LacpMuxSM::MuxSmStates AggPort::LacpMuxSM::enterWaiting(AggPort& port)
 {
-	if ((SimLog::Debug > 3))
+	if ((SimLog::debug<3>()))
 	{
 		SimLog::logFile << "Time " << SimLog::Time << hex << ":  *** Port " << port.actorSystem.addrMid << ":" << port.actorPort.num
 			<< " is WAITING for Aggregator " << port.actorPortAggregatorIdentifier << "  ***" << dec << endl;
@@ -241,7 +243,7 @@ AggPort::LacpMuxSM::MuxSmStates AggPort::LacpMuxSM::enterWaiting(AggPort& port)
 
 AggPort::LacpMuxSM::MuxSmStates AggPort::LacpMuxSM::enterAttach(AggPort& port)
 {
-	if ((SimLog::Debug > 3))
+	if ((SimLog::debug<3>()))
 	{
 		SimLog::logFile << "Time " << SimLog::Time << hex << ":  *** Port " << port.actorSystem.addrMid << ":" << port.actorPort.num
 			<< " is ATTACH for Aggregator " << port.actorPortAggregatorIdentifier << "  ***" << dec << endl;
@@ -254,7 +256,7 @@ AggPort::LacpMuxSM::MuxSmStates AggPort::LacpMuxSM::enterAttach(AggPort& port)
 
 AggPort::LacpMuxSM::MuxSmStates AggPort::LacpMuxSM::enterAttachedWtr(AggPort& port)
 {
-	if ((SimLog::Debug > 3))
+	if ((SimLog::debug<3>()))
 	{
 		SimLog::logFile << "Time " << SimLog::Time << hex << ":  *** Port " << port.actorSystem.addrMid << ":" << port.actorPort.num
 			<< " is ATTACHED_WTR for Aggregator " << port.actorPortAggregatorIdentifier;
@@ -276,7 +278,7 @@ AggPort::LacpMuxSM::MuxSmStates AggPort::LacpMuxSM::enterAttachedWtr(AggPort& po
 
 AggPort::LacpMuxSM::MuxSmStates AggPort::LacpMuxSM::enterAttached(AggPort& port)
 {
-	if ((SimLog::Debug > 3))
+	if ((SimLog::debug<3>()))
 	{
 		SimLog::logFile << "Time " << SimLog::Time << hex << ":  *** Port " << port.actorSystem.addrMid << ":" << port.actorPort.num
 			<< " is ATTACHED to Aggregator " << port.actorPortAggregatorIdentifier << "  ***" << dec << endl;
@@ -318,7 +320,7 @@ AggPort::LacpMuxSM::MuxSmStates AggPort::LacpMuxSM::enterAttached(AggPort& port)
 
 AggPort::LacpMuxSM::MuxSmStates AggPort::LacpMuxSM::enterCollecting(AggPort& port)
 {
-	if ((SimLog::Debug > 3))
+	if ((SimLog::debug<3>()))
 	{
 		SimLog::logFile << "Time " << SimLog::Time << hex << ":  *** Port " << port.actorSystem.addrMid << ":" << port.actorPort.num
 			<< " is COLLECTING on Aggregator " << port.actorPortAggregatorIdentifier 
@@ -355,7 +357,7 @@ AggPort::LacpMuxSM::MuxSmStates AggPort::LacpMuxSM::enterCollecting(AggPort& por
 
 AggPort::LacpMuxSM::MuxSmStates AggPort::LacpMuxSM::enterDistributing(AggPort& port)
 {
-	if ((SimLog::Debug > 3))
+	if ((SimLog::debug<3>()))
 	{
 		SimLog::logFile << "Time " << SimLog::Time << hex << ":  *** Port " << port.actorSystem.addrMid << ":" << port.actorPort.num
 			<< " is DISTRIBUTING on Aggregator " << port.actorPortAggregatorIdentifier << "  ***" << dec << endl;
@@ -370,7 +372,7 @@ AggPort::LacpMuxSM::MuxSmStates AggPort::LacpMuxSM::enterDistributing(AggPort& p
 
 AggPort::LacpMuxSM::MuxSmStates AggPort::LacpMuxSM::enterCollDist(AggPort& port)
 {
-	if ((SimLog::Debug > 3))
+	if ((SimLog::debug<3>()))
 	{
 		SimLog::logFile << "Time " << SimLog::Time << hex << ":  *** Port " << port.actorSystem.addrMid << ":" << port.actorPort.num
 			<< " is COLL_DIST on Aggregator " << port.actorPortAggregatorIdentifier << "  ***" << dec << endl;
@@ -431,13 +433,15 @@ void AggPort::LacpMuxSM::enableDistributing(AggPort& port)
 
 	port.changeActorDistributing = true;
 
-	if ((SimLog::Debug > 0))
+	if ((SimLog::debug<0>()))
 	{
 		SimLog::logFile << "Time " << SimLog::Time << hex << ":  *** Port " << port.actorSystem.addrMid << ":" << port.actorPort.num
 			<< " is UP on Aggregator " << port.actorSystem.addrMid << ":" << port.actorPortAggregatorIdentifier << "  ***" << dec << endl;
 	}
-	cout << "Time " << SimLog::Time << hex << ":  *** Port " << port.actorSystem.addrMid << ":" << port.actorPort.num
-		<< " is UP on Aggregator " << port.actorSystem.addrMid << ":" << port.actorPortAggregatorIdentifier << "  ***" << dec << endl;
+	if (ConsoleReport::lineByLine)
+		SimLog::console << "Time " << SimLog::Time << hex << ":  *** Port " << port.actorSystem.addrMid << ":" << port.actorPort.num
+			<< " is UP on Aggregator " << port.actorSystem.addrMid << ":" << port.actorPortAggregatorIdentifier << "  ***" << dec << endl;
+	ConsoleReport::count(ConsoleReport::PORT_UP);
 }
 
 void AggPort::LacpMuxSM::disableDistributing(AggPort& port)
@@ -446,13 +450,15 @@ void AggPort::LacpMuxSM::disableDistributing(AggPort& port)
 	{
 		port.changeActorDistributing = true;  
 
-		if ((SimLog::Debug > 0))
+		if ((SimLog::debug<0>()))
 		{
 			SimLog::logFile << "Time " << SimLog::Time << hex << ":  *** Port " << port.actorSystem.addrMid << ":" << port.actorPort.num
 				<< " is DOWN on Aggregator " << port.actorSystem.addrMid << ":" << port.actorPortAggregatorIdentifier << "  ***" << dec << endl;
 		}
-		cout << "Time " << SimLog::Time << hex << ":  *** Port " << port.actorSystem.addrMid << ":" << port.actorPort.num
-			<< " is DOWN on Aggregator " << port.actorSystem.addrMid << ":" << port.actorPortAggregatorIdentifier << "  ***" << dec << endl;
+		if (ConsoleReport::lineByLine)
+			SimLog::console << "Time " << SimLog::Time << hex << ":  *** Port " << port.actorSystem.addrMid << ":" << port.actorPort.num
+				<< " is DOWN on Aggregator " << port.actorSystem.addrMid << ":" << port.actorPortAggregatorIdentifier << "  ***" << dec << endl;
+		ConsoleReport::count(ConsoleReport::PORT_DOWN);
 	}
 }
 
@@ -462,13 +468,15 @@ void AggPort::LacpMuxSM::enableCollectingDistributing(AggPort& port)
 	port.changePartnerOperDistAlg |= !port.actorOperPortState.collecting;
 	port.changePortLinkState |= !port.actorOperPortState.collecting;
 
-	if ((SimLog::Debug > 0))
+	if ((SimLog::debug<0>()))
 	{
 		SimLog::logFile << "Time " << SimLog::Time << hex << ":  *** Port " << port.actorSystem.addrMid << ":" << port.actorPort.num
 			<< " is UP on Aggregator " << port.actorSystem.addrMid << ":" << port.actorPortAggregatorIdentifier << "  ***" << dec << endl;
 	}
-	cout << "Time " << SimLog::Time << hex << ":  *** Port " << port.actorSystem.addrMid << ":" << port.actorPort.num
-		<< " is UP on Aggregator " << port.actorSystem.addrMid << ":" << port.actorPortAggregatorIdentifier << "  ***" << dec << endl;
+	if (ConsoleReport::lineByLine)
+		SimLog::console << "Time " << SimLog::Time << hex << ":  *** Port " << port.actorSystem.addrMid << ":" << port.actorPort.num
+			<< " is UP on Aggregator " << port.actorSystem.addrMid << ":" << port.actorPortAggregatorIdentifier << "  ***" << dec << endl;
+	ConsoleReport::count(ConsoleReport::PORT_UP);
 
 }
 
@@ -485,13 +493,15 @@ void AggPort::LacpMuxSM::disableCollectingDistributing(AggPort& port)
 	port.actorPartnerSync = (port.portOperConversationMask == port.partnerOperConversationMask);
 
 
-	if ((SimLog::Debug > 0))
+	if ((SimLog::debug<0>()))
 	{
 		SimLog::logFile << "Time " << SimLog::Time << hex << ":  *** Port " << port.actorSystem.addrMid << ":" << port.actorPort.num
 			<< " is DOWN on Aggregator " << port.actorSystem.addrMid << ":" << port.actorSystem.addrMid << ":" << port.actorPortAggregatorIdentifier << "  ***" << dec << endl;
 	}
-	cout << "Time " << SimLog::Time << hex << ":  *** Port " << port.actorSystem.addrMid << ":" << port.actorPort.num
-		<< " is DOWN on Aggregator " << port.actorSystem.addrMid << ":" << port.actorPortAggregatorIdentifier << "  ***" << dec << endl;
+	if (ConsoleReport::lineByLine)
+		SimLog::console << "Time " << SimLog::Time << hex << ":  *** Port " << port.actorSystem.addrMid << ":" << port.actorPort.num
+			<< " is DOWN on Aggregator " << port.actorSystem.addrMid << ":" << port.actorPortAggregatorIdentifier << "  ***" << dec << endl;
+	ConsoleReport::count(ConsoleReport::PORT_DOWN);
 
 }
 
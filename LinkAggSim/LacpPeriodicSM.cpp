@@ -45,6 +45,7 @@ int AggPort::LacpPeriodicSM::run(AggPort& port, bool singleStep)
 		loop++;
 	} while (!singleStep && transitionTaken && loop < 10);
 	if (!transitionTaken) loop--;
+	port.stateMachineTransitions.add(loop);
 	return (loop);
 }
 
@@ -125,7 +126,7 @@ AggPort::LacpPeriodicSM::PerSmStates AggPort::LacpPeriodicSM::enterSlowPeriodic(
 AggPort::LacpPeriodicSM::PerSmStates AggPort::LacpPeriodicSM::enterPeriodicTx(AggPort& port)
 {
 	port.NTT = true;
-	if (SimLog::Debug > 6)
+	if (SimLog::debug<6>())
 	{
 		SimLog::logFile << "Time " << SimLog::Time << ":   Device:Port " << hex << port.actorSystem.addrMid
 			<< ":" << port.actorPort.num << " NTT: Periodic " << dec << endl;
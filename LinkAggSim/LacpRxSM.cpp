@@ -16,6 +16,7 @@ limitations under the License.
 
 #include "stdafx.h"
 #include "AggPort.h"
+#include "Trace.h"
 
 
 // void AggPort::LacpRxSM::resetRxSM(AggPort& port)
@@ -53,6 +54,7 @@ int  AggPort::LacpRxSM::run(AggPort& port, bool singleStep)
 		loop++;
 	} while (!singleStep && transitionTaken && loop < 10);
 	if (!transitionTaken) loop--;
+	port.stateMachineTransitions.add(loop);
 	return (loop);
 }
 
@@ -165,7 +167,7 @@ AggPort::LacpRxSM::RxSmStates AggPort::LacpRxSM::enterExpired(AggPort& port)
 		if (port.actorLacpVersion >= 2)                     // Added in AX-Cor-1, but no reason it could not have been in v1
 		{    // If don't put in v1 then when link disconnected and reconnected it won't come up until Periodic timer at actor or partner sets NTT.
 			port.NTT = true;
-			if (SimLog::Debug > 6)
+			if (SimLog::debug<6>())
 			{
 				SimLog::logFile << "Time " << SimLog::Time << ":   Device:Port " << hex << port.actorSystem.addrMid
 					<< ":" << port.actorPort.num << " NTT: LacpRxSM enters EXPIRED " << dec << endl;
@@ -247,7 +249,7 @@ void AggPort::LacpRxSM::updateNTT(AggPort& port, const Lacpdu& rxLacpdu)
 			(rxLacpdu.partnerState.aggregation != port.actorOperPortState.aggregation))
 		{
 			port.NTT = true;
-			if (SimLog::Debug > 6)
+			if (SimLog::debug<6>())
 			{
 				SimLog::logFile << "Time " << SimLog::Time << ":   Device:Port " << hex << port.actorSystem.addrMid
 					<< ":" << port.actorPort.num << " NTT: RxLACPDU partner info doesn't match actor info " << dec << endl;
@@ -257,7 +259,11 @@ void AggPort::LacpRxSM::updateNTT(AggPort& port, const Lacpdu& rxLacpdu)
 
 void AggPort::LacpRxSM::recordPdu(AggPort& port, const Lacpdu& rxLacpdu)
 	{
-		if ((SimLog::Debug > 4))
+		if ((SimLog::debug<4>()) && TraceLog::enabled)
+		{
+			TraceLog::lacpduRx(port, rxLacpdu);
+		}
+		else if ((SimLog::debug<4>()))
 		{
 			SimLog::logFile << "Time " << SimLog::Time << ":  Device:Port " << hex << port.actorSystem.addrMid << ":" << port.actorPort.num
 				<< " received LACPDU sent at time " << dec << rxLacpdu.TimeStamp;
@@ -292,7 +298,7 @@ void AggPort::LacpRxSM::recordPdu(AggPort& port, const Lacpdu& rxLacpdu)
 			recordConversationServiceMappingDigestTlv(port, rxLacpdu);
 			recordReceivedConversationMaskTlv(port, rxLacpdu);
 
-			if ((SimLog::Debug > 4))
+			if ((SimLog::debug<4>()))
 			{
 				if (rxLacpdu.portConversationIdDigestTlv)
 				{
@@ -370,7 +376,7 @@ void AggPort::LacpRxSM::actorAdminChange(AggPort& port)       // Compare actor a
 		port.actorOperPortState.lacpShortTimeout = port.actorAdminPortState.lacpShortTimeout;  // can change without unselecting (but should set NTT)
 
 		port.NTT = true;
-		if (SimLog::Debug > 6)
+		if (SimLog::debug<6>())
 		{
 			SimLog::logFile << "Time " << SimLog::Time << ":   Device:Port " << hex << port.actorSystem.addrMid
 				<< ":" << port.actorPort.num << " NTT: Admin variable changed " << dec << endl;
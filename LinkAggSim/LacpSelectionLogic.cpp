@@ -28,34 +28,50 @@ void AggPort::LacpSelection::resetSelection(AggPort& port)
 }
 /**/
 
-void LinkAgg::LacpSelection::adminAggregatorUpdate(std::vector<shared_ptr<AggPort>>& pAggPorts, std::vector<shared_ptr<Aggregator>>& pAggregators)
+void LinkAgg::LacpSelection::adminAggregatorUpdate(std::vector<shared_ptr<AggPort>>& pAggPorts, std::vector<shared_ptr<Aggregator>>& pAggregators,
+	SelectionIndex& index)
 {
+	index.portsIndexed = false;                  // Management may have changed anything since the index was last built
+	index.aggregatorsIndexed = false;
+
 	for (unsigned short ax = 0; ax < pAggregators.size(); ax++)
 	{
 		Aggregator& agg = *pAggregators[ax];
 
 		if (agg.changeActorSystem)                                                   // If ActorSystem identifier has changed
 		{
-			clearAggregator(agg, pAggPorts);                                         //    then kick all ports off Aggregator
-			pAggPorts[ax]->portSelected = AggPort::selectedVals::UNSELECTED;         //    and unselect corresponding AggPort
+			clearAggregator(agg, pAggPorts, index);                                         //    then kick all ports off Aggregator
+			if ((ax < pAggPorts.size()) && (pAggPorts[ax].get() == &agg))            //    and if paired with an AggPort
+				pAggPorts[ax]->portSelected = AggPort::selectedVals::UNSELECTED;     //       then unselect corresponding AggPort
 			agg.changeActorSystem = false;
 		}
 		if (agg.actorOperAggregatorKey != agg.actorAdminAggregatorKey)               // If admin key has changed
 		{
-			clearAggregator(agg, pAggPorts);                                         //    then kick all ports off Aggregator
+			clearAggregator(agg, pAggPorts, index);                                         //    then kick all ports off Aggregator
 			agg.actorOperAggregatorKey = agg.actorAdminAggregatorKey;                //    and update oper key
 		}
 		if (!agg.getEnabled() && !agg.lagPorts.empty())                              // If aggregator disabled and LAG port list not empty
 		{
-			clearAggregator(agg, pAggPorts);                                         //    then kick all ports off Aggregator
+			clearAggregator(agg, pAggPorts, index);                                         //    then kick all ports off Aggregator
+		}
+	}
+	for (auto& pPort : pAggPorts)                                                    // AggPorts not paired with an Aggregator
+	{
+		if (pPort->changeActorSystem)                                                // If ActorSystem identifier has changed
+		{
+			pPort->portSelected = AggPort::selectedVals::UNSELECTED;                 //    then unselect AggPort
+			pPort->changeActorSystem = false;
 		}
 	}
 }
 
 
 
-void LinkAgg::LacpSelection::runSelection(std::vector<shared_ptr<AggPort>>& pAggPorts, std::vector<shared_ptr<Aggregator>>& pAggregators)
+void LinkAgg::LacpSelection::runSelection(std::vector<shared_ptr<AggPort>>& pAggPorts, std::vector<shared_ptr<Aggregator>>& pAggregators,
+	SelectionIndex& index)
 {
+	index.portsIndexed = false;                  // Port and Aggregator variables may have changed since the last runSelection
+	index.aggregatorsIndexed = false;
 
 	for (unsigned short px = 0; px < pAggPorts.size(); px++)   // walk through AggPort array using px as index
 	{
@@ -65,28 +81,25 @@ void LinkAgg::LacpSelection::runSelection(std::vector<shared_ptr<AggPort>>& pAgg
 		*/
 		if (pAggPorts[px]->newPartner)                        // if this port has a new partner
 		{
-			if (SimLog::Debug > 5)
+			if (SimLog::debug<5>())
 			{
 				SimLog::logFile << "Time " << SimLog::Time << ":  *** Port " << hex
 					<< pAggPorts[px]->actorSystem.addrMid << ":" << pAggPorts[px]->actorPort.id
 					<< " has new partner   " << pAggPorts[px]->partnerOperSystem.addrMid << ":" << pAggPorts[px]->partnerOperPort.id;
 			}
-			for (unsigned short opx = 0; opx < pAggPorts.size(); opx++)   // walk through AggPort array using opx as index
+			indexPorts(index, pAggPorts);
+			for (auto opx : index.portsByPartner[portPartner(*pAggPorts[px])])   // walk through AggPorts with the same partner info
 			{
-				if ((opx != px) &&                                        // if there is another port with the same partner info
-					(pAggPorts[opx]->partnerOperSystem.id == pAggPorts[px]->partnerOperSystem.id) &&
-					(pAggPorts[opx]->partnerOperPort.id == pAggPorts[px]->partnerOperPort.id) &&
-					(pAggPorts[opx]->partnerOperKey == pAggPorts[px]->partnerOperKey) &&
-					(pAggPorts[opx]->partnerOperPortState.aggregation == pAggPorts[px]->partnerOperPortState.aggregation))
+				if (opx != px)                                            // if there is another port with the same partner info
 				{
 					pAggPorts[opx]->PortMoved = true;                      //    then set port_moved flag for RxSM of the other port
-					if (SimLog::Debug > 5)
+					if (SimLog::debug<5>())
 					{
 						SimLog::logFile << " that moved from port " << pAggPorts[opx]->actorSystem.addrMid << ":" << pAggPorts[opx]->actorPort.id;
 					}
 				}
 			}
-			if (SimLog::Debug > 5)
+			if (SimLog::debug<5>())
 			{
 				SimLog::logFile << dec << endl;
 			}
@@ -113,30 +126,34 @@ void LinkAgg::LacpSelection::runSelection(std::vector<shared_ptr<AggPort>>& pAgg
 			//    running) then need the !Ready term so that don't also allow selected aggregator to change in the ATTACH state.
 		{
 
-			pAggregators[pAggPorts[px]->actorPortAggregatorIndex]->lagPorts.remove(px);  // remove AggPort from lagPort list of previously selected Aggregator
-			pAggregators[pAggPorts[px]->actorPortAggregatorIndex]->selectedLagPorts.remove(px);  // remove AggPort from lagPort list of previously selected Aggregator
+			if (pAggPorts[px]->actorPortAggregatorIndex < pAggregators.size())
+			{
+				pAggregators[pAggPorts[px]->actorPortAggregatorIndex]->lagPorts.remove(px);  // remove AggPort from lagPort list of previously selected Aggregator
+				pAggregators[pAggPorts[px]->actorPortAggregatorIndex]->selectedLagPorts.remove(px);  // remove AggPort from lagPort list of previously selected Aggregator
+			}
 
-			unsigned short chosenAggregatorIndex = pAggPorts.size();   // assume no aggregator chosen yet
+			unsigned short chosenAggregatorIndex = pAggregators.size();   // assume no aggregator chosen yet
+			bool hasPreferred = (px < pAggregators.size());           // Preferred aggregator is the one with the same index, if there is one
 
-			if (!pAggPorts[px]->actorOperPortState.aggregation)       // If port is not aggregatable (i.e. is Individual)
+			if (!pAggPorts[px]->actorOperPortState.aggregation && hasPreferred)   // If port is not aggregatable (i.e. is Individual)
 //				&& pAggregators[px]->getEnabled())                     //     and the aggregator is enabled
 			{
 				// This implements a policy that setting an AggPort "Individual" permanently reserves the corresponding Aggregator.
 				// This happens regardless of whether the Aggregator ActorSystem and Key match the AggPort,
 				//   or even whether the Aggregator is enabled (only time a AggPort will select a disabled Aggregator).
-				clearAggregator(*pAggregators[px], pAggPorts);        //     Then kick other ports (if any) off own aggregator
+				clearAggregator(*pAggregators[px], pAggPorts, index);        //     Then kick other ports (if any) off own aggregator
 				chosenAggregatorIndex = px;                           //       and make own aggregrator the chosen aggregator
-				if (SimLog::Debug > 8) SimLog::logFile << "Time " << SimLog::Time << "       Individual Port ";
+				if (SimLog::debug<8>()) SimLog::logFile << "Time " << SimLog::Time << "       Individual Port ";
 			}
 			else if (pAggPorts[px]->partnerOperPortState.aggregation)            // Else if partner is also aggregatable
 			{
-				chosenAggregatorIndex = findMatchingAggregator(px, pAggPorts);   //     Then see if can join an existing LAG
-				if (SimLog::Debug > 8) SimLog::logFile << "Time " << SimLog::Time << "                  Port ";
+				chosenAggregatorIndex = findMatchingAggregator(px, pAggPorts, pAggregators, index);   //     Then see if can join an existing LAG
+				if (SimLog::debug<8>()) SimLog::logFile << "Time " << SimLog::Time << "                  Port ";
 			}
-			if (SimLog::Debug > 8) SimLog::logFile << hex << pAggPorts[px]->actorSystem.id << ":" << pAggPorts[px]->actorPort.id << dec
+			if (SimLog::debug<8>()) SimLog::logFile << hex << pAggPorts[px]->actorSystem.id << ":" << pAggPorts[px]->actorPort.id << dec
 				<< " finds matching Aggregator " << chosenAggregatorIndex;
 
-			if (chosenAggregatorIndex > px)                           // if not joining existing LAG or only on higher aggregator
+			if ((chosenAggregatorIndex > px) || !hasPreferred)        // if not joining existing LAG or only on higher aggregator
 			{
 				/*
 				*   This section is what optimizes determinism over minimizing movement of ports among aggregators.
@@ -150,10 +167,10 @@ void LinkAgg::LacpSelection::runSelection(std::vector<shared_ptr<AggPort>>& pAgg
 				*   TODO:  The code below will kick ports of this port's preferred aggregator only if this port is operational.
 				*   Do we want to claim the aggregator even if this port is not operational if no other ports on it are operational?
 				*/
-				if (allowableAggregator(*pAggPorts[px], *pAggregators[px]) &&    // If preferred aggregator has matching key
+				if (hasPreferred && allowableAggregator(*pAggPorts[px], *pAggregators[px]) &&    // If preferred aggregator has matching key
 					pAggPorts[px]->PortEnabled && pAggPorts[px]->wtrRevertOK)    //   and the port is operational and revertive
 				{
-					if (SimLog::Debug > 8)
+					if (SimLog::debug<8>())
 					{
 						SimLog::logFile << endl << "Time " << SimLog::Time << ":  *** Port " << hex
 							<< pAggPorts[px]->actorSystem.addrMid << ":" << pAggPorts[px]->actorPort.id << dec
@@ -162,15 +179,15 @@ void LinkAgg::LacpSelection::runSelection(std::vector<shared_ptr<AggPort>>& pAgg
 							<< dec << endl;
 					}
 
-					clearAggregator(*pAggregators[px], pAggPorts);              //    Then kick other ports (if any) off preferred aggregator
+					clearAggregator(*pAggregators[px], pAggPorts, index);              //    Then kick other ports (if any) off preferred aggregator
 					if (chosenAggregatorIndex < pAggregators.size())            //    If there was a matching LAG on a higher aggregator
 					{
-						clearAggregator(*pAggregators[chosenAggregatorIndex], pAggPorts);  //    Then kick ports off that aggregator
+						clearAggregator(*pAggregators[chosenAggregatorIndex], pAggPorts, index);  //    Then kick ports off that aggregator
 						                                                                   //      so they will later re-join on this aggregator
 					}
 					chosenAggregatorIndex = px;                                //     Make preferred aggregator the chosen aggregator                          
 				}
-				if (SimLog::Debug > 8) SimLog::logFile << "  ... " << chosenAggregatorIndex;
+				if (SimLog::debug<8>()) SimLog::logFile << "  ... " << chosenAggregatorIndex;
 				/*
 				*   This section will attempt to find an aggregator with no active ports.
 				*   
@@ -183,22 +200,22 @@ void LinkAgg::LacpSelection::runSelection(std::vector<shared_ptr<AggPort>>& pAgg
 				if (chosenAggregatorIndex >= pAggregators.size() &&            // If have not yet chosen an aggregator
 					pAggPorts[px]->PortEnabled)                                //   and the port is operational
 				{
-					if (allowableAggregator(*pAggPorts[px], *pAggregators[px]) &&    // Then if preferred aggregator has matching key
+					if (hasPreferred && allowableAggregator(*pAggPorts[px], *pAggregators[px]) &&    // Then if preferred aggregator has matching key
 						!activeAggregator(*pAggregators[px], pAggPorts))             //   and preferred aggregator has no active ports
 					{
-						clearAggregator(*pAggregators[px], pAggPorts);               //     Then kick other ports (if any) off preferred aggregator
+						clearAggregator(*pAggregators[px], pAggPorts, index);               //     Then kick other ports (if any) off preferred aggregator
 						pAggPorts[px]->wtrRevertOK = true;                           //     Port becomes revertive if no active ports on preferred aggregator
 						chosenAggregatorIndex = px;                                  //     Make preferred aggregrator the chosen aggregator
 					}
 					else //TODO:  should I put in a bias toward a previous aggregator, or go right to choosing first available aggregator?
 					{                                                          // Otherwise look for another aggregator with no active ports
-						unsigned short possibleAggregatorIndex = findAvailableAggregator(*pAggPorts[px], pAggPorts, pAggregators);
+						unsigned short possibleAggregatorIndex = findAvailableAggregator(*pAggPorts[px], pAggPorts, pAggregators, index);
 						if (possibleAggregatorIndex < pAggregators.size())             //   If found another aggregator
 						{
 							if (pAggPorts[px]->wtrRevertOK)                            //       and this port is revertive
 							{
 								chosenAggregatorIndex = possibleAggregatorIndex;       //       Then choose that aggregator
-								clearAggregator(*pAggregators[chosenAggregatorIndex], pAggPorts);  //     Then kick other ports (if any) off that aggregator
+								clearAggregator(*pAggregators[chosenAggregatorIndex], pAggPorts, index);  //     Then kick other ports (if any) off that aggregator
 							}
 							else
 							{                                                          //       Otherwise set this port to revertive, so next cycle can compete 
@@ -208,9 +225,9 @@ void LinkAgg::LacpSelection::runSelection(std::vector<shared_ptr<AggPort>>& pAgg
 					}
 
 				}
-				if (SimLog::Debug > 8) SimLog::logFile << "  ... " << chosenAggregatorIndex;
+				if (SimLog::debug<8>()) SimLog::logFile << "  ... " << chosenAggregatorIndex;
 			}
-			if (SimLog::Debug > 8) SimLog::logFile << dec << endl;
+			if (SimLog::debug<8>()) SimLog::logFile << dec << endl;
 
 			/*
 			*   If have chosen an aggregator, then update the LAGID etc of that aggregator and put port on aggregator's port list.
@@ -218,8 +235,12 @@ void LinkAgg::LacpSelection::runSelection(std::vector<shared_ptr<AggPort>>& pAgg
 			*/
 			if (chosenAggregatorIndex < pAggregators.size())
 			{
+				if (index.aggregatorsIndexed)
+					index.aggregatorsByLagid[aggregatorLagid(*pAggregators[chosenAggregatorIndex])].erase(chosenAggregatorIndex);
 				pAggregators[chosenAggregatorIndex]->partnerSystem.id = pAggPorts[px]->partnerOperSystem.id;      // Update LAGID of aggregator (in case taking over)
 				pAggregators[chosenAggregatorIndex]->partnerOperAggregatorKey = pAggPorts[px]->partnerOperKey;
+				if (index.aggregatorsIndexed)
+					index.aggregatorsByLagid[aggregatorLagid(*pAggregators[chosenAggregatorIndex])].insert(chosenAggregatorIndex);
 				pAggregators[chosenAggregatorIndex]->aggregatorIndividual =
 					(!pAggPorts[px]->actorOperPortState.aggregation ||
 					 !pAggPorts[px]->partnerOperPortState.aggregation); 
@@ -255,7 +276,7 @@ void LinkAgg::LacpSelection::runSelection(std::vector<shared_ptr<AggPort>>& pAgg
 				/**/
 
 				// DEBUG:
-				if (SimLog::Debug > 3)
+				if (SimLog::debug<3>())
 				{
 					SimLog::logFile << "Time " << SimLog::Time << ":  *** Port " << hex
 						<< pAggPorts[px]->actorSystem.addrMid << ":" << pAggPorts[px]->actorPort.id
@@ -337,15 +358,15 @@ void LinkAgg::LacpSelection::runSelection(std::vector<shared_ptr<AggPort>>& pAgg
 }
 
 /**/
-int LinkAgg::LacpSelection::findMatchingAggregator(int thisIndex, std::vector<shared_ptr<AggPort>>& pAggPorts)
+int LinkAgg::LacpSelection::findMatchingAggregator(int thisIndex, std::vector<shared_ptr<AggPort>>& pAggPorts, 
+	std::vector<shared_ptr<Aggregator>>& pAggregators, SelectionIndex& index)
 {
-	std::vector<shared_ptr<AggPort>> pAggregators = pAggPorts;
 	AggPort& thisPort = *pAggPorts[thisIndex];
 	bool foundMatch = false;
-	unsigned short ax = 0;
-	int chosen = pAggPorts.size();   // no aggregator chosen yet
+	int chosen = pAggregators.size();   // no aggregator chosen yet
 
-	for (ax = 0; ax < pAggregators.size(); ax++)     // walk through Aggregator array using ax as index
+	indexAggregators(index, pAggregators);
+	for (auto ax : index.aggregatorsByLagid[portLagid(thisPort)])     // walk through Aggregators with same LAGID in ascending order
 	{
 		foundMatch = (matchAggregatorLagid(thisPort, *pAggregators[ax]));  // look for aggregator with same LAGID as this port
 
@@ -355,22 +376,23 @@ int LinkAgg::LacpSelection::findMatchingAggregator(int thisIndex, std::vector<sh
 			{                                                                //    Then can only join LAG if all ports are same-port-loopback
 				foundMatch &= pAggregators[ax]->aggregatorLoopback;            //    (but otherwise have to find another aggregator)
 
-				if (SimLog::Debug > 2)
+				if (SimLog::debug<2>())
 					SimLog::logFile << "Time " << SimLog::Time << ":     Port " << hex << thisPort.actorPort.num << " same-port-loopback foundMatch "
 					<< foundMatch << " agg " << pAggregators[ax]->aggregatorIdentifier << " agg_Loopback " << pAggregators[ax]->aggregatorLoopback
 					<< dec << endl;
 			}
 			else                                                                                      //  else loopback is to different port
 			{
-				for (int k = 0; k < thisIndex; k++)  // Ports in different-port-loopback cannot have both ends of link in same LAG
+				indexPorts(index, pAggPorts);
+				for (auto k : index.portsByNumber[thisPort.partnerOperPort.num])  // Ports in different-port-loopback cannot have both ends of link in same LAG
 				{
-					if ((thisPort.partnerOperPort.num == pAggPorts[k]->actorPort.num) &&  //  so if other end of loopback has
+					if ((k < thisIndex) &&                                            //  so if other end of loopback has
 						(pAggPorts[k]->actorPortAggregatorIndex == ax))                                 //  already selected this aggregator
 						foundMatch = false;                                                           //   then find another aggregator
 				}
 				foundMatch &= !pAggregators[ax]->aggregatorLoopback;     // find another if this aggregator chosen by a same-port-looback
 
-				if (SimLog::Debug > 2)
+				if (SimLog::debug<2>())
 					SimLog::logFile << "Time " << SimLog::Time << ":     Port " << hex << thisPort.actorPort.num << " diff-port-loopback foundMatch "
 					<< foundMatch << " agg " << pAggregators[ax]->aggregatorIdentifier << " agg_Loopback " << pAggregators[ax]->aggregatorLoopback
 					<< dec << endl;
@@ -397,7 +419,7 @@ int LinkAgg::LacpSelection::findMatchingAggregator(int thisIndex, std::vector<sh
 			if (ax < chosen)
 				chosen = ax;                                           // choose lowest matching aggregator
 			else
-				clearAggregator(*pAggregators[ax], pAggPorts);         // kick all ports off any higher matching aggregatos
+				clearAggregator(*pAggregators[ax], pAggPorts, index);         // kick all ports off any higher matching aggregatos
 		                                                               //   to force all ports with same LAG ID to move to lowest matching aggregator
 			// This ensures don't end up with two aggregators with the same LAGID, which could happen if change the LAGID of a lower aggregator
 			//    to match the LAGID of a higher aggregator that already has ports attached.
@@ -408,7 +430,7 @@ int LinkAgg::LacpSelection::findMatchingAggregator(int thisIndex, std::vector<sh
 			//       if (chosen aggregator does not have ports with Selected = SELECTED)
 			//           chosen = ax;                                  // choose aggregator that already has ports selected
 			//       else
-			//           clearAggregator(*pAggregators[ax], pAggPorts);  // otherwise clear the higher aggregator
+			//           clearAggregator(*pAggregators[ax], pAggPorts, index);  // otherwise clear the higher aggregator
 			//   }
 		}
 	}
@@ -440,7 +462,7 @@ bool LinkAgg::LacpSelection::allowableAggregator(AggPort& port, Aggregator& agg)
 }
 
 /**/
-void LinkAgg::LacpSelection::clearAggregator(Aggregator& agg, std::vector<shared_ptr<AggPort>>& pAggPorts)
+void LinkAgg::LacpSelection::clearAggregator(Aggregator& agg, std::vector<shared_ptr<AggPort>>& pAggPorts, SelectionIndex& index)
 {
 	for (auto lagPortIndex : agg.lagPorts)
 	{
@@ -450,13 +472,10 @@ void LinkAgg::LacpSelection::clearAggregator(Aggregator& agg, std::vector<shared
 
 		if (port.actorSystem.addr == port.partnerOperSystem.addr)   // special cases if loopback to same system
 		{
-			for (unsigned short i = 0; i < pAggPorts.size(); i++)                     // find index of partner port 
-			{                                                             //    on other end of loopback link
-				if (pAggPorts[i]->actorPort.num == port.partnerOperPort.num)
-				{
-					pAggPorts[i]->portSelected = AggPort::selectedVals::UNSELECTED;  //   and set it UNSELECTED as well
-
-				}
+			indexPorts(index, pAggPorts);
+			for (auto i : index.portsByNumber[port.partnerOperPort.num])      // find index of partner port 
+			{                                                                  //    on other end of loopback link
+				pAggPorts[i]->portSelected = AggPort::selectedVals::UNSELECTED;  //   and set it UNSELECTED as well
 			}
 		}
 	}
@@ -464,20 +483,21 @@ void LinkAgg::LacpSelection::clearAggregator(Aggregator& agg, std::vector<shared
 
 
 int LinkAgg::LacpSelection::findAvailableAggregator(AggPort& thisPort,
-	std::vector<shared_ptr<AggPort>>& pAggPorts, std::vector<shared_ptr<Aggregator>>& pAggregators)
+	std::vector<shared_ptr<AggPort>>& pAggPorts, std::vector<shared_ptr<Aggregator>>& pAggregators, SelectionIndex& index)
 {
 	bool foundAggregator = false;
-	unsigned short ax = 0;
 
-	for (ax = 0; ax < pAggregators.size(); ax++)     // walk through Aggregator array using ax as index
-	{
+	indexAggregators(index, pAggregators);
+	for (auto ax : index.aggregatorsByActorKey[SelectionIndex::actorKey(thisPort.actorSystem.id, thisPort.actorOperPortKey)])
+	{                                                // walk through Aggregators with a matching key in ascending order
 		foundAggregator = (allowableAggregator(thisPort, *pAggregators[ax]) &&    // Look for an aggregator with a matching key
 			!activeAggregator(*pAggregators[ax], pAggPorts) &&                 //   and has no active ports
-			pAggPorts[ax]->actorOperPortState.aggregation);         //   and is not monopolized by an Individual port
-		if (foundAggregator) break;
+			((ax >= pAggPorts.size()) || pAggPorts[ax]->actorOperPortState.aggregation));   //   and is not monopolized by an Individual port
+		if (foundAggregator) 
+			return (ax);
 	}
 
-	return (ax);
+	return (pAggregators.size());
 }
 
 bool LinkAgg::LacpSelection::activeAggregator(Aggregator& agg,
@@ -494,3 +514,50 @@ bool LinkAgg::LacpSelection::activeAggregator(Aggregator& agg,
 	return (activePorts);
 }
 /**/
+
+void LinkAgg::LacpSelection::indexPorts(SelectionIndex& index, std::vector<shared_ptr<AggPort>>& pAggPorts)
+{
+	if (!index.portsIndexed)
+	{
+		index.portsByPartner.clear();
+		index.portsByNumber.clear();
+		for (unsigned short px = 0; px < pAggPorts.size(); px++)
+		{
+			index.portsByPartner[portPartner(*pAggPorts[px])].push_back(px);
+			index.portsByNumber[pAggPorts[px]->actorPort.num].push_back(px);
+		}
+		index.portsIndexed = true;
+	}
+}
+
+void LinkAgg::LacpSelection::indexAggregators(SelectionIndex& index, std::vector<shared_ptr<Aggregator>>& pAggregators)
+{
+	if (!index.aggregatorsIndexed)
+	{
+		index.aggregatorsByLagid.clear();
+		index.aggregatorsByActorKey.clear();
+		for (unsigned short ax = 0; ax < pAggregators.size(); ax++)
+		{
+			Aggregator& agg = *pAggregators[ax];
+			index.aggregatorsByLagid[aggregatorLagid(agg)].insert(ax);
+			index.aggregatorsByActorKey[SelectionIndex::actorKey(agg.actorSystem.id, agg.actorOperAggregatorKey)].push_back(ax);
+		}
+		index.aggregatorsIndexed = true;
+	}
+}
+
+LinkAgg::LacpSelection::SelectionIndex::partnerKey LinkAgg::LacpSelection::portPartner(AggPort& port)
+{
+	return (SelectionIndex::partnerKey(port.partnerOperSystem.id, port.partnerOperPort.id, port.partnerOperKey, 
+		port.partnerOperPortState.aggregation != 0));
+}
+
+LinkAgg::LacpSelection::SelectionIndex::lagidKey LinkAgg::LacpSelection::portLagid(AggPort& port)
+{
+	return (SelectionIndex::lagidKey(port.actorSystem.id, port.actorOperPortKey, port.partnerOperSystem.id, port.partnerOperKey));
+}
+
+LinkAgg::LacpSelection::SelectionIndex::lagidKey LinkAgg::LacpSelection::aggregatorLagid(Aggregator& agg)
+{
+	return (SelectionIndex::lagidKey(agg.actorSystem.id, agg.actorOperAggregatorKey, agg.partnerSystem.id, agg.partnerOperAggregatorKey));
+}
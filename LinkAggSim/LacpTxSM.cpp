@@ -45,6 +45,7 @@ int AggPort::LacpTxSM::run(AggPort& port, bool singleStep)
 		loop++;
 	} while (!singleStep && transitionTaken && loop < 10);
 	if (!transitionTaken) loop--;
+	port.stateMachineTransitions.add(loop);
 	return (loop);
 }
 
@@ -129,13 +130,14 @@ bool AggPort::LacpTxSM::transmitLacpdu(AggPort& port)
     if (port.pIss->getOperational())  // Transmit frame only if MAC won't immediately discard
 	{
 		unsigned long long mySA = port.pIss->getMacAddress();
-		shared_ptr<Lacpdu> pMyLacpdu = std::make_shared<Lacpdu>();
+		shared_ptr<Lacpdu> pMyLacpdu = FramePool::makeShared<Lacpdu>();
 		prepareLacpdu(port, *pMyLacpdu);
-		unique_ptr<Frame> myFrame = make_unique<Frame>(port.lacpDestinationAddress, mySA, (shared_ptr<Sdu>)pMyLacpdu);
+		unique_ptr<Frame> myFrame = make_unique<Frame>(port.lacpDestinationAddress, mySA, move(pMyLacpdu));
 		port.pIss->Request(move(myFrame));
+		port.lacpdusTx.increment();
 		success = true;
 
-		if ((SimLog::Debug > 4))
+		if ((SimLog::debug<4>()))
 		{
 			SimLog::logFile << "Time " << SimLog::Time << ":  Transmit LACPDU from port " << hex << port.pIss->getMacAddress() << dec 
 				<< "    txCount = " << port.txCount << "/" << port.txLimit << "  txLimitTimer = " << port.txLimitTimer << "/" << port.txLimitInterval << endl;
@@ -144,7 +146,7 @@ bool AggPort::LacpTxSM::transmitLacpdu(AggPort& port)
 	} 
 	else 
 	{
-		if ((SimLog::Debug > 9))
+		if ((SimLog::debug<9>()))
 		{
 			SimLog::logFile << "Time " << SimLog::Time << ":  Can't transmit LACPDU from down port " << hex << port.pIss->getMacAddress() << dec
 				<< "    txCount = " << port.txCount << "/" << port.txLimit << "  txLimitTimer = " << port.txLimitTimer << "/" << port.txLimitInterval << endl;
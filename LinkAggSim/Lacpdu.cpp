@@ -36,3 +36,405 @@ const Lacpdu& Lacpdu::getLacpdu(Frame& LacpFrame)        // Returns a constant r
 	return((const Lacpdu&)LacpFrame.getNextSdu());
 //	return ((const Lacpdu&)*(LacpFrame.pNextSdu));
 }
+
+unsigned short Lacpdu::getLength() const
+{
+	unsigned short length = 2 + 110;                     // EtherType plus version 1 LACPDU (SubType through Reserved)
+	if (portAlgorithmTlv) length += 6;
+	if (portConversationIdDigestTlv) length += 20;
+	if (portConversationServiceMappingDigestTlv) length += 18;
+	if (portConversationMaskTlvs) length += 131 + (3 * 130); // Mask TLV 1 (with Mask State) plus Mask TLVs 2 through 4
+	return (length);
+}
+
+
+/*
+*   Wire format helpers.  Each writes its field big endian and returns the offset following the field.
+*/
+
+static unsigned short put8(unsigned char* buffer, unsigned short offset, unsigned char value)
+{
+	buffer[offset] = value;
+	return (offset + 1);
+}
+
+static unsigned short put16(unsigned char* buffer, unsigned short offset, unsigned short value)
+{
+	buffer[offset] = (unsigned char)(value >> 8);
+	buffer[offset + 1] = (unsigned char)value;
+	return (offset + 2);
+}
+
+static unsigned short put32(unsigned char* buffer, unsigned short offset, unsigned long value)
+{
+	offset = put16(buffer, offset, (unsigned short)(value >> 16));
+	return (put16(buffer, offset, (unsigned short)value));
+}
+
+static unsigned short put48(unsigned char* buffer, unsigned short offset, unsigned long long value)
+{
+	offset = put16(buffer, offset, (unsigned short)(value >> 32));
+	return (put32(buffer, offset, (unsigned long)value));
+}
+
+static unsigned short putZeros(unsigned char* buffer, unsigned short offset, unsigned short count)
+{
+	std::fill(buffer + offset, buffer + offset + count, 0);
+	return (offset + count);
+}
+
+static unsigned short putPortInformation(unsigned char* buffer, unsigned short offset, unsigned char type,
+	sysId system, unsigned short key, portId port, LacpPortState state)
+{
+	offset = put8(buffer, offset, type);
+	offset = put8(buffer, offset, 20);
+	offset = put16(buffer, offset, system.pri);
+	offset = put48(buffer, offset, system.addr);
+	offset = put16(buffer, offset, key);
+	offset = put16(buffer, offset, port.pri);
+	offset = put16(buffer, offset, port.num);
+	offset = put8(buffer, offset, state.state);
+	return (putZeros(buffer, offset, 3));
+}
+
+/*
+*   Writes the Port Conversation Mask octets for Conversation IDs first through first + 1023.
+*   Words of the bitset are not accessible, so each octet is assembled from eight bits.
+*/
+static unsigned short putMaskOctets(unsigned char* buffer, unsigned short offset, const std::bitset<4096>& mask, int first)
+{
+	for (int cid = first; cid < first + 1024; cid += 8)
+	{
+		unsigned char octet = 0;
+		for (int bit = 0; bit < 8; bit++)
+			if (mask[cid + bit])
+				octet |= (0x80 >> bit);
+		buffer[offset++] = octet;
+	}
+	return (offset);
+}
+
+unsigned short Lacpdu::encode(unsigned char* buffer, unsigned short size) const
+{
+	unsigned short length = getLength() - 2;             // Sdu length includes the EtherType, the buffer starts at Subtype
+	if (size < length)
+		return (0);
+
+	unsigned short offset = 0;
+	offset = put8(buffer, offset, LacpduSubType);
+	offset = put8(buffer, offset, VersionNumber);
+	offset = putPortInformation(buffer, offset, LacpduView::ACTOR_INFORMATION, actorSystem, actorKey, actorPort, actorState);
+	offset = putPortInformation(buffer, offset, LacpduView::PARTNER_INFORMATION, partnerSystem, partnerKey, partnerPort, partnerState);
+	offset = put8(buffer, offset, LacpduView::COLLECTOR_INFORMATION);
+	offset = put8(buffer, offset, 16);
+	offset = put16(buffer, offset, collectorMaxDelay);
+	offset = putZeros(buffer, offset, 12);
+
+	if (portAlgorithmTlv)
+	{
+		offset = put8(buffer, offset, LacpduView::PORT_ALGORITHM);
+		offset = put8(buffer, offset, 6);
+		offset = put32(buffer, offset, actorPortAlgorithm);
+	}
+	if (portConversationIdDigestTlv)
+	{
+		offset = put8(buffer, offset, LacpduView::PORT_CONVERSATION_ID_DIGEST);
+		offset = put8(buffer, offset, 20);
+		offset = put16(buffer, offset, linkNumberID);
+		std::copy(actorConversationLinkListDigest.begin(), actorConversationLinkListDigest.end(), buffer + offset);
+		offset += 16;
+	}
+	if (portConversationServiceMappingDigestTlv)
+	{
+		offset = put8(buffer, offset, LacpduView::PORT_CONVERSATION_SERVICE_MAPPING);
+		offset = put8(buffer, offset, 18);
+		std::copy(actorConversationServiceMappingDigest.begin(), actorConversationServiceMappingDigest.end(), buffer + offset);
+		offset += 16;
+	}
+	if (portConversationMaskTlvs)
+	{
+		offset = put8(buffer, offset, LacpduView::PORT_CONVERSATION_MASK_1);
+		offset = put8(buffer, offset, 131);
+		offset = put8(buffer, offset, actorPortConversationMaskState.state);
+		offset = putMaskOctets(buffer, offset, actorPortConversationMask, 0);
+		for (int tlv = 1; tlv < 4; tlv++)
+		{
+			offset = put8(buffer, offset, LacpduView::PORT_CONVERSATION_MASK_1 + tlv);
+			offset = put8(buffer, offset, 130);
+			offset = putMaskOctets(buffer, offset, actorPortConversationMask, tlv * 1024);
+		}
+	}
+
+	offset = put8(buffer, offset, LacpduView::TERMINATOR);
+	offset = put8(buffer, offset, 0);
+	offset = putZeros(buffer, offset, 50);                // Reserved
+	return (offset);
+}
+
+/*
+*   Fields of absent version 2 TLVs are cleared, so decoding the same octets always gives the same Lacpdu.
+*   The TimeStamp is simulator state rather than part of the LACPDU, and is left unchanged.
+*/
+bool Lacpdu::decode(const LacpduView& view)
+{
+	if (!view.valid())
+		return (false);
+
+	VersionNumber = view.getVersionNumber();
+	actorSystem = view.getActorSystem();
+	actorKey = view.getActorKey();
+	actorPort = view.getActorPort();
+	actorState = view.getActorState();
+	partnerSystem = view.getPartnerSystem();
+	partnerKey = view.getPartnerKey();
+	partnerPort = view.getPartnerPort();
+	partnerState = view.getPartnerState();
+	collectorMaxDelay = view.getCollectorMaxDelay();
+
+	portAlgorithmTlv = view.hasPortAlgorithmTlv();
+	actorPortAlgorithm = portAlgorithmTlv ? view.getActorPortAlgorithm() : Aggregator::portAlgorithms::NONE;
+
+	portConversationIdDigestTlv = view.hasPortConversationIdDigestTlv();
+	linkNumberID = portConversationIdDigestTlv ? view.getLinkNumberID() : 0;
+	if (portConversationIdDigestTlv)
+		actorConversationLinkListDigest = view.getActorConversationLinkListDigest();
+	else
+		actorConversationLinkListDigest.fill(0);
+
+	portConversationServiceMappingDigestTlv = view.hasPortConversationServiceMappingDigestTlv();
+	if (portConversationServiceMappingDigestTlv)
+		actorConversationServiceMappingDigest = view.getActorConversationServiceMappingDigest();
+	else
+		actorConversationServiceMappingDigest.fill(0);
+
+	portConversationMaskTlvs = view.hasPortConversationMaskTlvs();
+	actorPortConversationMaskState.state = portConversationMaskTlvs ? view.getActorPortConversationMaskState().state : 0;
+	actorPortConversationMask.reset();
+	if (portConversationMaskTlvs)
+	{
+		for (int tlv = 0; tlv < 4; tlv++)
+		{
+			const unsigned char* pMask = view.getActorPortConversationMaskOctets(tlv);
+			for (int octet = 0; octet < 128; octet++)
+			{
+				if (pMask[octet] == 0)                        // Masks are usually sparse or all ones, so skip empty octets
+					continue;
+				int cid = (tlv * 1024) + (octet * 8);
+				for (int bit = 0; bit < 8; bit++)
+					if (pMask[octet] & (0x80 >> bit))
+						actorPortConversationMask.set(cid + bit);
+			}
+		}
+	}
+	return (true);
+}
+
+
+
+LacpduView::LacpduView(const unsigned char* buffer, unsigned short length)
+	: pBuffer(buffer), length(0), isValid(false)
+{
+	// Value of the Length octet for each recognized TLV type (Terminator is zero)
+	static const unsigned char tlvLength[numTlvTypes] = { 0, 20, 20, 16, 6, 20, 131, 130, 130, 130, 18 };
+
+	tlvOffset.fill(0);
+	if ((buffer == nullptr) || (length < 2) || (buffer[0] != LacpduSubType))
+		return;
+
+	unsigned short offset = 2;                               // First TLV follows the Subtype and Version Number
+	while (offset + 2 <= length)
+	{
+		unsigned char type = buffer[offset];
+		unsigned char tlvLen = buffer[offset + 1];
+		if (type == TERMINATOR)
+		{
+			if (tlvLen != 0)
+				return;
+			tlvOffset[TERMINATOR] = offset;
+			this->length = offset + 2;
+			break;
+		}
+		if ((tlvLen < 2) || (offset + tlvLen > length))
+			return;
+		if (type < numTlvTypes)
+		{
+			if (tlvLen != tlvLength[type])
+				return;
+			if (tlvOffset[type] == 0)                        // Keep the first copy of a repeated TLV
+				tlvOffset[type] = offset;
+		}
+		offset += tlvLen;
+	}
+
+	isValid = (tlvOffset[TERMINATOR] != 0) && (tlvOffset[ACTOR_INFORMATION] != 0) &&
+		(tlvOffset[PARTNER_INFORMATION] != 0) && (tlvOffset[COLLECTOR_INFORMATION] != 0);
+}
+
+
+LacpduView::~LacpduView()
+{
+}
+
+bool LacpduView::valid() const
+{
+	return (isValid);
+}
+
+unsigned short LacpduView::getLength() const
+{
+	return (length);
+}
+
+unsigned short LacpduView::get16(unsigned short offset) const
+{
+	return ((unsigned short)((pBuffer[offset] << 8) | pBuffer[offset + 1]));
+}
+
+unsigned long LacpduView::get32(unsigned short offset) const
+{
+	return (((unsigned long)get16(offset) << 16) | get16(offset + 2));
+}
+
+unsigned long long LacpduView::get48(unsigned short offset) const
+{
+	return (((unsigned long long)get16(offset) << 32) | get32(offset + 2));
+}
+
+sysId LacpduView::getSystem(unsigned short offset) const     // offset of the Actor or Partner Information TLV
+{
+	sysId system;
+	system.id = 0;
+	system.addr = get48(offset + 4);
+	system.pri = get16(offset + 2);
+	return (system);
+}
+
+portId LacpduView::getPort(unsigned short offset) const      // offset of the Actor or Partner Information TLV
+{
+	portId port;
+	port.id = 0;
+	port.pri = get16(offset + 12);
+	port.num = get16(offset + 14);
+	return (port);
+}
+
+unsigned char LacpduView::getVersionNumber() const
+{
+	return (pBuffer[1]);
+}
+
+sysId LacpduView::getActorSystem() const
+{
+	return (getSystem(tlvOffset[ACTOR_INFORMATION]));
+}
+
+unsigned short LacpduView::getActorKey() const
+{
+	return (get16(tlvOffset[ACTOR_INFORMATION] + 10));
+}
+
+portId LacpduView::getActorPort() const
+{
+	return (getPort(tlvOffset[ACTOR_INFORMATION]));
+}
+
+LacpPortState LacpduView::getActorState() const
+{
+	LacpPortState state;
+	state.state = pBuffer[tlvOffset[ACTOR_INFORMATION] + 16];
+	return (state);
+}
+
+sysId LacpduView::getPartnerSystem() const
+{
+	return (getSystem(tlvOffset[PARTNER_INFORMATION]));
+}
+
+unsigned short LacpduView::getPartnerKey() const
+{
+	return (get16(tlvOffset[PARTNER_INFORMATION] + 10));
+}
+
+portId LacpduView::getPartnerPort() const
+{
+	return (getPort(tlvOffset[PARTNER_INFORMATION]));
+}
+
+LacpPortState LacpduView::getPartnerState() const
+{
+	LacpPortState state;
+	state.state = pBuffer[tlvOffset[PARTNER_INFORMATION] + 16];
+	return (state);
+}
+
+unsigned short LacpduView::getCollectorMaxDelay() const
+{
+	return (get16(tlvOffset[COLLECTOR_INFORMATION] + 2));
+}
+
+bool LacpduView::hasPortAlgorithmTlv() const
+{
+	return (tlvOffset[PORT_ALGORITHM] != 0);
+}
+
+Aggregator::portAlgorithms LacpduView::getActorPortAlgorithm() const
+{
+	return ((Aggregator::portAlgorithms)get32(tlvOffset[PORT_ALGORITHM] + 2));
+}
+
+bool LacpduView::hasPortConversationIdDigestTlv() const
+{
+	return (tlvOffset[PORT_CONVERSATION_ID_DIGEST] != 0);
+}
+
+unsigned short LacpduView::getLinkNumberID() const
+{
+	return (get16(tlvOffset[PORT_CONVERSATION_ID_DIGEST] + 2));
+}
+
+std::array<unsigned char, 16> LacpduView::getActorConversationLinkListDigest() const
+{
+	std::array<unsigned char, 16> digest;
+	const unsigned char* pDigest = pBuffer + tlvOffset[PORT_CONVERSATION_ID_DIGEST] + 4;
+	std::copy(pDigest, pDigest + 16, digest.begin());
+	return (digest);
+}
+
+bool LacpduView::hasPortConversationServiceMappingDigestTlv() const
+{
+	return (tlvOffset[PORT_CONVERSATION_SERVICE_MAPPING] != 0);
+}
+
+std::array<unsigned char, 16> LacpduView::getActorConversationServiceMappingDigest() const
+{
+	std::array<unsigned char, 16> digest;
+	const unsigned char* pDigest = pBuffer + tlvOffset[PORT_CONVERSATION_SERVICE_MAPPING] + 2;
+	std::copy(pDigest, pDigest + 16, digest.begin());
+	return (digest);
+}
+
+bool LacpduView::hasPortConversationMaskTlvs() const
+{
+	return ((tlvOffset[PORT_CONVERSATION_MASK_1] != 0) && (tlvOffset[PORT_CONVERSATION_MASK_2] != 0) &&
+		(tlvOffset[PORT_CONVERSATION_MASK_3] != 0) && (tlvOffset[PORT_CONVERSATION_MASK_4] != 0));
+}
+
+AggPortConversationMaskState LacpduView::getActorPortConversationMaskState() const
+{
+	AggPortConversationMaskState state;
+	state.state = pBuffer[tlvOffset[PORT_CONVERSATION_MASK_1] + 2];
+	return (state);
+}
+
+const unsigned char* LacpduView::getActorPortConversationMaskOctets(int tlv) const
+{
+	if (tlv == 0)
+		return (pBuffer + tlvOffset[PORT_CONVERSATION_MASK_1] + 3);    // Mask 1 also carries the Mask State
+	return (pBuffer + tlvOffset[PORT_CONVERSATION_MASK_1 + tlv] + 2);
+}
+
+bool LacpduView::getActorPortConversationMask(unsigned short conversationId) const
+{
+	const unsigned char* pMask = getActorPortConversationMaskOctets((conversationId >> 10) & 3);
+	return ((pMask[(conversationId & 0x3ff) >> 3] & (0x80 >> (conversationId & 7))) != 0);
+}
@@ -21,6 +21,7 @@ limitations under the License.
 #include "AggPort.h"
 
 // class AggPort;
+class LacpduView;
 
 /*
 *     The Link Aggregation Control Protocol Data Unit (Lacpdu) class inherits the Sdu base class.  An Lacdpu 
@@ -36,6 +37,11 @@ public:
 	~Lacpdu();
 
 	static const Lacpdu& getLacpdu(Frame& LacpFrame);      // Returns a constant reference to the Lacpdu
+	virtual unsigned short getLength() const override;
+
+	static const unsigned short maxEncodedLength = 110 + 6 + 20 + 18 + 131 + (3 * 130);  // Subtype through Reserved, all TLVs
+	unsigned short encode(unsigned char* buffer, unsigned short size) const;  // Writes wire format; returns octets (0 if no room)
+	bool decode(const LacpduView& view);                         // Sets all fields from a valid view; false if view not valid
 
 	unsigned char VersionNumber;
 
@@ -73,3 +79,67 @@ public:
 	/**/
 };
 
+
+/*
+*     Class LacpduView reads a LACPDU in IEEE 802.1AX wire format directly from a received buffer, starting
+*         at the Subtype octet.  The constructor checks the Subtype and walks the TLV chain once, recording 
+*         where each recognized TLV starts.  The accessors then read their field straight from the buffer,
+*         so nothing is copied and the buffer must outlive the view.
+*     A view is not valid if the Subtype is not LACP, a recognized TLV has the wrong length, any TLV runs
+*         past the end of the buffer, or the Actor, Partner, Collector or Terminator TLV is missing.
+*         Unrecognized TLV types are skipped so later protocol versions can still be parsed.
+*     Multi-octet fields are big endian.  Conversation ID n of the Port Conversation Mask is bit (7 - n % 8)
+*         of octet n / 8 of the mask, which is split 1024 Conversation IDs apiece across the four Mask TLVs.
+*/
+
+class LacpduView
+{
+public:
+	LacpduView(const unsigned char* buffer, unsigned short length);
+	~LacpduView();
+	LacpduView(LacpduView& copySource) = delete;             // Disable copy constructor
+	LacpduView& operator= (const LacpduView&) = delete;      // Disable assignment operator
+
+	enum tlvTypes { TERMINATOR, ACTOR_INFORMATION, PARTNER_INFORMATION, COLLECTOR_INFORMATION,
+		PORT_ALGORITHM, PORT_CONVERSATION_ID_DIGEST, PORT_CONVERSATION_MASK_1, PORT_CONVERSATION_MASK_2,
+		PORT_CONVERSATION_MASK_3, PORT_CONVERSATION_MASK_4, PORT_CONVERSATION_SERVICE_MAPPING, numTlvTypes };
+
+	bool valid() const;
+	unsigned short getLength() const;                        // Octets from Subtype through the Terminator TLV
+
+	unsigned char getVersionNumber() const;
+	sysId getActorSystem() const;
+	unsigned short getActorKey() const;
+	portId getActorPort() const;
+	LacpPortState getActorState() const;
+	sysId getPartnerSystem() const;
+	unsigned short getPartnerKey() const;
+	portId getPartnerPort() const;
+	LacpPortState getPartnerState() const;
+	unsigned short getCollectorMaxDelay() const;
+
+	// Version 2 TLVs:  only read a field if the "has" routine for its TLV returns true
+	bool hasPortAlgorithmTlv() const;
+	Aggregator::portAlgorithms getActorPortAlgorithm() const;
+	bool hasPortConversationIdDigestTlv() const;
+	unsigned short getLinkNumberID() const;
+	std::array<unsigned char, 16> getActorConversationLinkListDigest() const;
+	bool hasPortConversationServiceMappingDigestTlv() const;
+	std::array<unsigned char, 16> getActorConversationServiceMappingDigest() const;
+	bool hasPortConversationMaskTlvs() const;                // True only if all four Mask TLVs are present
+	AggPortConversationMaskState getActorPortConversationMaskState() const;
+	bool getActorPortConversationMask(unsigned short conversationId) const;
+	const unsigned char* getActorPortConversationMaskOctets(int tlv) const;   // 128 octets of Mask TLV tlv (0..3)
+
+private:
+	const unsigned char* pBuffer;
+	unsigned short length;
+	bool isValid;
+	std::array<unsigned short, numTlvTypes> tlvOffset;     // Offset of the Type octet of each TLV (0 if absent)
+
+	unsigned short get16(unsigned short offset) const;
+	unsigned long get32(unsigned short offset) const;
+	unsigned long long get48(unsigned short offset) const;
+	sysId getSystem(unsigned short offset) const;
+	portId getPort(unsigned short offset) const;
+};
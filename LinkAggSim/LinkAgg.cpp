@@ -16,11 +16,17 @@ limitations under the License.
 
 #include "stdafx.h"
 #include "LinkAgg.h"
+#include "Trace.h"
+#include "ConsoleReport.h"
+#include <cstring>
 
 
 LinkAgg::LinkAgg(unsigned short device, unsigned char version)
 	: Component(ComponentTypes::LINK_AGG), devNum(device), LacpVersion(version)
 {
+	lastRunActive = true;
+	pTimerBank = make_shared<TimerBank>(AggPort::numTimers);
+	timersAttached = 0;
 //	cout << "LagShim Constructor called." << endl;
 }
 
@@ -32,13 +38,32 @@ LinkAgg::~LinkAgg()
 //	cout << "LagShim Destructor called." << endl;
 }
 
+shared_ptr<AggPort> LinkAgg::addAggPort(shared_ptr<Iss> pMac, sysId system, bool withAggregator, unsigned short sysNum)
+{
+	shared_ptr<AggPort> pAggPort = make_shared<AggPort>(LacpVersion, sysNum, (unsigned short)pAggPorts.size());
+	pAggPort->setActorSystem(system);                  // Assign Aggregation Port to the system
+	pAggPort->pIss = pMac;                             // Attach the Mac to the Aggregation Port
+	if (withAggregator && (pAggregators.size() == pAggPorts.size()))
+		pAggregators.push_back(pAggPort);              // Aggregation Port/Aggregator pair
+	pAggPorts.push_back(pAggPort);
+	return (pAggPort);
+}
+
+shared_ptr<Aggregator> LinkAgg::addAggregator(sysId system, unsigned short sysNum)
+{
+	shared_ptr<Aggregator> pAggregator = make_shared<Aggregator>(LacpVersion, sysNum, (unsigned short)pAggregators.size());
+	pAggregator->setActorSystem(system);               // Assign Aggregator to the system
+	pAggregators.push_back(pAggregator);
+	return (pAggregator);
+}
+
 void LinkAgg::reset()
 {
 	for (auto& pPort : pAggPorts)              // For each Aggregation Port:
 	{
 		pPort->reset();
 
-		if (SimLog::Debug > 12)
+		if (SimLog::debug<12>())
 		{
 			AggPort& port = *pPort;
 			SimLog::logFile << "Time " << SimLog::Time << ":  Sys " << hex << port.get_aAggActorSystemID()
@@ -53,6 +78,8 @@ void LinkAgg::reset()
 	{
 		pAgg->reset();
 	}
+	lastRunActive = true;
+	selectionState.clear();
 }
 
 
@@ -60,10 +87,16 @@ void LinkAgg::timerTick()
 {
 	if (!suspended)
 	{
-		for (auto& pPort : pAggPorts)              // For each Aggregation Port:
-		{
-			pPort->timerTick();
-		}
+		attachTimers();
+		pTimerBank->timerTick();                   // Equivalent to calling timerTick() of each Aggregation Port
+	}
+}
+
+void LinkAgg::attachTimers()
+{
+	for (; timersAttached < pAggPorts.size(); timersAttached++)
+	{
+		TimerBank::moveSlot(pAggPorts[timersAttached]->timerSlot, pTimerBank);
 	}
 }
 
@@ -71,10 +104,12 @@ void LinkAgg::timerTick()
 void LinkAgg::run(bool singleStep)
 {
 	unsigned short nPorts = pAggPorts.size();
+	unsigned short nAggregators = pAggregators.size();
 	unique_ptr<Frame> pTempFrame = nullptr;
 
 	if (!suspended)       
 	{
+		bool active = false;         // Set if anything other than a timer changes in this run
 
 		// Collect
 		for (unsigned short i = 0; i < nPorts; i++)              // For each Aggregation Port:
@@ -82,7 +117,12 @@ void LinkAgg::run(bool singleStep)
 			pTempFrame = move(pAggPorts[i]->pIss->Indication());   // Get ingress frame, if available, from ISS
 			if (pTempFrame)                                        // If there is an ingress frame
 			{
-				if (SimLog::Debug > 5)
+				active = true;
+				if ((SimLog::debug<5>()) && TraceLog::enabled)
+				{
+					TraceLog::lagRxFrame(*pAggPorts[i], *pTempFrame);
+				}
+				else if (SimLog::debug<5>())
 				{
 					SimLog::logFile << "Time " << SimLog::Time << "    Lag in Device:Port " << hex << pAggPorts[i]->actorSystem.addrMid
 						<< ":" << pAggPorts[i]->actorPort.num << " receiving frame ";
@@ -93,16 +133,20 @@ void LinkAgg::run(bool singleStep)
 					(pTempFrame->getNextEtherType() == SlowProtocolsEthertype) && (pTempFrame->getNextSubType() == LacpduSubType))
 				{
 					pAggPorts[i]->pRxLacpFrame = move(pTempFrame);                   // then pass to LACP RxSM
+					pAggPorts[i]->lacpdusRx.increment();
 				}
 				else if (collectFrame(*pAggPorts[i], *pTempFrame))                   // else verify this frame can be collected through this AggPort
 				{															         //    and send it up stack through the selected Aggregator
-					pAggregators[pAggPorts[i]->actorPortAggregatorIndex]->indications.push(move(pTempFrame));
+					Aggregator& agg = *pAggregators[pAggPorts[i]->actorPortAggregatorIndex];
+					if (agg.indications.push(move(pTempFrame)))
+						agg.framesRxOK.increment();
 				}
 			}
 		}
 
 		// Check for administrative changes to Aggregator configuration
-		LinkAgg::LacpSelection::adminAggregatorUpdate(pAggPorts, pAggregators);
+		active |= adminChangePending();
+		LinkAgg::LacpSelection::adminAggregatorUpdate(pAggPorts, pAggregators, selectionIndex);
 
 		// Run state machines
 		int transitions = 0;
@@ -114,17 +158,23 @@ void LinkAgg::run(bool singleStep)
 			transitions += AggPort::LacpMuxSM::run(*pAggPorts[i], true);
 		}
 //		updateAggregatorStatus();
+		active |= csdcChangePending();
 		runCSDC();
 
 		//TODO:  Can you aggregate ports with different LACP versions?  Do you need to test for it?  Does partner LACP version need to be in DRCPDU?
-		LinkAgg::LacpSelection::runSelection(pAggPorts, pAggregators);
+		LinkAgg::LacpSelection::runSelection(pAggPorts, pAggregators, selectionIndex);
+		active |= updateSelectionState();
 
 		for (unsigned short i = 0; i < nPorts; i++)              // For each Aggregation Port:
 		{
 //			transitions += AggPort::LacpPeriodicSM::runPeriodicSM(*pAggPorts[i], true);
 			transitions += AggPort::LacpPeriodicSM::run(*pAggPorts[i], true);
 
-			if ((transitions && (SimLog::Debug > 8)) || (SimLog::Debug > 12))
+			if (((transitions && (SimLog::debug<8>())) || (SimLog::debug<12>())) && TraceLog::enabled)
+			{
+				TraceLog::lacpPortState(*pAggPorts[i]);
+			}
+			else if ((transitions && (SimLog::debug<8>())) || (SimLog::debug<12>()))
 			{
 				SimLog::logFile << "Time " << SimLog::Time << ":  Sys " << hex << pAggPorts[i]->get_aAggActorSystemID()
 					<< ":  Port " << hex << pAggPorts[i]->get_aAggPortActorPort() << dec
@@ -145,7 +195,7 @@ void LinkAgg::run(bool singleStep)
 		}
 
 		// Distribute
-		for (unsigned short i = 0; i < nPorts; i++)              // For each Aggregator:
+		for (unsigned short i = 0; i < nAggregators; i++)        // For each Aggregator:
 		{
 			if (pAggregators[i]->getEnabled() && !pAggregators[i]->requests.empty())  // If there is an egress frame at Aggregator
 			{
@@ -153,7 +203,11 @@ void LinkAgg::run(bool singleStep)
 				pAggregators[i]->requests.pop();
 				if (pTempFrame)                                         // Shouldn't be necessary since already tested that there was a frame
 				{
-					if (SimLog::Debug > 5)
+					if ((SimLog::debug<5>()) && TraceLog::enabled)
+					{
+						TraceLog::lagTxFrame(*pAggregators[i], *pTempFrame);
+					}
+					else if (SimLog::debug<5>())
 					{
 						SimLog::logFile << "Time " << SimLog::Time << ":   Device:Aggregator " << hex << pAggregators[i]->actorSystem.addrMid
 							<< ":" << pAggregators[i]->aggregatorIdentifier << " transmitting frame ";
@@ -164,16 +218,129 @@ void LinkAgg::run(bool singleStep)
 					if (pEgressPort)
 					{
 						pEgressPort->pIss->Request(move(pTempFrame));     //    Send frame through egress Aggregation Port
+						pAggregators[i]->framesTxOK.increment();
 					}
+					else
+					{
+						pAggregators[i]->framesDiscardedOnTx.increment();
+					}
+					active = true;
 				}
 			}
 		}
 
+		lastRunActive = active || (transitions > 0);
 
 	}
 }
 
 
+/*
+*   The LinkAgg is idle if the last run() changed nothing but timer counts, no management change or frame is waiting,
+*     and each port's operational status is unchanged.  In that case running another tick would change nothing
+*     until a timer expires, so the wakeup time is the earliest timer expiration of any Aggregation Port.
+*/
+int LinkAgg::nextWakeup() const
+{
+	int wakeup = SimLog::Never;
+
+	if (!suspended)
+	{
+		bool busy = lastRunActive || adminChangePending() || csdcChangePending();
+
+		for (auto& pPort : pAggPorts)
+		{
+			busy |= (pPort->pRxLacpFrame || pPort->changeActorAdmin || pPort->changeAdminLinkNumberID ||
+				(pPort->PortEnabled != pPort->pIss->getOperational()));
+		}
+		wakeup = pTimerBank->nextWakeup();
+		for (size_t i = timersAttached; i < pAggPorts.size(); i++)    // Ports added since the last timerTick
+		{
+			wakeup = std::min(wakeup, pAggPorts[i]->nextWakeup());
+		}
+		for (auto& pAgg : pAggregators)
+		{
+			busy |= (!pAgg->requests.empty() || !pAgg->indications.empty());
+		}
+		if (busy)
+			wakeup = SimLog::Time;
+	}
+	return (wakeup);
+}
+
+void LinkAgg::skipTicks(int ticks)
+{
+	if (!suspended)
+	{
+		attachTimers();
+		pTimerBank->skipTicks(ticks);
+	}
+}
+
+bool LinkAgg::adminChangePending() const
+{
+	bool pending = false;
+
+	for (auto& pAgg : pAggregators)            // Same tests as adminAggregatorUpdate
+	{
+		pending |= (pAgg->changeActorSystem || (pAgg->actorOperAggregatorKey != pAgg->actorAdminAggregatorKey) ||
+			(!pAgg->getEnabled() && !pAgg->lagPorts.empty()));
+	}
+	for (auto& pPort : pAggPorts)
+	{
+		pending |= pPort->changeActorSystem;
+	}
+	return (pending);
+}
+
+bool LinkAgg::csdcChangePending() const
+{
+	bool pending = false;
+
+	for (auto& pPort : pAggPorts)
+	{
+		pending |= portChangePending(*pPort);
+	}
+	for (auto& pAgg : pAggregators)
+	{
+		pending |= aggChangePending(*pAgg);
+	}
+	return (pending);
+}
+
+bool LinkAgg::portChangePending(const AggPort& port)
+{
+	return (port.changeActorDistributing || port.changePortLinkState || port.changePartnerOperDistAlg);
+}
+
+bool LinkAgg::aggChangePending(const Aggregator& agg)
+{
+	return (agg.changeActorDistAlg || agg.changePartnerAdminDistAlg || agg.changeDistAlg || agg.changeLinkState ||
+		agg.changeAggregationLinks || agg.changeCSDC || agg.changeDistributing);
+}
+
+bool LinkAgg::updateSelectionState()
+{
+	bool changed = (selectionState.size() != pAggPorts.size() + pAggregators.size());
+	selectionState.resize(pAggPorts.size() + pAggregators.size());
+	unsigned short i = 0;
+
+	for (auto& pPort : pAggPorts)
+	{
+		unsigned long state = pPort->portSelected | (pPort->Ready << 2) | (pPort->wtrRevertOK << 3) |
+			(pPort->PortMoved << 4) | (pPort->newPartner << 5) | (pPort->actorPortAggregatorIndex << 16);
+		changed |= (selectionState[i] != state);
+		selectionState[i++] = state;
+	}
+	for (auto& pAgg : pAggregators)
+	{
+		unsigned long state = pAgg->lagPorts.size() | (pAgg->selectedLagPorts.size() << 16);
+		changed |= (selectionState[i] != state);
+		selectionState[i++] = state;
+	}
+	return (changed);
+}
+
 void LinkAgg::resetCSDC()
 {
 	for (auto pAgg : pAggregators)            // May want to wrap this in a while loop and repeat until no flags set
@@ -191,8 +358,9 @@ void LinkAgg::resetCSDC()
 		agg.operDiscardWrongConversation = (agg.adminDiscardWrongConversation == adminValues::FORCE_TRUE);
 
 		agg.activeLagLinks.clear();
-		agg.conversationLinkVector.fill(0);
-		agg.conversationPortVector.fill(0);
+		agg.pConversationVectors.reset();
+		agg.linkConversations.clear();
+		agg.linkPorts.clear();
 
 		agg.changeActorDistAlg = false;
 		agg.changeConvLinkList = false;
@@ -205,22 +373,35 @@ void LinkAgg::resetCSDC()
 	//TODO: verify that some per-port machine resets all conversation masks, link number, local copies of dwc.
 }
 
+/*
+*   runCSDC only does work for ports and Aggregators with a change flag set, so in steady state it just tests the flags.
+*     Each Aggregator with a pending change is put on a worklist, and updateMask processes one change at a time until 
+*     no flags remain set (limited to 10 steps in case the changes do not settle).
+*/
 void LinkAgg::runCSDC()
 {
-	for (auto pPort : pAggPorts)           // Walk through all Aggregation Ports
+	for (auto& pPort : pAggPorts)           // Walk through all Aggregation Ports with a change to pass to the Aggregator
 	{
-		updatePartnerDistributionAlgorithm(*pPort);
+		if (portChangePending(*pPort))
+			updatePartnerDistributionAlgorithm(*pPort);
 	}
-	for (auto pAgg : pAggregators)            // May want to wrap this in a while loop and repeat until no flags set
+
+	dirtyAggregators.clear();
+	for (unsigned short i = 0; i < pAggregators.size(); i++)
+	{
+		if (aggChangePending(*pAggregators[i]))
+			dirtyAggregators.push_back(i);
+	}
+	for (auto aggIndex : dirtyAggregators)
 	{
-		updateMask(*pAgg);
+		updateMask(*pAggregators[aggIndex]);
 	}
 }
 
 void LinkAgg::updateMask(Aggregator& agg)
 {
 	int loop = 0;
-	do
+	while (aggChangePending(agg) && (loop < 10))
 	{
 		if (agg.changeActorDistAlg)
 		{
@@ -266,13 +447,13 @@ void LinkAgg::updateMask(Aggregator& agg)
 		}
 
 		loop++;
-	} while (loop < 10);
+	}
 
 }
 
 void LinkAgg::debugUpdateMask(Aggregator& thisAgg, std::string routine)
 {
-	if (SimLog::Debug > 7)
+	if (SimLog::debug<7>())
 	{
 		SimLog::logFile << "Time " << SimLog::Time
 			<< ":   Device:Aggregator " << hex << thisAgg.actorSystem.addrMid << ":" << thisAgg.aggregatorIdentifier
@@ -297,7 +478,7 @@ void LinkAgg::updatePartnerDistributionAlgorithm(AggPort& port)
 	//     Aggregator to use the partnerAdmin... values (including port that is DEFAULTED, is version 1 (?), 
 	//     or did not receive the proper V2 TLVs from the partner.
 
-	if ((SimLog::Debug > 7) && port.changePartnerOperDistAlg)
+	if ((SimLog::debug<7>()) && port.changePartnerOperDistAlg)
 	{
 		SimLog::logFile << "Time " << SimLog::Time
 			<< ":   Device:Aggregator " << hex << ":  *** Port " << port.actorSystem.addrMid << ":" << port.actorPort.num
@@ -317,7 +498,7 @@ void LinkAgg::updatePartnerDistributionAlgorithm(AggPort& port)
 			agg.partnerConversationServiceMappingDigest = agg.partnerAdminConversationServiceMappingDigest;
 			agg.changeDistAlg = true;
 			// Could optimize further processing by only setting change flag if new values differ from old values.
-			if ((SimLog::Debug > 3))
+			if ((SimLog::debug<3>()))
 			{
 				SimLog::logFile << "Time " << SimLog::Time << hex << ":  *** Port " << port.actorSystem.addrMid << ":" << port.actorPort.num
 					<< " setting default partner algorithm on Aggregator " << port.actorPortAggregatorIdentifier << "  ***" << dec << endl;
@@ -330,7 +511,7 @@ void LinkAgg::updatePartnerDistributionAlgorithm(AggPort& port)
 			agg.partnerConversationServiceMappingDigest = port.partnerOperConversationServiceMappingDigest;
 			agg.changeDistAlg = true;
 			// Could optimize further processing by only setting change flag if new values differ from old values.
-			if ((SimLog::Debug > 3))
+			if ((SimLog::debug<3>()))
 			{
 				SimLog::logFile << "Time " << SimLog::Time << hex << ":  *** Port " << port.actorSystem.addrMid << ":" << port.actorPort.num
 					<< " setting partner's algorithm on Aggregator " << port.actorPortAggregatorIdentifier << "  ***" << dec << endl;
@@ -353,7 +534,7 @@ void LinkAgg::updateActorDistributionAlgorithm(Aggregator& thisAgg)
 		if (port.actorOperPortState.sync)   //     If the AggPort is attached to Aggregator
 		{
 			port.NTT = true;                //         then communicate change to partner
-			if (SimLog::Debug > 6)
+			if (SimLog::debug<6>())
 			{
 				SimLog::logFile << "Time " << SimLog::Time << ":   Device:Port " << hex << port.actorSystem.addrMid
 					<< ":" << port.actorPort.num << " NTT: Change actor dist algorithm on Link " << dec << port.LinkNumberID
@@ -421,7 +602,7 @@ void LinkAgg::compareDistributionAlgorithms(Aggregator& thisAgg)
 	//TODO:  Set differentPortConversationDigests if actor and partner Link Numbers don't match 
 	//         (are they guaranteed to be stable by the time actor.sync and partner.sync?)
 	//         (will changes to actor or partner set the change distribution algorithms flag?)
-	if (SimLog::Debug > 6)
+	if (SimLog::debug<6>())
 	{
 		SimLog::logFile << "Time " << SimLog::Time
 			<< ":   Device:Aggregator " << hex << thisAgg.actorSystem.addrMid << ":" << thisAgg.aggregatorIdentifier
@@ -435,7 +616,7 @@ void LinkAgg::compareDistributionAlgorithms(Aggregator& thisAgg)
 
 void LinkAgg::updateActiveLinks(Aggregator& thisAgg)
 {
-	std::list<unsigned short> newActiveLinkList;  // Build a new list of the link numbers active on the LAG
+	PortList newActiveLinkList;                   // Build a new list of the link numbers active on the LAG
 	for (auto lagPortIndex : thisAgg.lagPorts)      //   from list of Aggregation Ports on the LAG
 	{
 		AggPort& port = *(pAggPorts[lagPortIndex]);
@@ -461,7 +642,7 @@ void LinkAgg::updateActiveLinks(Aggregator& thisAgg)
 			if (oldLinkNumberID != port.LinkNumberID)
 			{
 				port.NTT = true;
-				if (SimLog::Debug > 6)
+				if (SimLog::debug<6>())
 				{
 					SimLog::logFile << "Time " << SimLog::Time << ":   Device:Port " << hex << port.actorSystem.addrMid
 						<< ":" << port.actorPort.num << " NTT: Link Number changing to  " << dec << port.LinkNumberID << endl;
@@ -484,16 +665,34 @@ void LinkAgg::updateConversationPortVector(Aggregator& thisAgg)
 {
 	if (thisAgg.activeLagLinks.empty())         // If there are no links active on the LAG 
 	{
-		thisAgg.conversationLinkVector.fill(0);          // Clear all Conversation ID to Link associations; 
-		thisAgg.conversationPortVector.fill(0);          // Clear all Conversation ID to Port associations; 
+		thisAgg.pConversationVectors.reset();            // Clear all Conversation ID to Link and Port associations,
+		                                                 //    and stop distributing all Conversation IDs
+		thisAgg.linkConversations.clear();
+		thisAgg.linkPorts.clear();
 		// Don't need to update conversation masks because disableCollectingDistributing will clear masks when links go inactive
 	}
 	else                                        // Otherwise there are active links on the LAG
 	{
+		std::array<unsigned short, 4096> oldConvLinkVector = thisAgg.conversationVectors().conversationLinkVector;
 		updateConversationLinkVector(thisAgg);           // Create new Conversation ID to Link associations
 
-		std::array<unsigned short, 4096> newConvPortVector;  // Create temporary new CID to Port vector
-		newConvPortVector.fill(0);                           // Clear new Conversation ID to Port associations; 
+		// The Conversation ID to Port vector is updated incrementally:  only the Conversation IDs that moved to a 
+		//   different link, or whose link moved to a different port, are changed.
+		std::vector<unsigned short> movedConvIDs;
+		if (thisAgg.conversationVectors().conversationLinkVector != oldConvLinkVector)
+		{
+			thisAgg.linkConversations.clear();               // Rebuild the Link to Conversation ID lists in one pass
+			for (unsigned short cid = 0; cid < 4096; cid++)
+			{
+				unsigned short link = thisAgg.conversationVectors().conversationLinkVector[cid];
+				if (link > 0)
+					thisAgg.linkConversations[link].push_back(cid);
+				if (link != oldConvLinkVector[cid])
+					movedConvIDs.push_back(cid);
+			}
+		}
+
+		std::map<unsigned short, unsigned short> newLinkPorts;   // Find the port (if any) collecting on each Link Number
 		for (auto lagPortIndex : thisAgg.lagPorts)
 		{
 			AggPort& port = *(pAggPorts[lagPortIndex]);
@@ -501,28 +700,53 @@ void LinkAgg::updateConversationPortVector(Aggregator& thisAgg)
 			if (port.actorOperPortState.collecting && (port.portSelected == AggPort::selectedVals::SELECTED)
 				&& (port.LinkNumberID > 0))
 			{
-				for (unsigned short cid = 0; cid < 4096; cid++)
-				{
-					if (thisAgg.conversationLinkVector[cid] == port.LinkNumberID)
-					{
-						newConvPortVector[cid] = port.actorPort.num;
-					}
-				}
+				newLinkPorts[port.LinkNumberID] = port.actorPort.num;
 			}
 		}
 
-		if (thisAgg.conversationPortVector != newConvPortVector)
+		bool changed = false;
+		auto setConvPort = [&thisAgg, &changed](unsigned short cid, unsigned short portNum)
 		{
-			thisAgg.conversationPortVector = newConvPortVector;
-			thisAgg.changeCSDC = true;
+			if (thisAgg.conversationVectors().conversationPortVector[cid] != portNum)
+			{
+				thisAgg.conversationVectors().conversationPortVector[cid] = portNum;
+				changed = true;
+			}
+		};
+		for (auto& linkPort : thisAgg.linkPorts)             // Links that no longer have a port
+		{
+			if ((newLinkPorts.count(linkPort.first) == 0) && thisAgg.linkConversations.count(linkPort.first))
+			{
+				for (auto cid : thisAgg.linkConversations[linkPort.first])
+					setConvPort(cid, 0);
+			}
+		}
+		for (auto& linkPort : newLinkPorts)                  // Links that have a new port
+		{
+			auto oldLinkPort = thisAgg.linkPorts.find(linkPort.first);
+			if (((oldLinkPort == thisAgg.linkPorts.end()) || (oldLinkPort->second != linkPort.second))
+				&& thisAgg.linkConversations.count(linkPort.first))
+			{
+				for (auto cid : thisAgg.linkConversations[linkPort.first])
+					setConvPort(cid, linkPort.second);
+			}
 		}
+		for (auto cid : movedConvIDs)                        // Conversation IDs that have a new link
+		{
+			auto linkPort = newLinkPorts.find(thisAgg.conversationVectors().conversationLinkVector[cid]);
+			setConvPort(cid, (linkPort == newLinkPorts.end()) ? 0 : linkPort->second);
+		}
+		thisAgg.linkPorts = newLinkPorts;
+
+		if (changed)
+			thisAgg.changeCSDC = true;
 	}
 
-	if (SimLog::Debug > 4)
+	if (SimLog::debug<4>())
 	{
 		SimLog::logFile << "Time " << SimLog::Time << ":   Device:Aggregator " << hex << thisAgg.actorSystem.addrMid
 			<< ":" << thisAgg.aggregatorIdentifier << dec << " ConvLinkMap = ";
-		for (int k = 0; k < 16; k++) SimLog::logFile << "  " << thisAgg.conversationLinkVector[k];
+		for (int k = 0; k < 16; k++) SimLog::logFile << "  " << thisAgg.get_conversationLink(k);
 		SimLog::logFile << endl;
 	}
 }
@@ -535,16 +759,13 @@ void LinkAgg::updateConversationMasks(Aggregator& thisAgg)
 
 		port.actorDWC = thisAgg.operDiscardWrongConversation;  // Update port's copy of DWC
 
-		for (int convID = 0; convID < 4096; convID++)   //    for all conversation ID values.
-		{
-			bool passConvID = (port.actorOperPortState.collecting && (port.portSelected == AggPort::selectedVals::SELECTED) &&
-				(thisAgg.conversationPortVector[convID] == port.actorPort.num) && (port.actorPort.num > 0));
-				// Determine if link is active and the conversation ID maps to this port number
-
-			port.portOperConversationMask[convID] = passConvID;       // If so then distribute this conversation ID. 
-		}
+		const std::vector<unsigned short>* pConvIDs = portConversationIds(thisAgg, port.actorPort.num);
+		if (pConvIDs && port.actorOperPortState.collecting && (port.portSelected == AggPort::selectedVals::SELECTED))
+			port.portOperConversationMask.assign(*pConvIDs);  // If link is active then distribute the conversation IDs that map to this port number 
+		else
+			port.portOperConversationMask.reset();
 
-		if (SimLog::Debug > 4)
+		if (SimLog::debug<4>())
 		{
 			SimLog::logFile << "Time " << SimLog::Time << ":   Device:Port " << hex << port.actorSystem.addrMid
 				<< ":" << port.actorPort.num << " Link " << dec << port.LinkNumberID << "   ConvMask = ";
@@ -553,10 +774,14 @@ void LinkAgg::updateConversationMasks(Aggregator& thisAgg)
 		}
 
 		// Turn off distribution and collection if convID is moving between links.
-		port.distributionConversationMask = port.distributionConversationMask & port.portOperConversationMask;  
-		port.collectionConversationMask = port.collectionConversationMask & port.portOperConversationMask;      
+		port.distributionConversationMask &= port.portOperConversationMask;  
+		port.collectionConversationMask &= port.portOperConversationMask;      
 	}
 
+	// Likewise clear the egress port table, so no Conversation ID is left pointing at a port that no longer distributes it.
+	if (thisAgg.pConversationVectors)
+		thisAgg.pConversationVectors->conversationEgressPort.fill(-1);
+
 	//  Before just cleared distribution/collection masks for Conversation IDs where the port's link number did not match the conversationLinkVector.
 	//     Now want to set the distribution/collection mask for Conversation IDs where the port's link number does match.
 	//     This assures "break-before-make" behavior so no Conversation ID bit is ever set in the collection mask for more than one port.
@@ -565,6 +790,15 @@ void LinkAgg::updateConversationMasks(Aggregator& thisAgg)
 		AggPort& port = *(pAggPorts[lagPortIndex]);
 
 		port.distributionConversationMask = port.portOperConversationMask;         // Set distribution mask to the new value
+		const std::vector<unsigned short>* pConvIDs = portConversationIds(thisAgg, port.actorPort.num);
+		if (pConvIDs)                                                              //    and point the egress port table at this port
+		{
+			for (auto convID : *pConvIDs)
+			{
+				if (port.portOperConversationMask[convID])
+					thisAgg.conversationVectors().conversationEgressPort[convID] = lagPortIndex;
+			}
+		}
 
 		//TODO:  I think I need more qualification here.  Don't want to collectionConversationMask.set() if not collecting (and SELECTED and partner.sync?)
 		if (thisAgg.operDiscardWrongConversation)                                  // If enforcing Conversation-sensitive Collection
@@ -587,6 +821,44 @@ void LinkAgg::updateConversationMasks(Aggregator& thisAgg)
 	}
 }
 
+/*
+*   buildConversationMasksScalar creates a conversation mask for each port number in portNums, with the bit for a Conversation ID
+*     set if convPortVector maps that Conversation ID to the port number.  A port number of 0 gets an empty mask.
+*     It tests all 4096 Conversation IDs one bit at a time for each port, and is kept as the reference that 
+*     conversationMaskBenchmark compares ConversationMask::assign against.
+*/
+void LinkAgg::buildConversationMasksScalar(const std::array<unsigned short, 4096>& convPortVector,
+	const std::vector<unsigned short>& portNums, std::vector<std::bitset<4096>>& masks)
+{
+	masks.assign(portNums.size(), std::bitset<4096>());
+	for (size_t slot = 0; slot < portNums.size(); slot++)
+	{
+		for (int cid = 0; cid < 4096; cid++)
+			masks[slot][cid] = (portNums[slot] > 0) && (convPortVector[cid] == portNums[slot]);
+	}
+}
+
+/*
+*   Returns the list of Conversation IDs that conversationPortVector maps to portNum, or nullptr if there are none.
+*     A port is in linkPorts for at most one link, so the list is that link's list in linkConversations.
+*/
+const std::vector<unsigned short>* LinkAgg::portConversationIds(Aggregator& thisAgg, unsigned short portNum)
+{
+	if (portNum > 0)
+	{
+		for (auto& linkPort : thisAgg.linkPorts)
+		{
+			if (linkPort.second == portNum)
+			{
+				auto convIDs = thisAgg.linkConversations.find(linkPort.first);
+				if (convIDs != thisAgg.linkConversations.end())
+					return (&(convIDs->second));
+			}
+		}
+	}
+	return (nullptr);
+}
+
 void LinkAgg::updateAggregatorOperational(Aggregator& thisAgg)
 {
 	bool AggregatorUp = false;
@@ -603,8 +875,10 @@ void LinkAgg::updateAggregatorOperational(Aggregator& thisAgg)
 		thisAgg.operational = false;                // Set Aggregator ISS to not operational
 		//TODO:  flush aggregator request queue?
 
-		cout << "Time " << SimLog::Time << ":   Device:Aggregator " << hex << thisAgg.actorSystem.addrMid << ":" << thisAgg.aggregatorIdentifier
-			<< " is DOWN" << dec << endl;
+		if (ConsoleReport::lineByLine)
+			SimLog::console << "Time " << SimLog::Time << ":   Device:Aggregator " << hex << thisAgg.actorSystem.addrMid << ":" << thisAgg.aggregatorIdentifier
+				<< " is DOWN" << dec << endl;
+		ConsoleReport::count(ConsoleReport::AGGREGATOR_DOWN);
 		if (SimLog::Time > 0)
 		{
 			SimLog::logFile << "Time " << SimLog::Time << ":   Device:Aggregator " << hex << thisAgg.actorSystem.addrMid << ":" << thisAgg.aggregatorIdentifier
@@ -615,11 +889,15 @@ void LinkAgg::updateAggregatorOperational(Aggregator& thisAgg)
 	{
 		thisAgg.operational = true;                 // Set Aggregator ISS is operational
 
-		cout << "Time " << SimLog::Time << ":   Device:Aggregator " << hex << thisAgg.actorSystem.addrMid << ":" << thisAgg.aggregatorIdentifier
-			<< " is UP with Link numbers:  " << dec;
-		for (auto link : thisAgg.activeLagLinks)
-			cout << link << "  ";
-		cout << dec << endl;
+		if (ConsoleReport::lineByLine)
+		{
+			SimLog::console << "Time " << SimLog::Time << ":   Device:Aggregator " << hex << thisAgg.actorSystem.addrMid << ":" << thisAgg.aggregatorIdentifier
+				<< " is UP with Link numbers:  " << dec;
+			for (auto link : thisAgg.activeLagLinks)
+				SimLog::console << link << "  ";
+			SimLog::console << dec << endl;
+		}
+		ConsoleReport::count(ConsoleReport::AGGREGATOR_UP);
 		if (SimLog::Time > 0)
 		{
 			SimLog::logFile << "Time " << SimLog::Time << ":   Device:Aggregator " << hex << thisAgg.actorSystem.addrMid << ":" << thisAgg.aggregatorIdentifier
@@ -684,12 +962,12 @@ void LinkAgg::linkMap_EightLinkSpread(Aggregator& thisAgg)
 	// Then, create the first 8 entries in the conversation-to-link map from the first 8 rows of the Link Priority List table
 	for (int row = 0; row < nRows; row++)
 	{
-		thisAgg.conversationLinkVector[row] = 0;                                       // Link Number 0 is default if no Link Numbers in row are active
+		thisAgg.conversationVectors().conversationLinkVector[row] = 0;                                       // Link Number 0 is default if no Link Numbers in row are active
 		for (int j = 0; j < nLinks; j++)                                            // Search a row of the table
 		{                                                                           //   for the first Link Number that is active.
 			if ((convLinkPriorityList[row][j] < activeLinkNumbers.size()) && activeLinkNumbers[convLinkPriorityList[row][j]])
 			{
-				thisAgg.conversationLinkVector[row] = activeLinkNumbers[convLinkPriorityList[row][j]];    //   Copy that Link Number into map
+				thisAgg.conversationVectors().conversationLinkVector[row] = activeLinkNumbers[convLinkPriorityList[row][j]];    //   Copy that Link Number into map
 				break;                                                              //       and quit the for loop.
 			}
 		}
@@ -698,7 +976,7 @@ void LinkAgg::linkMap_EightLinkSpread(Aggregator& thisAgg)
 	// Finally, repeat first 8 entries through the rest of the conversation-to-link map
 	for (int row = nRows; row < 4096; row++)
 	{
-		thisAgg.conversationLinkVector[row] = thisAgg.conversationLinkVector[row % nRows];
+		thisAgg.conversationVectors().conversationLinkVector[row] = thisAgg.conversationVectors().conversationLinkVector[row % nRows];
 	}
 }
 /**/
@@ -707,7 +985,7 @@ void LinkAgg::linkMap_EvenOdd(Aggregator& thisAgg)
 {
 	if (thisAgg.activeLagLinks.empty())              // If there are no active links
 	{
-		thisAgg.conversationLinkVector.fill(0);         //    then the conversationLinkVector is all zero
+		thisAgg.conversationVectors().conversationLinkVector.fill(0);         //    then the conversationLinkVector is all zero
 	} 
 	else                                             // Otherwise ...
 	{
@@ -715,8 +993,8 @@ void LinkAgg::linkMap_EvenOdd(Aggregator& thisAgg)
 		unsigned short oddLink = thisAgg.activeLagLinks.back();      // Odd Conversation IDs go to highest LinkNumberID.  (Other links are standby)
 		for (int j = 0; j < 4096; j += 2)
 		{
-			thisAgg.conversationLinkVector[j] = evenLink;
-			thisAgg.conversationLinkVector[j + 1] = oddLink;
+			thisAgg.conversationVectors().conversationLinkVector[j] = evenLink;
+			thisAgg.conversationVectors().conversationLinkVector[j + 1] = oddLink;
 		}
 	}
 }
@@ -725,48 +1003,33 @@ void LinkAgg::linkMap_ActiveStandby(Aggregator& thisAgg)
 {
 	if (thisAgg.activeLagLinks.empty())              // If there are no active links
 	{
-		thisAgg.conversationLinkVector.fill(0);         //    then the conversationLinkVector is all zero
+		thisAgg.conversationVectors().conversationLinkVector.fill(0);         //    then the conversationLinkVector is all zero
 	}
 	else                                             // Otherwise ...
 	{
 		// Active link will be the lowest LinkNumberID.  All others will be Standby.
 		unsigned short activeLink = thisAgg.activeLagLinks.front();
-		thisAgg.conversationLinkVector.fill(activeLink);
+		thisAgg.conversationVectors().conversationLinkVector.fill(activeLink);
 	}
 }
 
 void LinkAgg::linkMap_AdminTable(Aggregator& thisAgg)
 {
-	thisAgg.conversationLinkVector.fill(0);                           // Start with  conversationLinkVector is all zero
+	thisAgg.conversationVectors().conversationLinkVector.fill(0);                           // Start with  conversationLinkVector is all zero
 	for (const auto& entry : thisAgg.adminConversationLinkMap)         // For each entry in the administered adminConversationLinkMap table (std::map)
 	{
 		unsigned short convID = entry.first;                       //    Get the conversation ID.
 		for (const auto& link : entry.second)                      //    Walk the prioritized list of desired links for that conversation ID.
 		{
-			if (isInList(link, thisAgg.activeLagLinks))            //    If the desired link is active on the Aggregator
+			if (thisAgg.activeLagLinks.contains(link))             //    If the desired link is active on the Aggregator
 			{
-				thisAgg.conversationLinkVector[convID] = link;        //        then put that link number in the conversationLinkVector
+				thisAgg.conversationVectors().conversationLinkVector[convID] = link;        //        then put that link number in the conversationLinkVector
 				break;
 			}
 		}
 	}
 }
 
-// Is there really no standard library routine to test if a value is in a list?
-bool LinkAgg::isInList(unsigned short val, const std::list<unsigned short>& thisList)
-{
-	bool inList = false;
-	for (auto& listVal : thisList)
-	{
-		if (listVal == val)
-		{
-			inList = true;
-			break;
-		}
-	}
-	return (inList);
-}
-
 
 bool LinkAgg::collectFrame(AggPort& thisPort, Frame& thisFrame)  // const??
 {
@@ -776,8 +1039,10 @@ bool LinkAgg::collectFrame(AggPort& thisPort, Frame& thisFrame)  // const??
 	if (collect && thisPort.actorDWC)                            // if collecting but Discard Wrong Conversation is set
 	{
 		collect = thisPort.collectionConversationMask[convID];   // then verify this Conversation ID can be received through this AggPort
+		if (!collect)
+			pAggregators[thisPort.actorPortAggregatorIndex]->framesDiscardedOnRx.increment();
 	}
-	if (SimLog::Debug > 6)
+	if (SimLog::debug<6>())
 	{
 		SimLog::logFile << "Time " << SimLog::Time << ":   Device:Port " << hex << thisPort.actorSystem.addrMid
 			<< ":" << thisPort.actorPort.num << " Link " << dec << thisPort.LinkNumberID << "  DWC " << thisPort.actorDWC << hex;
@@ -800,21 +1065,16 @@ shared_ptr<AggPort> LinkAgg::distributeFrame(Aggregator& thisAgg, Frame& thisFra
 	shared_ptr<AggPort> pEgressPort = nullptr;
 	unsigned short convID = frameConvID(thisAgg.actorPortAlgorithm, thisFrame);
 
-	// Checking conversation mask of each port on lag is inefficient for this implementation, but ensures will  
-	//   not send a frame during a transient when the conversation ID of the frame is moving between ports. 
-	//   In this simulation will never be attempting to transmit during such a transient, 
-	//   but if distribution was handled by a different thread (or in hardware) it could happen.
-	// It would also be possible to create an array of port IDs (or port pointers) per Conversation ID 
-	//   that was set to null when updating conversation masks and set to appropriate port when all masks updated.
-	//   This would be more efficient for this simulation but not done since not as described in standard.
-	for (auto lagPortIndex : thisAgg.lagPorts)
+	// The egress port table is maintained by updateConversationMasks with "break-before-make" behavior, so an entry
+	//   is cleared before the conversation ID moves and set only after the new port's mask is set.  
+	//   The port's conversation mask is still checked since the Mux machine clears it (without updating the table) 
+	//   when the port stops distributing.
+	short egressIndex = thisAgg.pConversationVectors ? thisAgg.pConversationVectors->conversationEgressPort[convID] : -1;
+	if ((egressIndex >= 0) && pAggPorts[egressIndex]->portOperConversationMask[convID])
 	{
-		if (pAggPorts[lagPortIndex]->portOperConversationMask[convID])    // will be false if port not distributing or inappropriate port for this convID
-		{
-			pEgressPort = pAggPorts[lagPortIndex];
-		}
+		pEgressPort = pAggPorts[egressIndex];
 	}
-	if (SimLog::Debug > 6)
+	if (SimLog::debug<6>())
 	{
 		SimLog::logFile << "Time " << SimLog::Time << ":   Device:Aggregator " << hex << thisAgg.actorSystem.addrMid
 			<< ":" << thisAgg.aggregatorIdentifier;
@@ -886,7 +1146,7 @@ unsigned short LinkAgg::macAddrHash(Frame& thisFrame)
 	hash = (~hash) & 0x0fff;                 // Take 1's complement
 
 	/*
-	if (SimLog::Debug > 9)   
+	if (SimLog::debug<9>())   
 	{
 		SimLog::logFile << "Time " << SimLog::Time << ":   DA " << hex << thisFrame.MacDA
 			<< "  SA " << thisFrame.MacSA << "  sum " << sum << "  hash "
@@ -33,11 +33,38 @@ public:
 	std::vector<shared_ptr<Aggregator>> pAggregators;
 	std::vector<shared_ptr<AggPort>> pAggPorts;
 
+	/*
+	*   Aggregation Ports and Aggregators can be created independently, so a LinkAgg can have any number of each.
+	*     An AggPort created withAggregator also serves as the Aggregator with the same index (the paired configuration
+	*     of 802.1AX, where each port has a preferred Aggregator), so must be added while both vectors are the same size.
+	*     A port with no Aggregator at its own index has no preferred Aggregator and selects any available Aggregator.
+	*/
+	shared_ptr<AggPort> addAggPort(shared_ptr<Iss> pMac, sysId system, bool withAggregator = false, unsigned short sysNum = 0);
+	shared_ptr<Aggregator> addAggregator(sysId system, unsigned short sysNum = 0);
+
+	static void buildConversationMasksScalar(const std::array<unsigned short, 4096>& convPortVector,
+		const std::vector<unsigned short>& portNums, std::vector<std::bitset<4096>>& masks);        // Bit-at-a-time reference
+
 	void reset();
 	void timerTick();
 	void run(bool singleStep);
+	int nextWakeup() const;
+	void skipTicks(int ticks);
 
 private:
+	shared_ptr<TimerBank> pTimerBank;                // State machine timers of all Aggregation Ports
+	size_t timersAttached;                           // Number of Aggregation Ports (from the start of pAggPorts) using pTimerBank
+	void attachTimers();                             // Moves the timers of any newly added Aggregation Ports to pTimerBank
+
+	bool lastRunActive;                              // Set if the last run() changed anything other than a timer count
+	std::vector<unsigned long> selectionState;       // Selection variables of every port and Aggregator as of the last run()
+	bool updateSelectionState();                     // Records selection variables and returns true if any have changed
+	bool adminChangePending() const;                 // True if adminAggregatorUpdate has a management change to process
+	bool csdcChangePending() const;                  // True if runCSDC has a change flag to process
+	static bool portChangePending(const AggPort& port);       // True if the port has a CSDC change flag set
+	static bool aggChangePending(const Aggregator& agg);      // True if the Aggregator has a CSDC change flag set
+	std::vector<unsigned short> dirtyAggregators;    // Index of each Aggregator with a CSDC change to process
+
 	void resetCSDC();
 	void runCSDC();
 	void updatePartnerDistributionAlgorithm(AggPort& port);
@@ -48,6 +75,7 @@ private:
 	void updateActiveLinks(Aggregator& thisAgg);
 	void updateConversationPortVector(Aggregator& thisAgg);
 	void updateConversationMasks(Aggregator& thisAgg);
+	const std::vector<unsigned short>* portConversationIds(Aggregator& thisAgg, unsigned short portNum);
 	void updateAggregatorOperational(Aggregator& thisAgg);
 	void debugUpdateMask(Aggregator& thisAgg, std::string routine);
 
@@ -57,7 +85,6 @@ private:
 	void linkMap_ActiveStandby(Aggregator& thisAgg);
 	void linkMap_EightLinkSpread(Aggregator& thisAgg);
 	void linkMap_AdminTable(Aggregator& thisAgg);
-	bool isInList(unsigned short val, const std::list<unsigned short>& thisList);
 
 	bool collectFrame(AggPort& thisPort, Frame& thisFrame);  // const??
 	shared_ptr<AggPort> LinkAgg::distributeFrame(Aggregator& thisAgg, Frame& thisFrame);
@@ -67,19 +94,45 @@ private:
 	static class LacpSelection
 	{
 	public:
+		/*
+		*   A SelectionIndex holds lookup tables of AggPorts and Aggregators so the selection logic does not have to scan all ports 
+		*     or Aggregators for each port.  The tables are built on first use within a call to runSelection or adminAggregatorUpdate,
+		*     and the Aggregator LAGID table is kept up to date as ports select Aggregators.
+		*/
+		struct SelectionIndex
+		{
+			typedef std::tuple<unsigned long long, unsigned long, unsigned short, bool> partnerKey;   // partner System, Port, Key, aggregation
+			typedef std::tuple<unsigned long long, unsigned short, unsigned long long, unsigned short> lagidKey;   // actor System, Key, partner System, Key
+			typedef std::pair<unsigned long long, unsigned short> actorKey;                          // actor System, Key
+
+			bool portsIndexed = false;
+			bool aggregatorsIndexed = false;
+			std::map<partnerKey, std::vector<unsigned short>> portsByPartner;       // AggPort indexes in ascending order
+			std::map<unsigned short, std::vector<unsigned short>> portsByNumber;    //    keyed by actorPort.num
+			std::map<lagidKey, std::set<unsigned short>> aggregatorsByLagid;       // Aggregator indexes
+			std::map<actorKey, std::vector<unsigned short>> aggregatorsByActorKey;  //    keyed by actor part of the LAGID
+		};
+
 //		static void resetSelection(AggPort& port);
-		static void runSelection(std::vector<shared_ptr<AggPort>>& pAggPorts, std::vector<shared_ptr<Aggregator>>& pAggregators);
-		static void adminAggregatorUpdate(std::vector<shared_ptr<AggPort>>& pAggPorts, std::vector<shared_ptr<Aggregator>>& pAggregators);
+		static void runSelection(std::vector<shared_ptr<AggPort>>& pAggPorts, std::vector<shared_ptr<Aggregator>>& pAggregators, SelectionIndex& index);
+		static void adminAggregatorUpdate(std::vector<shared_ptr<AggPort>>& pAggPorts, std::vector<shared_ptr<Aggregator>>& pAggregators, SelectionIndex& index);
 
 	private:
-		static int findMatchingAggregator(int thisPort, std::vector<shared_ptr<AggPort>>& pAggPorts);
+		static int findMatchingAggregator(int thisPort, std::vector<shared_ptr<AggPort>>& pAggPorts, std::vector<shared_ptr<Aggregator>>& pAggregators, SelectionIndex& index);
 		static bool matchAggregatorLagid(AggPort& port, Aggregator& agg);
 		static bool allowableAggregator(AggPort& port, Aggregator& agg);
-		static void clearAggregator(Aggregator& agg, std::vector<shared_ptr<AggPort>>& pAggPorts);
-		static int findAvailableAggregator(AggPort& thisPort, std::vector<shared_ptr<AggPort>>& pAggPorts, std::vector<shared_ptr<Aggregator>>& pAggregators);
+		static void clearAggregator(Aggregator& agg, std::vector<shared_ptr<AggPort>>& pAggPorts, SelectionIndex& index);
+		static int findAvailableAggregator(AggPort& thisPort, std::vector<shared_ptr<AggPort>>& pAggPorts, std::vector<shared_ptr<Aggregator>>& pAggregators, SelectionIndex& index);
 		static bool activeAggregator(Aggregator& agg, std::vector<shared_ptr<AggPort>>& pAggPorts);
+		static void indexPorts(SelectionIndex& index, std::vector<shared_ptr<AggPort>>& pAggPorts);
+		static void indexAggregators(SelectionIndex& index, std::vector<shared_ptr<Aggregator>>& pAggregators);
+		static SelectionIndex::partnerKey portPartner(AggPort& port);
+		static SelectionIndex::lagidKey portLagid(AggPort& port);
+		static SelectionIndex::lagidKey aggregatorLagid(Aggregator& agg);
 	};
 
+	LacpSelection::SelectionIndex selectionIndex;
+
 };
 
 union addr12
@@ -36,37 +36,82 @@ limitations under the License.
 #include "Device.h"
 #include "Mac.h"
 #include "Frame.h"
+#include "SimulationEngine.h"
+#include "ConsoleReport.h"
+#include "Trace.h"
+#include "Lacpdu.h"
+#include <chrono>
 
 
 int _tmain(int argc, _TCHAR* argv[])
 {
+	//
+	//  Command line options:
+	//      -trace <file>   record the busiest debug messages to a binary trace file instead of the log file
+	//                          (TraceDecoder <file> writes them as text)
+	//      -console <mode> report link and Aggregator events on the console:  direct, none, buffered, or summary
+	//      -metrics <file> write the statistics counters of all Devices to a CSV file (JSON if the name ends in .json)
+	//                          when the tests are done
+	//
+	std::string metricsFileName;
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		std::basic_string<_TCHAR> option(argv[i]);
+		std::basic_string<_TCHAR> value(argv[i + 1]);
+		std::string fileName(value.begin(), value.end());
+
+		if ((option == _T("-trace")) && !TraceLog::open(fileName))
+			std::cerr << "Can't create trace file " << fileName << endl;
+		if (option == _T("-console"))
+		{
+			if (value == _T("none")) ConsoleReport::setMode(ConsoleReport::NONE);
+			else if (value == _T("buffered")) ConsoleReport::setMode(ConsoleReport::BUFFERED);
+			else if (value == _T("summary")) ConsoleReport::setMode(ConsoleReport::SUMMARY);
+			else ConsoleReport::setMode(ConsoleReport::DIRECT);
+		}
+		if (option == _T("-metrics"))
+			metricsFileName = fileName;
+	}
+
+	SimLog::outputFile.open("LinkAggSim output.txt");
+
 	//	SimLog::logFile << System::DateTime::Now;
 	//	SimLog::logFile << asctime_s(); 
 	SimLog::logFile << endl;
 	SimLog::Debug = 8; // 6 9
+	Device::setThreadCount(1);   // Threads used to run Devices each tick;  results are identical for any number of threads
 
 	void send8Frames(EndStn& source);
 
-	void basicLagTest(std::vector<unique_ptr<Device>>& Devices);
-	void preferredAggregatorTest(std::vector<unique_ptr<Device>>& Devices);
-	void lagLoopbackTest(std::vector<unique_ptr<Device>>& Devices);
-	void nonAggregatablePortTest(std::vector<unique_ptr<Device>>& Devices);
-	void limitedAggregatorsTest(std::vector<unique_ptr<Device>>& Devices);
-	void dualHomingTest(std::vector<unique_ptr<Device>>& Devices);
-	void axbkHierarchicalLagTest(std::vector<unique_ptr<Device>>& Devices);
-	void distributionTest(std::vector<unique_ptr<Device>>& Devices);
-	void waitToRestoreTest(std::vector<unique_ptr<Device>>& Devices);
-	void adminVariableTest(std::vector<unique_ptr<Device>>& Devices);
+	void basicLagTest(SimulationEngine& sim);
+	void preferredAggregatorTest(SimulationEngine& sim);
+	void lagLoopbackTest(SimulationEngine& sim);
+	void nonAggregatablePortTest(SimulationEngine& sim);
+	void limitedAggregatorsTest(SimulationEngine& sim);
+	void dualHomingTest(SimulationEngine& sim);
+	void axbkHierarchicalLagTest(SimulationEngine& sim);
+	void distributionTest(SimulationEngine& sim);
+	void waitToRestoreTest(SimulationEngine& sim);
+	void adminVariableTest(SimulationEngine& sim);
+	void trafficLoadTest(SimulationEngine& sim);
+	void sharedAggregatorTest();
+	void filteringDatabaseTest();
+	void vlanTest();
+	void loopGuardTest();
+	void threadCountTest();
+	void conversationMaskBenchmark();
+	void lacpduCodecBenchmark();
 
 	cout << "*** Start of program ***" << endl << endl;
-	if (SimLog::Debug > 0)
+	if (SimLog::debug<0>())
 		SimLog::logFile << "*** Start of program ***" << endl << endl;
 
 	//
 	//  Build some Devices
 	//
 	/**/
-	std::vector<unique_ptr<Device>> Devices;   // Pointer to each device stored in a vector
+	SimulationEngine sim;                          // Simulation engine owns the Devices and the scheduled events
+	std::vector<unique_ptr<Device>>& Devices = sim.Devices;   // Pointer to each device stored in a vector
 
 	int brgCnt = 3;
 	int brgMacCnt = 8;
@@ -74,7 +119,7 @@ int _tmain(int argc, _TCHAR* argv[])
 	int endStnMacCnt = 4;
 
 	cout << "   Building Devices:  " << endl << endl;
-	if (SimLog::Debug > 0)
+	if (SimLog::debug<0>())
 		SimLog::logFile << "   Building Devices:  " << endl << endl;
 
 	for (int dev = 0; dev < brgCnt + endStnCnt; dev++)
@@ -97,7 +142,7 @@ int _tmain(int argc, _TCHAR* argv[])
 	//  Run the simulation
 	//
 	cout << endl << "   Running Simulation:  " << endl << endl;
-	if (SimLog::Debug > 0)
+	if (SimLog::debug<0>())
 		SimLog::logFile << "   Running Simulation (with Debug level " << SimLog::Debug << "):  " << endl << endl;
 
 	SimLog::Time = 0;
@@ -106,28 +151,48 @@ int _tmain(int argc, _TCHAR* argv[])
 	//  Select tests to run
 	//
 
-	// basicLagTest(Devices);
-	// preferredAggregatorTest(Devices);
-	lagLoopbackTest(Devices);
-	// nonAggregatablePortTest(Devices);
-	// limitedAggregatorsTest(Devices);
-	// dualHomingTest(Devices);
-	// axbkHierarchicalLagTest(Devices);
-	// distributionTest(Devices);
-	// waitToRestoreTest(Devices);
-	adminVariableTest(Devices);
+	// basicLagTest(sim);
+	// preferredAggregatorTest(sim);
+	lagLoopbackTest(sim);
+	// nonAggregatablePortTest(sim);
+	// limitedAggregatorsTest(sim);
+	// dualHomingTest(sim);
+	// axbkHierarchicalLagTest(sim);
+	// distributionTest(sim);
+	// waitToRestoreTest(sim);
+	adminVariableTest(sim);
+	// trafficLoadTest(sim);
+	// sharedAggregatorTest();
+	// filteringDatabaseTest();
+	// vlanTest();
+	// loopGuardTest();
+	// threadCountTest();
+	// conversationMaskBenchmark();
+	// lacpduCodecBenchmark();
+
+	if (!metricsFileName.empty())
+	{
+		std::ofstream metricsFile(metricsFileName);
+		if ((metricsFileName.size() > 5) && (metricsFileName.substr(metricsFileName.size() - 5) == ".json"))
+			Metrics::writeJson(Devices, metricsFile);
+		else
+			Metrics::writeCsv(Devices, metricsFile);
+	}
+
 	//
 	// Clean up devices.
 	//
 
 	cout << endl << "    Cleaning up devices:" << endl << endl;
-	if (SimLog::Debug > 0)
+	if (SimLog::debug<0>())
 		SimLog::logFile << "    Cleaning up devices:" << endl << endl;
 
 	Devices.clear();
+	TraceLog::close();
+	ConsoleReport::flush();
 
 	cout << endl << "*** End of program ***" << endl;
-	if (SimLog::Debug > 0)
+	if (SimLog::debug<0>())
 		SimLog::logFile << "*** End of program ***" << endl << endl;
 
 	return 0;
@@ -140,7 +205,7 @@ void send9Frames(EndStn& source)
 	source.generateTestFrame();                                                  // create and transmit un-tagged test frame
 	for (unsigned short vid = 0; vid < 8; vid++)
 	{
-		shared_ptr<VlanTag> pVtag = make_shared<VlanTag>(CVlanEthertype, vid);   // create C-VLAN Tag
+		shared_ptr<VlanTag> pVtag = FramePool::makeShared<VlanTag>(CVlanEthertype, vid);   // create C-VLAN Tag
 		source.generateTestFrame(pVtag);                                         // create and transmit C-VLAN-tagged test frame
 	}
 }
@@ -166,7 +231,7 @@ void printLinkMap(std::vector<unique_ptr<Device>>& Devices)
 					cout << pAgg->get_conversationLink(i) << "  ";
 				}
 				cout << "}" << endl;
-				if (SimLog::Debug > 0)
+				if (SimLog::debug<0>())
 				{
 					SimLog::logFile << "Time " << SimLog::Time << ":   Device:Aggregator " << hex << pAgg->actorSystem.addrMid
 						<< ":" << pAgg->get_aAggID()
@@ -185,283 +250,399 @@ void printLinkMap(std::vector<unique_ptr<Device>>& Devices)
 }
 
 /*
+*   Compares the time to build the conversation masks of a 16 port LAG bit by bit from the whole Conversation ID to
+*   port vector, and a word at a time from each port's list of Conversation IDs (as updateConversationMasks does, 
+*   using the per-link index kept by updateConversationPortVector).
 */
-void basicLagTest(std::vector<unique_ptr<Device>>& Devices)
+void conversationMaskBenchmark()
 {
-	int start = SimLog::Time;
+	const int nPorts = 16;
+	const int iterations = 10000;
+
+	std::array<unsigned short, 4096> convPortVector;
+	std::vector<unsigned short> portNums;
+	for (int i = 0; i < nPorts; i++)
+		portNums.push_back(0x100 + i);
+	for (int cid = 0; cid < 4096; cid++)
+		convPortVector[cid] = portNums[(cid / 8) % nPorts];          // runs of 8 Conversation IDs on each port
+	portNums[nPorts - 1] = 0;                                         // with one port not collecting
+
+	std::vector<std::vector<unsigned short>> portConvIDs(nPorts);    // Conversation IDs of each collecting port
+	for (int cid = 0; cid < 4096; cid++)
+	{
+		size_t slot = std::find(portNums.begin(), portNums.end(), convPortVector[cid]) - portNums.begin();
+		if (slot < portNums.size())
+			portConvIDs[slot].push_back(cid);
+	}
 
-	cout << endl << endl << "   Basic LAG Tests:  " << endl << endl;
-	if (SimLog::Debug > 0)
-		SimLog::logFile << endl << endl << "   Basic LAG Tests:  " << endl << endl;
+	std::vector<std::bitset<4096>> scalarMasks;
+	std::vector<ConversationMask> wordMasks(nPorts);
 
-	for (auto& pDev : Devices)
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < iterations; i++)
+		LinkAgg::buildConversationMasksScalar(convPortVector, portNums, scalarMasks);
+	auto scalarTime = std::chrono::steady_clock::now() - start;
+
+	start = std::chrono::steady_clock::now();
+	for (int i = 0; i < iterations; i++)
+		for (int slot = 0; slot < nPorts; slot++)
+			wordMasks[slot].assign(portConvIDs[slot]);
+	auto wordTime = std::chrono::steady_clock::now() - start;
+
+	bool match = true;
+	for (int slot = 0; slot < nPorts; slot++)
+		match &= ((std::bitset<4096>)wordMasks[slot] == scalarMasks[slot]);
+
+	cout << "   Conversation mask benchmark (" << nPorts << " ports, " << iterations << " iterations):" << endl
+		<< "      bit-at-a-time:  " << std::chrono::duration_cast<std::chrono::microseconds>(scalarTime).count() << " us" << endl
+		<< "      word-parallel:  " << std::chrono::duration_cast<std::chrono::microseconds>(wordTime).count() << " us" << endl
+		<< "      results " << (match ? "match" : "DO NOT MATCH") << endl;
+}
+
+static unsigned long codecRandom(unsigned long& seed)
+{
+	seed = (seed * 1103515245) + 12345;
+	return ((seed >> 8) & 0xffffff);
+}
+
+static bool sameLacpdu(const Lacpdu& a, const Lacpdu& b)
+{
+	bool same = (a.VersionNumber == b.VersionNumber) &&
+		(a.actorSystem.id == b.actorSystem.id) && (a.actorKey == b.actorKey) &&
+		(a.actorPort.id == b.actorPort.id) && (a.actorState.state == b.actorState.state) &&
+		(a.partnerSystem.id == b.partnerSystem.id) && (a.partnerKey == b.partnerKey) &&
+		(a.partnerPort.id == b.partnerPort.id) && (a.partnerState.state == b.partnerState.state) &&
+		(a.collectorMaxDelay == b.collectorMaxDelay) &&
+		(a.portAlgorithmTlv == b.portAlgorithmTlv) && (a.portConversationIdDigestTlv == b.portConversationIdDigestTlv) &&
+		(a.portConversationServiceMappingDigestTlv == b.portConversationServiceMappingDigestTlv) &&
+		(a.portConversationMaskTlvs == b.portConversationMaskTlvs);
+	if (same && a.portAlgorithmTlv)
+		same = (a.actorPortAlgorithm == b.actorPortAlgorithm);
+	if (same && a.portConversationIdDigestTlv)
+		same = (a.linkNumberID == b.linkNumberID) && (a.actorConversationLinkListDigest == b.actorConversationLinkListDigest);
+	if (same && a.portConversationServiceMappingDigestTlv)
+		same = (a.actorConversationServiceMappingDigest == b.actorConversationServiceMappingDigest);
+	if (same && a.portConversationMaskTlvs)
+		same = (a.actorPortConversationMaskState.state == b.actorPortConversationMaskState.state) &&
+			(a.actorPortConversationMask == b.actorPortConversationMask);
+	return (same);
+}
+
+/*
+*   Encodes a set of pseudo-random LACPDUs to wire format, then times encoding, parsing with a LacpduView,
+*   and decoding back to Lacpdu objects, and checks that every LACPDU encodes to the length getLength() reports
+*   and survives the round trip.  Finally mutates and truncates the encoded octets at random to check that 
+*   damaged LACPDUs are rejected or decoded without reading outside the buffer.
+*/
+void lacpduCodecBenchmark()
+{
+	const int nPdus = 1000;
+	const int iterations = 100;
+	const int nMutations = 100000;
+	unsigned long seed = 1;
+
+	std::vector<unique_ptr<Lacpdu>> pdus;
+	for (int i = 0; i < nPdus; i++)
 	{
-		pDev->reset();   // Reset all devices
+		unique_ptr<Lacpdu> pPdu = make_unique<Lacpdu>();
+		Lacpdu& pdu = *pPdu;
+		pdu.VersionNumber = 1 + (codecRandom(seed) & 1);
+		pdu.actorSystem.id = 0;
+		pdu.actorSystem.addr = ((unsigned long long)codecRandom(seed) << 24) | codecRandom(seed);
+		pdu.actorSystem.pri = (unsigned short)codecRandom(seed);
+		pdu.actorKey = (unsigned short)codecRandom(seed);
+		pdu.actorPort.id = 0;
+		pdu.actorPort.num = (unsigned short)codecRandom(seed);
+		pdu.actorPort.pri = (unsigned short)codecRandom(seed);
+		pdu.actorState.state = (unsigned char)codecRandom(seed);
+		pdu.partnerSystem.id = 0;
+		pdu.partnerSystem.addr = ((unsigned long long)codecRandom(seed) << 24) | codecRandom(seed);
+		pdu.partnerSystem.pri = (unsigned short)codecRandom(seed);
+		pdu.partnerKey = (unsigned short)codecRandom(seed);
+		pdu.partnerPort.id = 0;
+		pdu.partnerPort.num = (unsigned short)codecRandom(seed);
+		pdu.partnerPort.pri = (unsigned short)codecRandom(seed);
+		pdu.partnerState.state = (unsigned char)codecRandom(seed);
+		pdu.collectorMaxDelay = (unsigned short)codecRandom(seed);
+
+		bool v2 = (pdu.VersionNumber >= 2);
+		pdu.portAlgorithmTlv = v2;
+		pdu.actorPortAlgorithm = (Aggregator::portAlgorithms)(Aggregator::UNSPECIFIED + (codecRandom(seed) % 6));
+		pdu.portConversationIdDigestTlv = v2;
+		pdu.linkNumberID = (unsigned short)codecRandom(seed);
+		for (auto& octet : pdu.actorConversationLinkListDigest)
+			octet = (unsigned char)codecRandom(seed);
+		pdu.portConversationServiceMappingDigestTlv = v2 && (codecRandom(seed) & 1);
+		for (auto& octet : pdu.actorConversationServiceMappingDigest)
+			octet = (unsigned char)codecRandom(seed);
+		pdu.portConversationMaskTlvs = v2 && (codecRandom(seed) & 1);
+		pdu.actorPortConversationMaskState.state = (unsigned char)codecRandom(seed);
+		pdu.actorPortConversationMask.reset();
+		unsigned long density = codecRandom(seed) % 4;           // empty, sparse, half, or all ones
+		for (int cid = 0; cid < 4096; cid++)
+			if ((density == 3) || ((density > 0) && ((codecRandom(seed) % (density == 1 ? 64 : 2)) == 0)))
+				pdu.actorPortConversationMask.set(cid);
+		pdus.push_back(std::move(pPdu));
 	}
 
-	for (int i = 0; i < 1000; i++)
-	{
-		if (SimLog::Debug > 1)
-			SimLog::logFile << "*" << endl;
-
-		//  Make or break connections
-
-		if (SimLog::Time == start + 10)
-			Mac::Connect((Devices[0]->pMacs[0]), (Devices[1]->pMacs[0]), 5);   // Connect two Bridges
-		// Link 1 comes up with AggPort b00:100 on Aggregator b00:200 and AggPort b01:100 on Aggregator b01:200.
-		if (SimLog::Time == start + 100)
-			Mac::Connect((Devices[0]->pMacs[1]), (Devices[1]->pMacs[1]), 5);   // Second link between same Bridges
-		// Link 2 comes up with AggPort b00:101 on Aggregator b00:200 and AggPort b01:101 on Aggregator b01:200.
-		if (SimLog::Time == start + 200)
-			Mac::Connect((Devices[0]->pMacs[2]), (Devices[1]->pMacs[2]), 5);   // Third link between same Bridges
-		// Link 3 comes up with AggPort b00:102 on Aggregator b00:200 and AggPort b01:102 on Aggregator b01:200.
-
-		if (SimLog::Time == start + 300)
-			Mac::Disconnect((Devices[0]->pMacs[0]));                           // Take down first link
-		// Link 1 goes down and conversations immediately re-allocated to other links.
-		// AggPorts b00:102 and b00:103 remain up on Aggregator b00:200
-		if (SimLog::Time == start + 400)
-			Mac::Connect((Devices[0]->pMacs[0]), (Devices[1]->pMacs[0]), 5);   // Reconnect first link between same Bridges
-		// Link 1 comes back up with one or two (depending on coupled/uncoupled MUX) LACPDU exchanges.
-
-		if (SimLog::Time == start + 500)
-			Mac::Disconnect((Devices[0]->pMacs[1]));                           // Take down second link
-		// Link 2 goes down and conversations immediately re-allocated to other links.
-		// AggPorts b00:100 and b00:102 remain up on Aggregator b00:200
-		if (SimLog::Time == start + 600)
-			Mac::Connect((Devices[0]->pMacs[1]), (Devices[1]->pMacs[3]), 5);   // Move one end of link to a different port on second bridge
-		// Link 2 comes up with AggPort b00:101 on Aggregator b00:200 and AggPort b01:103 on Aggregator b01:200.
-		// AggPort b01:100 gets kicked off Aggregator b01:200 since the partner moved to a new port (port_moved signal in RxSM)
-
-
-		if (SimLog::Time == start + 700)
-			Mac::Connect((Devices[0]->pMacs[4]), (Devices[2]->pMacs[0]), 5);   // Connect link between first and third bridges
-		// Link 1 of new LAG comes up with AggPort b00:104 on Aggregator b00:204 and AggPort b02:100 on Aggregator b02:200.
-		if (SimLog::Time == start + 800)
-			Mac::Connect((Devices[0]->pMacs[5]), (Devices[2]->pMacs[2]), 5);   // Connect another link between first and third bridges
-		// Link 3 comes up with AggPort b00:105 on Aggregator b00:204 and AggPort b01:102 on b02:200
-		// AggPorts b00:102 and b00:103 move to Aggregator b00:201, so both ends of LAG temporarily non-operational.
-		//    With small values of aggregateWaitTime there is additional "bouncing" of aggregator operational.
-
-		if (SimLog::Time == start + 990)
-			for (auto& pDev : Devices)
-			{
-				pDev->disconnect();      // Disconnect all remaining links on all devices
-			}
-
+	std::vector<std::vector<unsigned char>> wire(nPdus, std::vector<unsigned char>(Lacpdu::maxEncodedLength));
+	std::vector<unsigned short> wireLength(nPdus);
+	unsigned long long totalOctets = 0;
+
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < iterations; i++)
+		for (int n = 0; n < nPdus; n++)
+			wireLength[n] = pdus[n]->encode(wire[n].data(), (unsigned short)wire[n].size());
+	auto encodeTime = std::chrono::steady_clock::now() - start;
+	int nLength = 0;
+	for (int n = 0; n < nPdus; n++)
+	{
+		totalOctets += wireLength[n];
+		nLength += (wireLength[n] == pdus[n]->getLength() - 2);    // getLength() includes the EtherType
+	}
 
-		//  Run all state machines in all devices
-		for (auto& pDev : Devices)
+	int nValid = 0;
+	start = std::chrono::steady_clock::now();
+	for (int i = 0; i < iterations; i++)
+		for (int n = 0; n < nPdus; n++)
 		{
-			pDev->timerTick();     // Decrement timers
-			pDev->run(true);   // Run device with single-step true
+			LacpduView view(wire[n].data(), wireLength[n]);
+			nValid += view.valid() && (view.getActorKey() == pdus[n]->actorKey);
 		}
+	auto viewTime = std::chrono::steady_clock::now() - start;
 
-		//  Transmit from any MAC with frames to transmit
-		for (auto& pDev : Devices)
+	Lacpdu decoded;
+	int nMatch = 0;
+	start = std::chrono::steady_clock::now();
+	for (int i = 0; i < iterations; i++)
+		for (int n = 0; n < nPdus; n++)
 		{
-			pDev->transmit();
+			LacpduView view(wire[n].data(), wireLength[n]);
+			if (decoded.decode(view) && (i == 0))
+				nMatch += sameLacpdu(*pdus[n], decoded);
 		}
+	auto decodeTime = std::chrono::steady_clock::now() - start;
 
-		SimLog::Time++;
+	int nRejected = 0;
+	int nDecoded = 0;
+	int nInconsistent = 0;
+	std::vector<unsigned char> scratch;
+	for (int i = 0; i < nMutations; i++)
+	{
+		int n = codecRandom(seed) % nPdus;
+		scratch.assign(wire[n].begin(), wire[n].begin() + wireLength[n]);
+		int nChanges = 1 + (codecRandom(seed) % 4);
+		for (int c = 0; c < nChanges; c++)
+			scratch[codecRandom(seed) % scratch.size()] = (unsigned char)codecRandom(seed);
+		size_t length = (codecRandom(seed) & 1) ? (codecRandom(seed) % (scratch.size() + 1)) : scratch.size();
+		std::vector<unsigned char> damaged(scratch.begin(), scratch.begin() + length);   // exact size, so overreads are detectable
+
+		LacpduView view(damaged.data(), (unsigned short)length);
+		if (decoded.decode(view))
+		{
+			bool consistent = (view.getLength() <= length);
+			for (int cid = 0; view.hasPortConversationMaskTlvs() && (cid < 4096); cid += 97)
+				consistent &= (view.getActorPortConversationMask(cid) == decoded.actorPortConversationMask[cid]);
+			if (consistent)
+				nDecoded++;
+			else
+				nInconsistent++;
+		}
+		else
+			nRejected++;
 	}
+
+	auto us = [](std::chrono::steady_clock::duration d) { return (std::chrono::duration_cast<std::chrono::microseconds>(d).count()); };
+	cout << "   LACPDU codec benchmark (" << nPdus << " LACPDUs, " << totalOctets << " octets, " << iterations << " iterations):" << endl
+		<< "      encode:  " << us(encodeTime) << " us" << endl
+		<< "      view:    " << us(viewTime) << " us" << endl
+		<< "      decode:  " << us(decodeTime) << " us" << endl
+		<< "      round trip " << (((nMatch == nPdus) && (nValid == nPdus * iterations) && (nLength == nPdus)) ? "matches" : "DOES NOT MATCH") << endl
+		<< "      " << nMutations << " damaged LACPDUs:  " << nRejected << " rejected, " << nDecoded << " decoded, " 
+			<< nInconsistent << " inconsistent" << endl;
 }
 
 /*
 */
-void preferredAggregatorTest(std::vector<unique_ptr<Device>>& Devices)
+void basicLagTest(SimulationEngine& sim)
 {
+	std::vector<unique_ptr<Device>>& Devices = sim.Devices;   // alias
 	int start = SimLog::Time;
-	LinkAgg& dev0Lag = (LinkAgg&)*(Devices[0]->pComponents[1]);  // alias to LinkAgg shim of bridge b00
 
-	cout << endl << endl << "   Preferred Aggregator Tests:  " << endl << endl;
-	if (SimLog::Debug > 0)
-		SimLog::logFile << endl << endl << "   Preferred Aggregator Tests:  " << endl << endl;
+	cout << endl << endl << "   Basic LAG Tests:  " << endl << endl;
+	if (SimLog::debug<0>())
+		SimLog::logFile << endl << endl << "   Basic LAG Tests:  " << endl << endl;
 
 	for (auto& pDev : Devices)
 	{
 		pDev->reset();   // Reset all devices
 	}
 
-	for (int i = 0; i < 1000; i++)
-	{
-		if (SimLog::Debug > 1)
-			SimLog::logFile << "*" << endl;
+	//  Make or break connections
 
-		//  Make or break connections
+	sim.connect(start + 10, Devices[0]->pMacs[0], Devices[1]->pMacs[0], 5);   // Connect two Bridges
+	// Link 1 comes up with AggPort b00:100 on Aggregator b00:200 and AggPort b01:100 on Aggregator b01:200.
+	sim.connect(start + 100, Devices[0]->pMacs[1], Devices[1]->pMacs[1], 5);   // Second link between same Bridges
+	// Link 2 comes up with AggPort b00:101 on Aggregator b00:200 and AggPort b01:101 on Aggregator b01:200.
+	sim.connect(start + 200, Devices[0]->pMacs[2], Devices[1]->pMacs[2], 5);   // Third link between same Bridges
+	// Link 3 comes up with AggPort b00:102 on Aggregator b00:200 and AggPort b01:102 on Aggregator b01:200.
 
-		if (SimLog::Time == start + 10)
-			Mac::Connect((Devices[0]->pMacs[1]), (Devices[1]->pMacs[2]), 5);   // Connect two Bridges
-		// Link 2 comes up with AggPort b00:101 on Aggregator b00:201 and AggPort b01:102 on Aggregator b01:202.
-		if (SimLog::Time == start + 100)
-			Mac::Connect((Devices[0]->pMacs[2]), (Devices[1]->pMacs[3]), 5);   // Second link between same Bridges
-		// Link 3 comes up with AggPort b00:102 on Aggregator b00:201 and AggPort b01:103 on Aggregator b01:202.
-		if (SimLog::Time == start + 200)
-			Mac::Connect((Devices[0]->pMacs[3]), (Devices[1]->pMacs[1]), 5);   // Third link between same Bridges
-		// Link 4 comes up with AggPort b00:103 on Aggregator b00:201 and AggPort b01:101 on Aggregator b01:201.
-		// AggPorts b01:102 and b01:103 have to move to Aggregator b01:201 which causes both ends of LAG to be temporarily
-		//    non-operational.  
-		//    With small values of aggregateWaitTime there is additional "bouncing" of aggregator operational.
+	sim.disconnect(start + 300, Devices[0]->pMacs[0]);                         // Take down first link
+	// Link 1 goes down and conversations immediately re-allocated to other links.
+	// AggPorts b00:102 and b00:103 remain up on Aggregator b00:200
+	sim.connect(start + 400, Devices[0]->pMacs[0], Devices[1]->pMacs[0], 5);   // Reconnect first link between same Bridges
+	// Link 1 comes back up with one or two (depending on coupled/uncoupled MUX) LACPDU exchanges.
 
-		if (SimLog::Time == start + 300)
-		{
-			Mac::Disconnect((Devices[0]->pMacs[1]));                           // Take down first link
-		}
-		// Link 3 goes down and conversations immediately re-allocated to other links.
-		// AggPorts b00:102 and b00:103 remain up on Aggregator b00:201
-		if (SimLog::Time == start + 400)
-			Mac::Connect((Devices[0]->pMacs[1]), (Devices[1]->pMacs[2]), 5);   // Reconnect first link between same Bridges
-		// Link 3 comes back up with one or two (depending on coupled/uncoupled MUX) LACPDU exchanges.
-
-		if (SimLog::Time == start + 500)
-			Mac::Disconnect((Devices[0]->pMacs[1]));                           // Take down first link
-		// Link 2 goes down and conversations immediately re-allocated to other links.
-		// AggPorts b00:102 and b00:103 remain up on Aggregator b00:201
-		if (SimLog::Time == start + 600)
-			Mac::Connect((Devices[0]->pMacs[1]), (Devices[2]->pMacs[0]), 5);   // Connect that Bridge Port to third device
-		// Link 2 comes up with AggPort b00:101 on Aggregator b00:201 and AggPort e02:100 on Aggregator e02:200.
-		// In the process AggPort b00:101 commandeers Aggregator b00:201 for a new LAG which forces AggPorts b00:102 and b00:103
-		//    to a Aggregator b00:202.  Both ends of this LAG will be temporarily non-operational while it changes Aggregators.
-		//    With small values of aggregateWaitTime there is additional "bouncing" of aggregator operational.
-
-		if (SimLog::Time == start + 700)
-			Mac::Disconnect((Devices[0]->pMacs[1]));                           // Take down link between first Bridge and third device
-		// Link 2 goes down and the corresponding Aggregators go down.
-		if (SimLog::Time == start + 800)
-			Mac::Connect((Devices[0]->pMacs[1]), (Devices[1]->pMacs[2]), 5);   // Reconnect first link between original Bridge Ports
-		// Link 2 comes up with AggPort b00:101 on Aggregator b00:201 and AggPort b01:102 on b01:201
-		// AggPorts b00:102 and b00:103 move to Aggregator b00:201, so both ends of LAG temporarily non-operational.
-		//    With small values of aggregateWaitTime there is additional "bouncing" of aggregator operational.
-
-		if (SimLog::Time == start + 990)
-			for (auto& pDev : Devices)
-			{
-				pDev->disconnect();      // Disconnect all remaining links on all devices
-			}
+	sim.disconnect(start + 500, Devices[0]->pMacs[1]);                         // Take down second link
+	// Link 2 goes down and conversations immediately re-allocated to other links.
+	// AggPorts b00:100 and b00:102 remain up on Aggregator b00:200
+	sim.connect(start + 600, Devices[0]->pMacs[1], Devices[1]->pMacs[3], 5);   // Move one end of link to a different port on second bridge
+	// Link 2 comes up with AggPort b00:101 on Aggregator b00:200 and AggPort b01:103 on Aggregator b01:200.
+	// AggPort b01:100 gets kicked off Aggregator b01:200 since the partner moved to a new port (port_moved signal in RxSM)
 
 
-		//  Run all state machines in all devices
-		for (auto& pDev : Devices)
-		{
-			pDev->timerTick();     // Decrement timers
-			pDev->run(true);   // Run device with single-step true
-		}
+	sim.connect(start + 700, Devices[0]->pMacs[4], Devices[2]->pMacs[0], 5);   // Connect link between first and third bridges
+	// Link 1 of new LAG comes up with AggPort b00:104 on Aggregator b00:204 and AggPort b02:100 on Aggregator b02:200.
+	sim.connect(start + 800, Devices[0]->pMacs[5], Devices[2]->pMacs[2], 5);   // Connect another link between first and third bridges
+	// Link 3 comes up with AggPort b00:105 on Aggregator b00:204 and AggPort b01:102 on b02:200
+	// AggPorts b00:102 and b00:103 move to Aggregator b00:201, so both ends of LAG temporarily non-operational.
+	//    With small values of aggregateWaitTime there is additional "bouncing" of aggregator operational.
 
-		//  Transmit from any MAC with frames to transmit
-		for (auto& pDev : Devices)
-		{
-			pDev->transmit();
-		}
+	sim.disconnectAll(start + 990);      // Disconnect all remaining links on all devices
 
-		SimLog::Time++;
-	}
+	sim.runUntil(start + 1000);
 }
 
-void lagLoopbackTest(std::vector<unique_ptr<Device>>& Devices)
+/*
+*/
+void preferredAggregatorTest(SimulationEngine& sim)
 {
+	std::vector<unique_ptr<Device>>& Devices = sim.Devices;   // alias
 	int start = SimLog::Time;
+	LinkAgg& dev0Lag = (LinkAgg&)*(Devices[0]->pComponents[1]);  // alias to LinkAgg shim of bridge b00
 
-	cout << endl << endl << "   LAG Loopback Tests:  " << endl << endl;
-	if (SimLog::Debug > 0)
-		SimLog::logFile << endl << endl << "   LAG Loopback Tests:  " << endl << endl;
+	cout << endl << endl << "   Preferred Aggregator Tests:  " << endl << endl;
+	if (SimLog::debug<0>())
+		SimLog::logFile << endl << endl << "   Preferred Aggregator Tests:  " << endl << endl;
 
 	for (auto& pDev : Devices)
 	{
 		pDev->reset();   // Reset all devices
 	}
 
-	for (int i = 0; i < 1000; i++)
-	{
-		if (SimLog::Debug > 1)
-			SimLog::logFile << "*" << endl;
+	//  Make or break connections
+
+	sim.connect(start + 10, Devices[0]->pMacs[1], Devices[1]->pMacs[2], 5);   // Connect two Bridges
+	// Link 2 comes up with AggPort b00:101 on Aggregator b00:201 and AggPort b01:102 on Aggregator b01:202.
+	sim.connect(start + 100, Devices[0]->pMacs[2], Devices[1]->pMacs[3], 5);   // Second link between same Bridges
+	// Link 3 comes up with AggPort b00:102 on Aggregator b00:201 and AggPort b01:103 on Aggregator b01:202.
+	sim.connect(start + 200, Devices[0]->pMacs[3], Devices[1]->pMacs[1], 5);   // Third link between same Bridges
+	// Link 4 comes up with AggPort b00:103 on Aggregator b00:201 and AggPort b01:101 on Aggregator b01:201.
+	// AggPorts b01:102 and b01:103 have to move to Aggregator b01:201 which causes both ends of LAG to be temporarily
+	//    non-operational.  
+	//    With small values of aggregateWaitTime there is additional "bouncing" of aggregator operational.
+
+	sim.disconnect(start + 300, Devices[0]->pMacs[1]);                         // Take down first link
+	// Link 3 goes down and conversations immediately re-allocated to other links.
+	// AggPorts b00:102 and b00:103 remain up on Aggregator b00:201
+	sim.connect(start + 400, Devices[0]->pMacs[1], Devices[1]->pMacs[2], 5);   // Reconnect first link between same Bridges
+	// Link 3 comes back up with one or two (depending on coupled/uncoupled MUX) LACPDU exchanges.
+
+	sim.disconnect(start + 500, Devices[0]->pMacs[1]);                         // Take down first link
+	// Link 2 goes down and conversations immediately re-allocated to other links.
+	// AggPorts b00:102 and b00:103 remain up on Aggregator b00:201
+	sim.connect(start + 600, Devices[0]->pMacs[1], Devices[2]->pMacs[0], 5);   // Connect that Bridge Port to third device
+	// Link 2 comes up with AggPort b00:101 on Aggregator b00:201 and AggPort e02:100 on Aggregator e02:200.
+	// In the process AggPort b00:101 commandeers Aggregator b00:201 for a new LAG which forces AggPorts b00:102 and b00:103
+	//    to a Aggregator b00:202.  Both ends of this LAG will be temporarily non-operational while it changes Aggregators.
+	//    With small values of aggregateWaitTime there is additional "bouncing" of aggregator operational.
+
+	sim.disconnect(start + 700, Devices[0]->pMacs[1]);                         // Take down link between first Bridge and third device
+	// Link 2 goes down and the corresponding Aggregators go down.
+	sim.connect(start + 800, Devices[0]->pMacs[1], Devices[1]->pMacs[2], 5);   // Reconnect first link between original Bridge Ports
+	// Link 2 comes up with AggPort b00:101 on Aggregator b00:201 and AggPort b01:102 on b01:201
+	// AggPorts b00:102 and b00:103 move to Aggregator b00:201, so both ends of LAG temporarily non-operational.
+	//    With small values of aggregateWaitTime there is additional "bouncing" of aggregator operational.
+
+	sim.disconnectAll(start + 990);      // Disconnect all remaining links on all devices
+
+	sim.runUntil(start + 1000);
+}
 
-		//  Make or break connections
+void lagLoopbackTest(SimulationEngine& sim)
+{
+	std::vector<unique_ptr<Device>>& Devices = sim.Devices;   // alias
+	int start = SimLog::Time;
 
-		if (SimLog::Time == start + 10)
-			Mac::Connect((Devices[0]->pMacs[0]), (Devices[0]->pMacs[0]), 5);   // Port 0:  same-port-loopback
-		// Link 1 comes up with AggPort b00:100 on Aggregator b00:200.
+	cout << endl << endl << "   LAG Loopback Tests:  " << endl << endl;
+	if (SimLog::debug<0>())
+		SimLog::logFile << endl << endl << "   LAG Loopback Tests:  " << endl << endl;
 
-		if (SimLog::Time == start + 100)
-			Mac::Connect((Devices[0]->pMacs[1]), (Devices[0]->pMacs[3]), 5);   // Port 1 to 3: diff-port-loopback
-		// Link 2 comes up with AggPort b00:101 on Aggregator b00:201 and AggPort b00:103 on Aggregator b00:203.
+	for (auto& pDev : Devices)
+	{
+		pDev->reset();   // Reset all devices
+	}
 
-		if (SimLog::Time == start + 200)
-			Mac::Connect((Devices[0]->pMacs[5]), (Devices[0]->pMacs[5]), 5);   // Port 5:  same-port-loopback
-		// Link 6 comes up with AggPort b00:105 and joins LAG with link 1 on Aggregator b00:200.
+	//  Make or break connections
 
-		if (SimLog::Time == start + 300)
-			Mac::Connect((Devices[0]->pMacs[2]), (Devices[0]->pMacs[4]), 5);   // Port 2 to 4: diff-port-loopback
-		// Link 3 comes up with AggPort b00:102 on Aggregator b00:201 and AggPort b00:104 on Aggregator b00:203
-		//    and joins LAG with link 2.
+	sim.connect(start + 10, Devices[0]->pMacs[0], Devices[0]->pMacs[0], 5);   // Port 0:  same-port-loopback
+	// Link 1 comes up with AggPort b00:100 on Aggregator b00:200.
 
-		if (SimLog::Time == start + 400)
-			Mac::Disconnect((Devices[0]->pMacs[0]));                           // Take down same-port loopback on port 0
-		// Link 1 goes down and leaves link 6 on Aggregator b00:200.
+	sim.connect(start + 100, Devices[0]->pMacs[1], Devices[0]->pMacs[3], 5);   // Port 1 to 3: diff-port-loopback
+	// Link 2 comes up with AggPort b00:101 on Aggregator b00:201 and AggPort b00:103 on Aggregator b00:203.
 
-		if (SimLog::Time == start + 500)
-			Mac::Disconnect((Devices[0]->pMacs[5]));                           // Take down same-port loopback on port 5
-		// Link 6 goes down and Aggregator b00:200 goes down.
+	sim.connect(start + 200, Devices[0]->pMacs[5], Devices[0]->pMacs[5], 5);   // Port 5:  same-port-loopback
+	// Link 6 comes up with AggPort b00:105 and joins LAG with link 1 on Aggregator b00:200.
 
-		if (SimLog::Time == start + 600)
-			Mac::Connect((Devices[0]->pMacs[0]), (Devices[0]->pMacs[5]), 5);   // Port 0 to 5: diff-port-loopback
-		// Ultimately ends up with links 1, 2, and 3 forming a LAG with 
-		//    AggPorts b00:100, b00:101, and b00:102 on Aggregator b00:200, and
-		//    AggPorts b00:103, b00:104, and b00:105 on Aggregator b00:201. 
-		//    With small values of aggregateWaitTime the links bounce around to get there as each 
-		//        AggPort tries to get to its preferred Aggregator.  
-		//    The fact that it doesn't end up using Aggregator b00:203 instead of b00:201 actually depends on the  
-		//        order in which the links come up.  
-		//        This is technically a bug since it violates the determinism of the "preferred" Aggregator concept.
-		//        Since it is an anomaly of the loopback special cases it doesn't seem worth trying to fix.
+	sim.connect(start + 300, Devices[0]->pMacs[2], Devices[0]->pMacs[4], 5);   // Port 2 to 4: diff-port-loopback
+	// Link 3 comes up with AggPort b00:102 on Aggregator b00:201 and AggPort b00:104 on Aggregator b00:203
+	//    and joins LAG with link 2.
 
-		if (SimLog::Time == start + 700)
-			Mac::Disconnect((Devices[0]->pMacs[0]));                           // Take down diff-port loopback between ports 0 and 5
-		// Link 1 goes down and and leaves links 1 and 2 on the LAG with Aggregators b00:200 and b00:201.
+	sim.disconnect(start + 400, Devices[0]->pMacs[0]);                         // Take down same-port loopback on port 0
+	// Link 1 goes down and leaves link 6 on Aggregator b00:200.
 
-		if (SimLog::Time == start + 800)
-			Mac::Connect((Devices[0]->pMacs[0]), (Devices[0]->pMacs[0]), 5);   // Port 0:  same-port-loopback
-		// Link 1 comes up with AggPort b00:100 on Aggregator b00:200.
-		// AggPorts b00:101 and b00:102 are forced off Aggregator b00:200, so
-		//    (after some bouncing around if aggregateWaitTime is small)
-		//    the LAG with links 2 and 3 ends up with 
-		//    AggPorts b00:101 and b00:102 on Aggregator b00:201, and
-		//    AggPorts b00:103 and b00:104 on Aggregator b00:203. 
+	sim.disconnect(start + 500, Devices[0]->pMacs[5]);                         // Take down same-port loopback on port 5
+	// Link 6 goes down and Aggregator b00:200 goes down.
 
+	sim.connect(start + 600, Devices[0]->pMacs[0], Devices[0]->pMacs[5], 5);   // Port 0 to 5: diff-port-loopback
+	// Ultimately ends up with links 1, 2, and 3 forming a LAG with 
+	//    AggPorts b00:100, b00:101, and b00:102 on Aggregator b00:200, and
+	//    AggPorts b00:103, b00:104, and b00:105 on Aggregator b00:201. 
+	//    With small values of aggregateWaitTime the links bounce around to get there as each 
+	//        AggPort tries to get to its preferred Aggregator.  
+	//    The fact that it doesn't end up using Aggregator b00:203 instead of b00:201 actually depends on the  
+	//        order in which the links come up.  
+	//        This is technically a bug since it violates the determinism of the "preferred" Aggregator concept.
+	//        Since it is an anomaly of the loopback special cases it doesn't seem worth trying to fix.
 
+	sim.disconnect(start + 700, Devices[0]->pMacs[0]);                         // Take down diff-port loopback between ports 0 and 5
+	// Link 1 goes down and and leaves links 1 and 2 on the LAG with Aggregators b00:200 and b00:201.
 
-		if (SimLog::Time == start + 990)
-			for (auto& pDev : Devices)
-			{
-				pDev->disconnect();      // Disconnect all remaining links on all devices
-			}
+	sim.connect(start + 800, Devices[0]->pMacs[0], Devices[0]->pMacs[0], 5);   // Port 0:  same-port-loopback
+	// Link 1 comes up with AggPort b00:100 on Aggregator b00:200.
+	// AggPorts b00:101 and b00:102 are forced off Aggregator b00:200, so
+	//    (after some bouncing around if aggregateWaitTime is small)
+	//    the LAG with links 2 and 3 ends up with 
+	//    AggPorts b00:101 and b00:102 on Aggregator b00:201, and
+	//    AggPorts b00:103 and b00:104 on Aggregator b00:203. 
 
 
-		//  Run all state machines in all devices
-		for (auto& pDev : Devices)
-		{
-			pDev->timerTick();     // Decrement timers
-			pDev->run(true);   // Run device with single-step true
-		}
 
-		//  Transmit from any MAC with frames to transmit
-		for (auto& pDev : Devices)
-		{
-			pDev->transmit();
-		}
+	sim.disconnectAll(start + 990);      // Disconnect all remaining links on all devices
 
-		SimLog::Time++;
-	}
+	sim.runUntil(start + 1000);
 }
 
-void nonAggregatablePortTest(std::vector<unique_ptr<Device>>& Devices)
+void nonAggregatablePortTest(SimulationEngine& sim)
 {
+	std::vector<unique_ptr<Device>>& Devices = sim.Devices;   // alias
 	int start = SimLog::Time;
 	// aliases
 	LinkAgg& dev0Lag = (LinkAgg&)*(Devices[0]->pComponents[1]);
 	LinkAgg& dev1Lag = (LinkAgg&)*(Devices[1]->pComponents[1]);
 
 	cout << endl << endl << "   non-Aggregatable (Individual) Port Tests:  " << endl << endl;
-	if (SimLog::Debug > 0)
+	if (SimLog::debug<0>())
 		SimLog::logFile << endl << endl << "   non-Aggregatable (Individual) Port Tests:  " << endl << endl;
 
 	for (auto& pDev : Devices)
@@ -469,96 +650,75 @@ void nonAggregatablePortTest(std::vector<unique_ptr<Device>>& Devices)
 		pDev->reset();   // Reset all devices
 	}
 
-	for (int i = 0; i < 1000; i++)
-	{
-
-		if (SimLog::Time == start + 1)   // Clear "aggregation" bit of AggPort adminState variable
-		{                        //    in AggPorts 1 and 4 of the first two Bridges
-			dev0Lag.pAggPorts[1]->set_aAggPortActorAdminState
-				(dev0Lag.pAggPorts[1]->get_aAggPortActorAdminState() & 0xfb);
-			dev1Lag.pAggPorts[1]->set_aAggPortActorAdminState
-				(dev1Lag.pAggPorts[1]->get_aAggPortActorAdminState() & 0xfb);
-			dev0Lag.pAggPorts[4]->set_aAggPortActorAdminState
-				(dev0Lag.pAggPorts[4]->get_aAggPortActorAdminState() & 0xfb);
-			dev1Lag.pAggPorts[4]->set_aAggPortActorAdminState
-				(dev1Lag.pAggPorts[4]->get_aAggPortActorAdminState() & 0xfb);
-		}
-
-		//  Make or break connections
-
-		if (SimLog::Time == start + 100)   // Connect three links between two Bridges
-		{
-			Mac::Connect((Devices[0]->pMacs[1]), (Devices[1]->pMacs[2]), 5);    // {0,1} is individual 
-			Mac::Connect((Devices[0]->pMacs[2]), (Devices[1]->pMacs[3]), 5);
-			Mac::Connect((Devices[0]->pMacs[3]), (Devices[1]->pMacs[1]), 5);    // {1,1} is individual
-		}
-		// Each link (2,3,4) comes up as a separate LAG because of the setting of the "aggregation" control bits.
-
-		if (SimLog::Time == start + 200)   // Add a fourth link between the Bridges
-			Mac::Connect((Devices[0]->pMacs[4]), (Devices[1]->pMacs[0]), 5);    // {0,4} is individual 
-		// Link 5 comes up as yet another separate LAG.
-
-		if (SimLog::Time == start + 300)   // Add a fifth link between the Bridges
-			Mac::Connect((Devices[0]->pMacs[5]), (Devices[1]->pMacs[5]), 5);
-		// Link 6 joins the LAG with Link 3 (the only other aggregatable link currently active).
+	sim.at(start + 1, [&]()   // Clear "aggregation" bit of AggPort adminState variable
+	{                        //    in AggPorts 1 and 4 of the first two Bridges
+		dev0Lag.pAggPorts[1]->set_aAggPortActorAdminState
+			(dev0Lag.pAggPorts[1]->get_aAggPortActorAdminState() & 0xfb);
+		dev1Lag.pAggPorts[1]->set_aAggPortActorAdminState
+			(dev1Lag.pAggPorts[1]->get_aAggPortActorAdminState() & 0xfb);
+		dev0Lag.pAggPorts[4]->set_aAggPortActorAdminState
+			(dev0Lag.pAggPorts[4]->get_aAggPortActorAdminState() & 0xfb);
+		dev1Lag.pAggPorts[4]->set_aAggPortActorAdminState
+			(dev1Lag.pAggPorts[4]->get_aAggPortActorAdminState() & 0xfb);
+	});
+
+	//  Make or break connections
+
+	// Connect three links between two Bridges
+	sim.connect(start + 100, Devices[0]->pMacs[1], Devices[1]->pMacs[2], 5);    // {0,1} is individual
+	sim.connect(start + 100, Devices[0]->pMacs[2], Devices[1]->pMacs[3], 5);
+	sim.connect(start + 100, Devices[0]->pMacs[3], Devices[1]->pMacs[1], 5);    // {1,1} is individual
+	// Each link (2,3,4) comes up as a separate LAG because of the setting of the "aggregation" control bits.
+
+	// Add a fourth link between the Bridges
+	sim.connect(start + 200, Devices[0]->pMacs[4], Devices[1]->pMacs[0], 5);    // {0,4} is individual 
+	// Link 5 comes up as yet another separate LAG.
+
+	// Add a fifth link between the Bridges
+	sim.connect(start + 300, Devices[0]->pMacs[5], Devices[1]->pMacs[5], 5);
+	// Link 6 joins the LAG with Link 3 (the only other aggregatable link currently active).
+
+	// Add a sixth link between the Bridges
+	sim.connect(start + 400, Devices[0]->pMacs[0], Devices[1]->pMacs[4], 5);    // {1,4} is individual 
+	// Link 1 comes up as yet another separate LAG.
+
+	sim.at(start + 500, [&]()   // Set "aggregation" bit of AggPort adminState variable
+	{                        //    in AggPort 1 of the first Bridge
+		dev0Lag.pAggPorts[1]->set_aAggPortActorAdminState
+			(dev0Lag.pAggPorts[1]->get_aAggPortActorAdminState() | 0x04);
+	});
+	// Link 2 initially goes down because changing "aggregation" bit equivalent to changing LAGID.
+	// Link 2 comes back up to joint the LAG with Links 3 and 6, but in the process the LAG moves
+	//    to the "preferred" Aggregator (b00:201) of AggPort b00:101.
+
+
+	sim.at(start + 990, [&]()
+	{                                   // Restore "aggregation" bit of all AggPort adminState variables
+		dev0Lag.pAggPorts[4]->set_aAggPortActorAdminState
+			(dev0Lag.pAggPorts[4]->get_aAggPortActorAdminState() | 0x04);
+		dev1Lag.pAggPorts[1]->set_aAggPortActorAdminState
+			(dev1Lag.pAggPorts[1]->get_aAggPortActorAdminState() | 0x04);
+		dev1Lag.pAggPorts[4]->set_aAggPortActorAdminState
+			(dev1Lag.pAggPorts[4]->get_aAggPortActorAdminState() | 0x04);
 
-		if (SimLog::Time == start + 400)   // Add a sixth link between the Bridges
-			Mac::Connect((Devices[0]->pMacs[0]), (Devices[1]->pMacs[4]), 5);    // {1,4} is individual 
-		// Link 1 comes up as yet another separate LAG.
-
-		if (SimLog::Time == start + 500)   // Set "aggregation" bit of AggPort adminState variable
-		{                        //    in AggPort 1 of the first Bridge
-			dev0Lag.pAggPorts[1]->set_aAggPortActorAdminState
-				(dev0Lag.pAggPorts[1]->get_aAggPortActorAdminState() | 0x04);
-		}
-		// Link 2 initially goes down because changing "aggregation" bit equivalent to changing LAGID.
-		// Link 2 comes back up to joint the LAG with Links 3 and 6, but in the process the LAG moves
-		//    to the "preferred" Aggregator (b00:201) of AggPort b00:101.
-
-
-		if (SimLog::Time == start + 990)
-		{                                   // Restore "aggregation" bit of all AggPort adminState variables
-			dev0Lag.pAggPorts[4]->set_aAggPortActorAdminState
-				(dev0Lag.pAggPorts[4]->get_aAggPortActorAdminState() | 0x04);
-			dev1Lag.pAggPorts[1]->set_aAggPortActorAdminState
-				(dev1Lag.pAggPorts[1]->get_aAggPortActorAdminState() | 0x04);
-			dev1Lag.pAggPorts[4]->set_aAggPortActorAdminState
-				(dev1Lag.pAggPorts[4]->get_aAggPortActorAdminState() | 0x04);
-
-			for (auto& pDev : Devices)
-			{
-				pDev->disconnect();      // Disconnect all remaining links on all devices
-			}
-		}
-
-
-		//  Run all state machines in all devices
 		for (auto& pDev : Devices)
 		{
-			pDev->timerTick();     // Decrement timers
-			pDev->run(true);   // Run device with single-step true
+			pDev->disconnect();      // Disconnect all remaining links on all devices
 		}
+	});
 
-		//  Transmit from any MAC with frames to transmit
-		for (auto& pDev : Devices)
-		{
-			pDev->transmit();
-		}
-
-		if (SimLog::Debug > 1)
-			SimLog::logFile << "*" << endl;
-		SimLog::Time++;
-	}
+	sim.runUntil(start + 1000);
 }
 
-void limitedAggregatorsTest(std::vector<unique_ptr<Device>>& Devices)
+void limitedAggregatorsTest(SimulationEngine& sim)
 {
+	std::vector<unique_ptr<Device>>& Devices = sim.Devices;   // alias
 	int start = SimLog::Time;
 	// aliases
 	LinkAgg& dev0Lag = (LinkAgg&)*(Devices[0]->pComponents[1]);
 
 	cout << endl << endl << "   Limited Aggregator (fewer Aggregators than AggPorts) Tests:  " << endl << endl;
-	if (SimLog::Debug > 0)
+	if (SimLog::debug<0>())
 		SimLog::logFile << endl << endl << "   Limited Aggregator (fewer Aggregators than AggPorts) Tests:  " << endl << endl;
 
 	for (auto& pDev : Devices)
@@ -566,115 +726,94 @@ void limitedAggregatorsTest(std::vector<unique_ptr<Device>>& Devices)
 		pDev->reset();   // Reset all devices
 	}
 
-	for (int i = 0; i < 1000; i++)
-	{
-
-
-		if (SimLog::Time == start + 1)   // Change key for 3 AggPorts (1, 3, 5) but just two Aggregators (1, 4).
-		{           //    Note Aggregator 4 is not the "preferred" Aggregator for any of the AggPorts.
-			dev0Lag.pAggPorts[1]->set_aAggPortActorAdminKey(0x999);
-			dev0Lag.pAggPorts[3]->set_aAggPortActorAdminKey(0x999);
-			dev0Lag.pAggPorts[5]->set_aAggPortActorAdminKey(0x999);
-			dev0Lag.pAggregators[1]->set_aAggActorAdminKey(0x999);
-			dev0Lag.pAggregators[4]->set_aAggActorAdminKey(0x999);
-		}
-
-		//  Make or break connections
-
-		if (SimLog::Time == start + 10)   // Create the first link between two Bridges
-			Mac::Connect((Devices[0]->pMacs[0]), (Devices[1]->pMacs[0]), 5);
-		// Link 1 comes up with AggPort b00:100 on Aggregator b00:200 and AggPort b01:100 on Aggregator b01:200.
-
-		if (SimLog::Time == start + 100)   // Create another link between the Bridges
-			Mac::Connect((Devices[0]->pMacs[1]), (Devices[1]->pMacs[1]), 5);
-		// Link 2 comes up with AggPort b00:101 on Aggregator b00:201 and AggPort b01:101 on Aggregator b01:201.
-		// Link 2 does not form a LAG with Link 1 because the AggPorts (and therefore selected Aggregators)
-		//     have different keys.
-
-		if (SimLog::Time == start + 200)   // Create another link between the Bridges
-			Mac::Connect((Devices[0]->pMacs[3]), (Devices[1]->pMacs[3]), 5);
-		// Link 4 comes up with AggPort b00:103 on Aggregator b00:201 and AggPort b01:103 on Aggregator b01:201.
-		// Link 4 joins the LAG with Link 2.
-
-		if (SimLog::Time == start + 300)   // Create another link between the Bridges
-			Mac::Connect((Devices[0]->pMacs[5]), (Devices[1]->pMacs[5]), 5);
-		// Link 6 comes up with AggPort b00:105 on Aggregator b00:201 and AggPort b01:105 on Aggregator b01:201.
-		// Link 6 joins the LAG with Links 2 and 4.
-
-		if (SimLog::Time == start + 400)
-			Mac::Disconnect((Devices[0]->pMacs[3]));
-		// Link 4 leaves the LAG so just Links 2 and 6 remain.
-
-		if (SimLog::Time == start + 500)
-			Mac::Disconnect((Devices[0]->pMacs[5]));
-		// Link 6 leaves the LAG so just Link 2 remains.
-
-		if (SimLog::Time == start + 600)   // Create a first link to a new Bridge
-			Mac::Connect((Devices[0]->pMacs[3]), (Devices[2]->pMacs[3]), 5);
-		// Link 4 comes up with AggPort b00:103 on Aggregator b00:204 and AggPort b02:103 on Aggregator b02:203.
-		// Note that AggPort b00:103 has a different key than its "preferred" Aggregator and therefore forms LAG
-		//    using Aggregator b00:204.
-
-		if (SimLog::Time == start + 700)   // Create another link to the new Bridge
-			Mac::Connect((Devices[0]->pMacs[5]), (Devices[2]->pMacs[5]), 5);
-		// Link 6 comes up with AggPort b00:105 on Aggregator b00:204 and AggPort b02:105 on Aggregator b02:203.
-		// Link 6 joins the LAG with Link 4.
-
-		if (SimLog::Time == start + 800)   // Create another link to the new Bridge
-			Mac::Connect((Devices[0]->pMacs[4]), (Devices[2]->pMacs[4]), 5);
-		// Link 5 comes up with AggPort b00:104 on Aggregator b00:202 and AggPort b02:104 on Aggregator b02:204.
-		//    Forms a new LAG because AggPort b00:104 has a different key.  Its key also differs from its "preferred"
-		//    Aggregator so it takes over a currently unused Aggregator (in this case b00:202).
-
-		if (SimLog::Time == start + 900)   // Create another link to the new Bridge
-			Mac::Connect((Devices[0]->pMacs[2]), (Devices[2]->pMacs[2]), 5);
-		// Link 3 comes up with AggPort b00:102 on Aggregator b00:202 and AggPort b02:102 on Aggregator b02:202.
-		// Link 5 goes down on Aggregator b00:204 and joins LAG with Link 3 on Aggregator b00:202 (the "preferred"
-		//    Aggregator of the lowest AggPort in the LAG).
-
-
-		if (SimLog::Time == start + 990)
-		{                                   // Restore key values
-			dev0Lag.pAggPorts[1]->set_aAggPortActorAdminKey(defaultActorKey);
-			dev0Lag.pAggPorts[3]->set_aAggPortActorAdminKey(defaultActorKey);
-			dev0Lag.pAggPorts[5]->set_aAggPortActorAdminKey(defaultActorKey);
-			dev0Lag.pAggregators[1]->set_aAggActorAdminKey(defaultActorKey);
-			dev0Lag.pAggregators[4]->set_aAggActorAdminKey(defaultActorKey);
-
-			for (auto& pDev : Devices)
-			{
-				pDev->disconnect();      // Disconnect all remaining links on all devices
-			}
-		}
+	sim.at(start + 1, [&]()   // Change key for 3 AggPorts (1, 3, 5) but just two Aggregators (1, 4).
+	{           //    Note Aggregator 4 is not the "preferred" Aggregator for any of the AggPorts.
+		dev0Lag.pAggPorts[1]->set_aAggPortActorAdminKey(0x999);
+		dev0Lag.pAggPorts[3]->set_aAggPortActorAdminKey(0x999);
+		dev0Lag.pAggPorts[5]->set_aAggPortActorAdminKey(0x999);
+		dev0Lag.pAggregators[1]->set_aAggActorAdminKey(0x999);
+		dev0Lag.pAggregators[4]->set_aAggActorAdminKey(0x999);
+	});
+
+	//  Make or break connections
+
+	// Create the first link between two Bridges
+	sim.connect(start + 10, Devices[0]->pMacs[0], Devices[1]->pMacs[0], 5);
+	// Link 1 comes up with AggPort b00:100 on Aggregator b00:200 and AggPort b01:100 on Aggregator b01:200.
+
+	// Create another link between the Bridges
+	sim.connect(start + 100, Devices[0]->pMacs[1], Devices[1]->pMacs[1], 5);
+	// Link 2 comes up with AggPort b00:101 on Aggregator b00:201 and AggPort b01:101 on Aggregator b01:201.
+	// Link 2 does not form a LAG with Link 1 because the AggPorts (and therefore selected Aggregators)
+	//     have different keys.
+
+	// Create another link between the Bridges
+	sim.connect(start + 200, Devices[0]->pMacs[3], Devices[1]->pMacs[3], 5);
+	// Link 4 comes up with AggPort b00:103 on Aggregator b00:201 and AggPort b01:103 on Aggregator b01:201.
+	// Link 4 joins the LAG with Link 2.
+
+	// Create another link between the Bridges
+	sim.connect(start + 300, Devices[0]->pMacs[5], Devices[1]->pMacs[5], 5);
+	// Link 6 comes up with AggPort b00:105 on Aggregator b00:201 and AggPort b01:105 on Aggregator b01:201.
+	// Link 6 joins the LAG with Links 2 and 4.
+
+	sim.disconnect(start + 400, Devices[0]->pMacs[3]);
+	// Link 4 leaves the LAG so just Links 2 and 6 remain.
+
+	sim.disconnect(start + 500, Devices[0]->pMacs[5]);
+	// Link 6 leaves the LAG so just Link 2 remains.
+
+	// Create a first link to a new Bridge
+	sim.connect(start + 600, Devices[0]->pMacs[3], Devices[2]->pMacs[3], 5);
+	// Link 4 comes up with AggPort b00:103 on Aggregator b00:204 and AggPort b02:103 on Aggregator b02:203.
+	// Note that AggPort b00:103 has a different key than its "preferred" Aggregator and therefore forms LAG
+	//    using Aggregator b00:204.
+
+	// Create another link to the new Bridge
+	sim.connect(start + 700, Devices[0]->pMacs[5], Devices[2]->pMacs[5], 5);
+	// Link 6 comes up with AggPort b00:105 on Aggregator b00:204 and AggPort b02:105 on Aggregator b02:203.
+	// Link 6 joins the LAG with Link 4.
+
+	// Create another link to the new Bridge
+	sim.connect(start + 800, Devices[0]->pMacs[4], Devices[2]->pMacs[4], 5);
+	// Link 5 comes up with AggPort b00:104 on Aggregator b00:202 and AggPort b02:104 on Aggregator b02:204.
+	//    Forms a new LAG because AggPort b00:104 has a different key.  Its key also differs from its "preferred"
+	//    Aggregator so it takes over a currently unused Aggregator (in this case b00:202).
+
+	// Create another link to the new Bridge
+	sim.connect(start + 900, Devices[0]->pMacs[2], Devices[2]->pMacs[2], 5);
+	// Link 3 comes up with AggPort b00:102 on Aggregator b00:202 and AggPort b02:102 on Aggregator b02:202.
+	// Link 5 goes down on Aggregator b00:204 and joins LAG with Link 3 on Aggregator b00:202 (the "preferred"
+	//    Aggregator of the lowest AggPort in the LAG).
+
+
+	sim.at(start + 990, [&]()
+	{                                   // Restore key values
+		dev0Lag.pAggPorts[1]->set_aAggPortActorAdminKey(defaultActorKey);
+		dev0Lag.pAggPorts[3]->set_aAggPortActorAdminKey(defaultActorKey);
+		dev0Lag.pAggPorts[5]->set_aAggPortActorAdminKey(defaultActorKey);
+		dev0Lag.pAggregators[1]->set_aAggActorAdminKey(defaultActorKey);
+		dev0Lag.pAggregators[4]->set_aAggActorAdminKey(defaultActorKey);
 
-		//  Run all state machines in all devices
 		for (auto& pDev : Devices)
 		{
-			pDev->timerTick();     // Decrement timers
-			pDev->run(true);   // Run device with single-step true
+			pDev->disconnect();      // Disconnect all remaining links on all devices
 		}
+	});
 
-		//  Transmit from any MAC with frames to transmit
-		for (auto& pDev : Devices)
-		{
-			pDev->transmit();
-		}
-
-		if (SimLog::Debug > 1)
-			SimLog::logFile << "*" << endl;
-		SimLog::Time++;
-	}
+	sim.runUntil(start + 1000);
 }
 
 /**/
-void dualHomingTest(std::vector<unique_ptr<Device>>& Devices)
+void dualHomingTest(SimulationEngine& sim)
 {
+	std::vector<unique_ptr<Device>>& Devices = sim.Devices;   // alias
 	int start = SimLog::Time;
 	// aliases
 	LinkAgg& dev0Lag = (LinkAgg&)*(Devices[0]->pComponents[1]);
 
 	cout << endl << endl << "   Dual-Homing Tests:  " << endl << endl;
-	if (SimLog::Debug > 0)
+	if (SimLog::debug<0>())
 		SimLog::logFile << endl << endl << "   Dual-Homing Tests:  " << endl << endl;
 
 	for (auto& pDev : Devices)
@@ -682,96 +821,71 @@ void dualHomingTest(std::vector<unique_ptr<Device>>& Devices)
 		pDev->reset();   // Reset all devices
 	}
 
-	for (int i = 0; i < 1000; i++)
-	{
-
-		//  Make or break connections
+	//  Make or break connections
 
-		if (SimLog::Time == start + 10)
-		{   // Create two links between Bridges 0 and 1, and one link between Bridges 0 and 2.
-			Mac::Connect((Devices[0]->pMacs[0]), (Devices[1]->pMacs[0]), 5);
-			Mac::Connect((Devices[0]->pMacs[2]), (Devices[2]->pMacs[2]), 5);
-			Mac::Connect((Devices[0]->pMacs[3]), (Devices[1]->pMacs[3]), 5);
-		}
-		// Links 1 and 4 come up in a LAG on Aggregators b00:200 and b01:200.
-		// Link 3 comes up in a LAG on Aggregators b00:202 and b02:202.
+	// Create two links between Bridges 0 and 1, and one link between Bridges 0 and 2.
+	sim.connect(start + 10, Devices[0]->pMacs[0], Devices[1]->pMacs[0], 5);
+	sim.connect(start + 10, Devices[0]->pMacs[2], Devices[2]->pMacs[2], 5);
+	sim.connect(start + 10, Devices[0]->pMacs[3], Devices[1]->pMacs[3], 5);
+	// Links 1 and 4 come up in a LAG on Aggregators b00:200 and b01:200.
+	// Link 3 comes up in a LAG on Aggregators b00:202 and b02:202.
 
-		if (SimLog::Time == start + 100)
-		{   // Set key of all Aggregators in Bridge 0 except the first Aggregator to a value
-			//    not share with any of the AggPorts.  Therefore Bridge 0 can only form a single LAG.
-			for (auto pAgg : dev0Lag.pAggregators)
-			{
-				pAgg->set_aAggActorAdminKey(unusedAggregatorKey);
-			}
-			dev0Lag.pAggregators[0]->set_aAggActorAdminKey(defaultActorKey);
+	sim.at(start + 100, [&]()
+	{   // Set key of all Aggregators in Bridge 0 except the first Aggregator to a value
+		//    not share with any of the AggPorts.  Therefore Bridge 0 can only form a single LAG.
+		for (auto pAgg : dev0Lag.pAggregators)
+		{
+			pAgg->set_aAggActorAdminKey(unusedAggregatorKey);
 		}
-		// Link 3 goes down because it has no available Aggregators in Bridge 0.
+		dev0Lag.pAggregators[0]->set_aAggActorAdminKey(defaultActorKey);
+	});
+	// Link 3 goes down because it has no available Aggregators in Bridge 0.
 
-		if (SimLog::Time == start + 200)
-			Mac::Disconnect((Devices[0]->pMacs[0]));
-		// Link 1 goes down leaving just Link 4 in LAG with Bridge 1.
+	sim.disconnect(start + 200, Devices[0]->pMacs[0]);
+	// Link 1 goes down leaving just Link 4 in LAG with Bridge 1.
 
-		if (SimLog::Time == start + 300)
-			Mac::Disconnect((Devices[0]->pMacs[3]));
-		// Link 4 goes down allowing Link 3 to take over the Aggregator and come up with Bridge 2.
+	sim.disconnect(start + 300, Devices[0]->pMacs[3]);
+	// Link 4 goes down allowing Link 3 to take over the Aggregator and come up with Bridge 2.
 
-		if (SimLog::Time == start + 400)
-			Mac::Connect((Devices[0]->pMacs[1]), (Devices[2]->pMacs[1]), 5);
-		// Link 2 joins Link 3 in LAG with Bridge 2.
-		//    In the process the LAG moves to Aggregator b02:201 in Bridge 2.
+	sim.connect(start + 400, Devices[0]->pMacs[1], Devices[2]->pMacs[1], 5);
+	// Link 2 joins Link 3 in LAG with Bridge 2.
+	//    In the process the LAG moves to Aggregator b02:201 in Bridge 2.
 
-		if (SimLog::Time == start + 500)
-			Mac::Connect((Devices[0]->pMacs[3]), (Devices[1]->pMacs[3]), 5);
-		// Reconnecting Link 4.  Nothing happens because AggPort b00:103 has no higher priority
-		//    to Aggregator b00:200 than Links 2 and 3.
+	sim.connect(start + 500, Devices[0]->pMacs[3], Devices[1]->pMacs[3], 5);
+	// Reconnecting Link 4.  Nothing happens because AggPort b00:103 has no higher priority
+	//    to Aggregator b00:200 than Links 2 and 3.
 
-		if (SimLog::Time == start + 500)
-			Mac::Connect((Devices[0]->pMacs[0]), (Devices[1]->pMacs[0]), 5);
-		// Reconnecting Link 1.  Now the LAG to Bridge 2 (Links 2 and 3) go down and the LAG to
-		//    Bridge 1 (Links 1 and 4) take over because Aggregator b00:200 is the "preferred" 
-		//    Aggregator for AggPort b00:100.
+	sim.connect(start + 500, Devices[0]->pMacs[0], Devices[1]->pMacs[0], 5);
+	// Reconnecting Link 1.  Now the LAG to Bridge 2 (Links 2 and 3) go down and the LAG to
+	//    Bridge 1 (Links 1 and 4) take over because Aggregator b00:200 is the "preferred" 
+	//    Aggregator for AggPort b00:100.
 
 
-		if (SimLog::Time == start + 990)
-		{   // Restore key for all Aggregators in Bridge 0 to their default value
-			for (auto pAgg : dev0Lag.pAggregators)
-			{
-				pAgg->set_aAggActorAdminKey(defaultActorKey);
-			}
-
-			for (auto& pDev : Devices)
-			{
-				pDev->disconnect();      // Disconnect all remaining links on all devices
-			}
-		}
-
-		//  Run all state machines in all devices
-		for (auto& pDev : Devices)
+	sim.at(start + 990, [&]()
+	{   // Restore key for all Aggregators in Bridge 0 to their default value
+		for (auto pAgg : dev0Lag.pAggregators)
 		{
-			pDev->timerTick();     // Decrement timers
-			pDev->run(true);       // Run device with single-step true
+			pAgg->set_aAggActorAdminKey(defaultActorKey);
 		}
 
-		//  Transmit from any MAC with frames to transmit
 		for (auto& pDev : Devices)
 		{
-			pDev->transmit();
+			pDev->disconnect();      // Disconnect all remaining links on all devices
 		}
+	});
 
-		if (SimLog::Debug > 1)
-			SimLog::logFile << "*" << endl;
-		SimLog::Time++;
-	}
+	sim.runUntil(start + 1000);
 }
 
 /**/
-void axbkHierarchicalLagTest(std::vector<unique_ptr<Device>>& Devices)
+void axbkHierarchicalLagTest(SimulationEngine& sim)
 {
 	/**/
+	std::vector<unique_ptr<Device>>& Devices = sim.Devices;   // alias
 	int start = SimLog::Time;
 
 	cout << endl << endl << "   802.1AXbk Hierarchical LAG Tests:  " << endl << endl;
-	if (SimLog::Debug > 0)
+	if (SimLog::debug<0>())
 		SimLog::logFile << endl << endl << "   802.1AXbk Hierarchical LAG Tests:  " << endl << endl;
 
 	// This test uses two Bridges (Devices 0 and 1) and two End Stations (Devices 3 and 4).
@@ -817,72 +931,48 @@ void axbkHierarchicalLagTest(std::vector<unique_ptr<Device>>& Devices)
 		pDev->reset();   // Reset all devices
 	}
 
-	for (int i = 0; i < 1000; i++)
-	{
-
-		//  Make or break connections
+	//  Make or break connections
 
-		if (SimLog::Time == start + 10)
-		{   // Connect first End Station to each Bridge.
-			Mac::Connect((Devices[3]->pMacs[0]), (Devices[0]->pMacs[0]), 5);
-			Mac::Connect((Devices[3]->pMacs[2]), (Devices[1]->pMacs[0]), 5);
-		}
+	// Connect first End Station to each Bridge.
+	sim.connect(start + 10, Devices[3]->pMacs[0], Devices[0]->pMacs[0], 5);
+	sim.connect(start + 10, Devices[3]->pMacs[2], Devices[1]->pMacs[0], 5);
 
-		if (SimLog::Time == start + 150)
-		{   // Connect a second link from first End Station to each Bridge.
-			Mac::Connect((Devices[3]->pMacs[1]), (Devices[0]->pMacs[1]), 5);
-			Mac::Connect((Devices[3]->pMacs[3]), (Devices[1]->pMacs[1]), 5);
-		}
+	// Connect a second link from first End Station to each Bridge.
+	sim.connect(start + 150, Devices[3]->pMacs[1], Devices[0]->pMacs[1], 5);
+	sim.connect(start + 150, Devices[3]->pMacs[3], Devices[1]->pMacs[1], 5);
 
-		if (SimLog::Time == start + 200)  // Connect second End Station to first Bridge
-			Mac::Connect((Devices[4]->pMacs[0]), (Devices[0]->pMacs[2]), 5);
+	// Connect second End Station to first Bridge
+	sim.connect(start + 200, Devices[4]->pMacs[0], Devices[0]->pMacs[2], 5);
 
-		if (SimLog::Time == start + 300)  // Connect second link from second End Station to first Bridge
-			Mac::Connect((Devices[4]->pMacs[2]), (Devices[0]->pMacs[3]), 5);
+	// Connect second link from second End Station to first Bridge
+	sim.connect(start + 300, Devices[4]->pMacs[2], Devices[0]->pMacs[3], 5);
 
-		if (SimLog::Time == start + 400)  // Connect second End Station to second Bridge
-			Mac::Connect((Devices[4]->pMacs[1]), (Devices[1]->pMacs[2]), 5);
+	// Connect second End Station to second Bridge
+	sim.connect(start + 400, Devices[4]->pMacs[1], Devices[1]->pMacs[2], 5);
 
-		if (SimLog::Time == start + 500)  // Connect second link from first End Station to second Bridge
-			Mac::Connect((Devices[4]->pMacs[3]), (Devices[1]->pMacs[3]), 5);
+	// Connect second link from first End Station to second Bridge
+	sim.connect(start + 500, Devices[4]->pMacs[3], Devices[1]->pMacs[3], 5);
 
-		if (SimLog::Time == start + 600)  // Disconnect first link on first End Station
-			Mac::Disconnect((Devices[3]->pMacs[0]));
+	// Disconnect first link on first End Station
+	sim.disconnect(start + 600, Devices[3]->pMacs[0]);
 
-		if (SimLog::Time == start + 700)  // Disconnect second link on first End Station
-			Mac::Disconnect((Devices[3]->pMacs[1]));
+	// Disconnect second link on first End Station
+	sim.disconnect(start + 700, Devices[3]->pMacs[1]);
 
-		if (SimLog::Time == start + 990)
-		{   // Restore key for all Aggregators in Bridge 0 to their default value
-			for (auto pAgg : ((LinkAgg&)*(Devices[0]->pComponents[1])).pAggregators)
-			{
-				pAgg->set_aAggActorAdminKey(defaultActorKey);
-			}
-
-			for (auto& pDev : Devices)
-			{
-				pDev->disconnect();      // Disconnect all remaining links on all devices
-			}
-		}
-
-		//  Run all state machines in all devices
-		for (auto& pDev : Devices)
+	sim.at(start + 990, [&]()
+	{   // Restore key for all Aggregators in Bridge 0 to their default value
+		for (auto pAgg : ((LinkAgg&)*(Devices[0]->pComponents[1])).pAggregators)
 		{
-			pDev->timerTick();     // Decrement timers
-			pDev->run(true);   // Run device with single-step true
+			pAgg->set_aAggActorAdminKey(defaultActorKey);
 		}
 
-		//  Transmit from any MAC with frames to transmit in all devices
 		for (auto& pDev : Devices)
 		{
-			pDev->transmit();
+			pDev->disconnect();      // Disconnect all remaining links on all devices
 		}
+	});
 
-
-		if (SimLog::Debug > 1)
-			SimLog::logFile << "*" << endl;
-		SimLog::Time++;
-	}
+	sim.runUntil(start + 1000);
 
 	// Destroy the "outer Link Aggregation shim" in the End Stations, and restore connectivity and key values of inner LinkAgg shim
 	for (int sx = 3; sx < 5; sx++)
@@ -908,8 +998,9 @@ void axbkHierarchicalLagTest(std::vector<unique_ptr<Device>>& Devices)
 }
 
 /**/
-void distributionTest(std::vector<unique_ptr<Device>>& Devices)
+void distributionTest(SimulationEngine& sim)
 {
+	std::vector<unique_ptr<Device>>& Devices = sim.Devices;   // alias
 	int start = SimLog::Time;
 	// aliases
 	EndStn& dev3EndStn = (EndStn&)*(Devices[3]->pComponents[0]);
@@ -918,7 +1009,7 @@ void distributionTest(std::vector<unique_ptr<Device>>& Devices)
 	LinkAgg& dev2LinkAgg = (LinkAgg&)*(Devices[2]->pComponents[1]);
 
 	cout << endl << endl << "   Distribution Tests:  " << endl << endl;
-	if (SimLog::Debug > 0)
+	if (SimLog::debug<0>())
 		SimLog::logFile << endl << endl << "   Distribution Tests:  " << endl << endl;
 
 	for (auto& pDev : Devices)
@@ -940,171 +1031,233 @@ void distributionTest(std::vector<unique_ptr<Device>>& Devices)
 	}
 	/**/
 
-	for (int i = 0; i < 1000; i++)
+	//  Make or break connections
+
+	// Create three links between Bridges 0 and 1, and three links between Bridges 0 and 2.
+	sim.connect(start + 10, Devices[0]->pMacs[0], Devices[1]->pMacs[0], 5);
+	sim.connect(start + 10, Devices[0]->pMacs[1], Devices[1]->pMacs[1], 5);
+	sim.connect(start + 10, Devices[0]->pMacs[2], Devices[1]->pMacs[2], 5);  // Bridges 0:1 get Links 1, 2, 3
+	sim.connect(start + 10, Devices[0]->pMacs[3], Devices[2]->pMacs[3], 5);
+	sim.connect(start + 10, Devices[0]->pMacs[4], Devices[2]->pMacs[4], 5);
+	sim.connect(start + 10, Devices[0]->pMacs[5], Devices[2]->pMacs[5], 5);  // Bridges 0:2 get Links 4, 5, 6
+
+	// Connect one End Station to each Bridge with a pair of links
+	sim.connect(start + 100, Devices[0]->pMacs[6], Devices[3]->pMacs[0], 5);
+	sim.connect(start + 100, Devices[0]->pMacs[7], Devices[3]->pMacs[1], 5);  // Bridge 0 EndStn 3 get Links 7, 8
+	sim.connect(start + 100, Devices[1]->pMacs[4], Devices[4]->pMacs[2], 5);
+	sim.connect(start + 100, Devices[1]->pMacs[5], Devices[4]->pMacs[3], 5);  // Bridge 1 EndStn 4 get Links 5, 6
+	sim.connect(start + 100, Devices[2]->pMacs[0], Devices[5]->pMacs[0], 5);
+	sim.connect(start + 100, Devices[2]->pMacs[1], Devices[5]->pMacs[1], 5);  // Bridge 2 EndStn 5 get Links 1, 2
+
+	sim.at(start + 200, [&]()
 	{
+		printLinkMap(Devices);
+		send9Frames(dev3EndStn);
+		// Mac address hash of EndStn 3 test frame results in a Conversation ID of 0x066b.
+		// With default table this ConvID maps to:
+		//    EndStn 3 to Bridge 0 Link 8
+		//    Bridge 0 to Bridge 1 Link 3
+		//    Bridge 1 to EndStn 4 Link 6
+		//    Bridge 0 to Bridge 2 Link 4
+		//    Bridge 2 to EndStn 5 Link 1
+	});
+
+	// Move one of the links between Bridges 0 and 2 to between Bridges 0 and 1
+	sim.connect(start + 300, Devices[0]->pMacs[3], Devices[1]->pMacs[3], 5);  // Bridges 0:1 get Links 1, 2, 3. 4
+	// Bridges 0:2 get Links 5, 6
+	// Disconnect one of the links at the source End Station
+	sim.disconnect(start + 300, Devices[3]->pMacs[0]);                         // Bridge 0 EndStn 3 get Links 8
+
+	sim.at(start + 400, [&]()
+	{
+		printLinkMap(Devices);
+		send9Frames(dev3EndStn);
+		// Mac address hash of EndStn 3 test frame results in a Conversation ID of 0x066b.
+		// With default table this ConvID maps to:
+		//    EndStn 3 to Bridge 0 Link 8
+		//    Bridge 0 to Bridge 1 Link 3
+		//    Bridge 1 to EndStn 4 Link 6
+		//    Bridge 0 to Bridge 2 Link 6
+		//    Bridge 2 to EndStn 5 Link 1
+	});
+
+	sim.at(start + 500, [&]()
+	{
+		// Test Link Numbers > 7 with the "EIGHT_LINK_SPREAD" convLinkMap
+		dev0LinkAgg.pAggPorts[0]->set_aAggPortLinkNumberID(17);
+		dev0LinkAgg.pAggPorts[1]->set_aAggPortLinkNumberID(25);
 
-		//  Make or break connections
-
-		if (SimLog::Time == start + 10)
-		{   // Create three links between Bridges 0 and 1, and three links between Bridges 0 and 2.
-			Mac::Connect((Devices[0]->pMacs[0]), (Devices[1]->pMacs[0]), 5);
-			Mac::Connect((Devices[0]->pMacs[1]), (Devices[1]->pMacs[1]), 5);
-			Mac::Connect((Devices[0]->pMacs[2]), (Devices[1]->pMacs[2]), 5);  // Bridges 0:1 get Links 1, 2, 3
-			Mac::Connect((Devices[0]->pMacs[3]), (Devices[2]->pMacs[3]), 5);
-			Mac::Connect((Devices[0]->pMacs[4]), (Devices[2]->pMacs[4]), 5);
-			Mac::Connect((Devices[0]->pMacs[5]), (Devices[2]->pMacs[5]), 5);  // Bridges 0:2 get Links 4, 5, 6
+		// Set PortAlgorithm to C_VID in all Bridge 0 Aggregators
+		for (auto& pAgg : dev0LinkAgg.pAggregators)
+		{
+			pAgg->set_aAggPortAlgorithm(Aggregator::portAlgorithms::C_VID);
 		}
-
-		if (SimLog::Time == start + 100)
-		{   // Connect one End Station to each Bridge with a pair of links
-			Mac::Connect((Devices[0]->pMacs[6]), (Devices[3]->pMacs[0]), 5);
-			Mac::Connect((Devices[0]->pMacs[7]), (Devices[3]->pMacs[1]), 5);  // Bridge 0 EndStn 3 get Links 7, 8
-			Mac::Connect((Devices[1]->pMacs[4]), (Devices[4]->pMacs[2]), 5);
-			Mac::Connect((Devices[1]->pMacs[5]), (Devices[4]->pMacs[3]), 5);  // Bridge 1 EndStn 4 get Links 5, 6
-			Mac::Connect((Devices[2]->pMacs[0]), (Devices[5]->pMacs[0]), 5);
-			Mac::Connect((Devices[2]->pMacs[1]), (Devices[5]->pMacs[1]), 5);  // Bridge 2 EndStn 5 get Links 1, 2
+		// Set PortAlgorithm to C_VID in all Bridge 2 Aggregators
+		for (auto& pAgg : dev2LinkAgg.pAggregators)
+		{
+			pAgg->set_aAggPortAlgorithm(Aggregator::portAlgorithms::C_VID);
 		}
+		// Now the LAG between Bridges 0 and 2 (Aggregators b00:203 and b02:203) should have DWC true and differPortAlg false 
+	});
 
-		if (SimLog::Time == start + 200)
+	sim.at(start + 600, [&]()
+	{
+		printLinkMap(Devices);
+		send9Frames(dev3EndStn);
+		// Now the nine frames should be transmitted on links:
+		//    EndStn 3 to Bridge 0 Link 8, 8, 8, 8, 8, 8, 8, 8, 8
+		//    Bridge 0 to Bridge 1 Link 3, 3, 17, 3, 3, 4, 3, 17, 17
+		//    Bridge 1 to EndStn 4 Link 6, 6, 6, 6, 6, 6, 6, 6, 6
+		//    Bridge 0 to Bridge 2 Link 6, 6, 6, 5, 6, 5, 5, 6, 5
+		//    Bridge 2 to EndStn 5 Link 1, 1, 1, 2, 1, 2, 2, 1, 2
+	});
+
+	sim.at(start + 700, [&]()
+	{
+		std::array<unsigned char, 16> AdminTableDigest = { "ADMIN_TABLE    " };
+		std::list<unsigned short> portList;
+
+		// Set link distribution to admin-table in Bridge 0 Aggregator
+		shared_ptr<Aggregator> pAgg = dev2LinkAgg.pAggregators[0];
 		{
-			printLinkMap(Devices);
-			send9Frames(dev3EndStn);
-			// Mac address hash of EndStn 3 test frame results in a Conversation ID of 0x066b.
-			// With default table this ConvID maps to:
-			//    EndStn 3 to Bridge 0 Link 8
-			//    Bridge 0 to Bridge 1 Link 3
-			//    Bridge 1 to EndStn 4 Link 6
-			//    Bridge 0 to Bridge 2 Link 4
-			//    Bridge 2 to EndStn 5 Link 1
-		}
+			//  set port list for first eight Conversation IDs
+			pAgg->set_aAggConversationAdminLink(0, portList = { 3, 2, 1 });
+			pAgg->set_aAggConversationAdminLink(1, portList = { 2, 1, 0 });
+			pAgg->set_aAggConversationAdminLink(2, portList = { 2, 0 });
+			pAgg->set_aAggConversationAdminLink(3, portList = { 2 });
+			pAgg->set_aAggConversationAdminLink(4, portList = { 0 });
+			pAgg->set_aAggConversationAdminLink(5, portList = { 1 });
+			pAgg->set_aAggConversationAdminLink(6, portList = { 1, 0 });
+			pAgg->set_aAggConversationAdminLink(7, portList = { 3, 1, 2 });
 
-		if (SimLog::Time == start + 300)
-		{   // Move one of the links between Bridges 0 and 2 to between Bridges 0 and 1
-			Mac::Connect((Devices[0]->pMacs[3]), (Devices[1]->pMacs[3]), 5);  // Bridges 0:1 get Links 1, 2, 3. 4
-			// Bridges 0:2 get Links 5, 6
-			// Disconnect one of the links at the source End Station
-			Mac::Disconnect(Devices[3]->pMacs[0]);                            // Bridge 0 EndStn 3 get Links 8
+			//   set the digest for admin-table (should be calculated MD5 of the ConversationAdminLink map)
+			pAgg->set_aAggConversationListDigest(AdminTableDigest);
+			//   set the admin-table as the selected convLinkMap
+			pAgg->set_convLinkMap(Aggregator::convLinkMaps::ADMIN_TABLE);
 		}
 
-		if (SimLog::Time == start + 400)
+	});
+
+	sim.at(start + 800, [&]()
+	{
+		printLinkMap(Devices);
+		send9Frames(dev3EndStn);
+		// Now the nine frames should be transmitted on links:
+		//    EndStn 3 to Bridge 0 Link 8, 8, 8, 8, 8, 8, 8, 8, 8
+		//    Bridge 0 to Bridge 1 Link 3, 3, 17, 3, 3, 4, 3, 17, 17
+		//    Bridge 1 to EndStn 4 Link 6, 6, 6, 6, 6, 6, 6, 6, 6
+		//    Bridge 0 to Bridge 2 Link 6, 6, 6, 5, 6, 5, 5, 6, 5
+		//    Bridge 2 to EndStn 5 Link 2, 2, 2, 2, 2, 0, 1, 1, 1
+	});
+
+	sim.at(start + 990, [&]()
+	{
+		for (auto& pDev : Devices)
 		{
-			printLinkMap(Devices);
-			send9Frames(dev3EndStn);
-			// Mac address hash of EndStn 3 test frame results in a Conversation ID of 0x066b.
-			// With default table this ConvID maps to:
-			//    EndStn 3 to Bridge 0 Link 8
-			//    Bridge 0 to Bridge 1 Link 3
-			//    Bridge 1 to EndStn 4 Link 6
-			//    Bridge 0 to Bridge 2 Link 6
-			//    Bridge 2 to EndStn 5 Link 1
+			pDev->disconnect();      // Disconnect all remaining links on all devices
 		}
+		// TODO:  Need to reset all administrative values to their defaults
+	});
 
-		if (SimLog::Time == start + 500)
-		{
-			// Test Link Numbers > 7 with the "EIGHT_LINK_SPREAD" convLinkMap
-			dev0LinkAgg.pAggPorts[0]->set_aAggPortLinkNumberID(17);
-			dev0LinkAgg.pAggPorts[1]->set_aAggPortLinkNumberID(25);
+	sim.runUntil(start + 1000);
+}
 
-			// Set PortAlgorithm to C_VID in all Bridge 0 Aggregators
-			for (auto& pAgg : dev0LinkAgg.pAggregators)
-			{
-				pAgg->set_aAggPortAlgorithm(Aggregator::portAlgorithms::C_VID);
-			}
-			// Set PortAlgorithm to C_VID in all Bridge 2 Aggregators
-			for (auto& pAgg : dev2LinkAgg.pAggregators)
-			{
-				pAgg->set_aAggPortAlgorithm(Aggregator::portAlgorithms::C_VID);
-			}
-			// Now the LAG between Bridges 0 and 2 (Aggregators b00:203 and b02:203) should have DWC true and differPortAlg false 
-		}
+/**/
+void trafficLoadTest(SimulationEngine& sim)
+{
+	std::vector<unique_ptr<Device>>& Devices = sim.Devices;   // alias
+	int start = SimLog::Time;
+	int savedDebug = SimLog::Debug;
+	// aliases
+	EndStn& dev3EndStn = (EndStn&)*(Devices[3]->pComponents[0]);
+	EndStn& dev4EndStn = (EndStn&)*(Devices[4]->pComponents[0]);
+	LinkAgg& dev0LinkAgg = (LinkAgg&)*(Devices[0]->pComponents[1]);
+	LinkAgg& dev1LinkAgg = (LinkAgg&)*(Devices[1]->pComponents[1]);
 
-		if (SimLog::Time == start + 600)
-		{
-			printLinkMap(Devices);
-			send9Frames(dev3EndStn);
-			// Now the nine frames should be transmitted on links:
-			//    EndStn 3 to Bridge 0 Link 8, 8, 8, 8, 8, 8, 8, 8, 8
-			//    Bridge 0 to Bridge 1 Link 3, 3, 17, 3, 3, 4, 3, 17, 17
-			//    Bridge 1 to EndStn 4 Link 6, 6, 6, 6, 6, 6, 6, 6, 6
-			//    Bridge 0 to Bridge 2 Link 6, 6, 6, 5, 6, 5, 5, 6, 5
-			//    Bridge 2 to EndStn 5 Link 1, 1, 1, 2, 1, 2, 2, 1, 2
-		}
+	cout << endl << endl << "   Traffic Load Tests:  " << endl << endl;
+	if (SimLog::debug<0>())
+		SimLog::logFile << endl << endl << "   Traffic Load Tests:  " << endl << endl;
 
-		if (SimLog::Time == start + 700)
-		{
-			std::array<unsigned char, 16> AdminTableDigest = { "ADMIN_TABLE    " };
-			std::list<unsigned short> portList;
+	for (auto& pDev : Devices)
+	{
+		pDev->reset();   // Reset all devices
+	}
 
-			// Set link distribution to admin-table in Bridge 0 Aggregator
-			shared_ptr<Aggregator> pAgg = dev2LinkAgg.pAggregators[0];
-			{
-				//  set port list for first eight Conversation IDs
-				pAgg->set_aAggConversationAdminLink(0, portList = { 3, 2, 1 });
-				pAgg->set_aAggConversationAdminLink(1, portList = { 2, 1, 0 });
-				pAgg->set_aAggConversationAdminLink(2, portList = { 2, 0 });
-				pAgg->set_aAggConversationAdminLink(3, portList = { 2 });
-				pAgg->set_aAggConversationAdminLink(4, portList = { 0 });
-				pAgg->set_aAggConversationAdminLink(5, portList = { 1 });
-				pAgg->set_aAggConversationAdminLink(6, portList = { 1, 0 });
-				pAgg->set_aAggConversationAdminLink(7, portList = { 3, 1, 2 });
-
-				//   set the digest for admin-table (should be calculated MD5 of the ConversationAdminLink map)
-				pAgg->set_aAggConversationListDigest(AdminTableDigest);
-				//   set the admin-table as the selected convLinkMap
-				pAgg->set_convLinkMap(Aggregator::convLinkMaps::ADMIN_TABLE);
-			}
+	// Four links between Bridges 0 and 1, and a pair of links from End Stations 3 and 4 to Bridges 0 and 1.
+	for (int i = 0; i < 4; i++)
+		sim.connect(start + 10, Devices[0]->pMacs[i], Devices[1]->pMacs[i], 5);
+	sim.connect(start + 10, Devices[0]->pMacs[6], Devices[3]->pMacs[0], 5);
+	sim.connect(start + 10, Devices[0]->pMacs[7], Devices[3]->pMacs[1], 5);
+	sim.connect(start + 10, Devices[1]->pMacs[6], Devices[4]->pMacs[0], 5);
+	sim.connect(start + 10, Devices[1]->pMacs[7], Devices[4]->pMacs[1], 5);
 
-		}
+	sim.at(start + 100, [&]()
+	{
+		for (auto& pAgg : dev0LinkAgg.pAggregators)          // Distribute by C-VID on the Bridge 0:1 LAG
+			pAgg->set_aAggPortAlgorithm(Aggregator::portAlgorithms::C_VID);
+		for (auto& pAgg : dev1LinkAgg.pAggregators)
+			pAgg->set_aAggPortAlgorithm(Aggregator::portAlgorithms::C_VID);
+	});
 
-		if (SimLog::Time == start + 800)
+	sim.at(start + 200, [&]()
+	{
+		SimLog::Debug = 0;                                   // Too many frames to log
+		for (unsigned short vid = 1; vid <= 8; vid++)        // Eight Poisson flows, one per C-VID, from End Station 3
 		{
-			printLinkMap(Devices);
-			send9Frames(dev3EndStn);
-			// Now the nine frames should be transmitted on links:
-			//    EndStn 3 to Bridge 0 Link 8, 8, 8, 8, 8, 8, 8, 8, 8
-			//    Bridge 0 to Bridge 1 Link 3, 3, 17, 3, 3, 4, 3, 17, 17
-			//    Bridge 1 to EndStn 4 Link 6, 6, 6, 6, 6, 6, 6, 6, 6
-			//    Bridge 0 to Bridge 2 Link 6, 6, 6, 5, 6, 5, 5, 6, 5
-			//    Bridge 2 to EndStn 5 Link 2, 2, 2, 2, 2, 0, 1, 1, 1
+			TrafficFlow& flow = dev3EndStn.addFlow(dev4EndStn.SystemId.addr, vid);
+			flow.arrivalType = TrafficFlow::arrivals::POISSON;
+			flow.interval = 8;
+			flow.frameBudget = 1000;
+			flow.seed = vid;
+			flow.start(SimLog::Time);
 		}
+	});
 
-		if (SimLog::Time == start + 990)
+	// Take down one link of the Bridge 0:1 LAG while traffic is flowing, so conversations move to other links
+	sim.disconnect(start + 3000, Devices[0]->pMacs[1]);
+
+	sim.at(start + 9900, [&]()
+	{
+		SimLog::Debug = savedDebug;
+		unsigned int generated = 0;
+		for (auto& pFlow : dev3EndStn.flows)
+			generated += pFlow->getFramesGenerated();
+		cout << "Time " << SimLog::Time << ":   End Station 3 generated " << generated << " frames, End Station 4 received "
+			<< dev4EndStn.rxFrameCount << endl;
+		for (int i = 0; i < 4; i++)
 		{
-			for (auto& pDev : Devices)
-			{
-				pDev->disconnect();      // Disconnect all remaining links on all devices
-			}
-			// TODO:  Need to reset all administrative values to their defaults
+			const FrameQueue& queue = Devices[0]->pMacs[i]->getRequestQueue();
+			cout << "     Bridge 0 Mac " << i << ":  queue high water " << queue.getHighWater() << "  drops " << queue.getDrops() << endl;
 		}
-
-		//  Run all state machines in all devices
-		for (auto& pDev : Devices)
+		for (auto& pFlow : dev3EndStn.flows)
 		{
-			pDev->timerTick();     // Decrement timers
-			pDev->run(true);       // Run device with single-step true
+			const FlowRxStats* pStats = dev4EndStn.getRxFlowStats(*pFlow, pFlow->vid);
+			if (pStats)
+			{
+				cout << "     VID " << pFlow->vid << ":  ";
+				pStats->print(cout);
+			}
 		}
-
-		//  Transmit from any MAC with frames to transmit
+		dev3EndStn.flows.clear();
 		for (auto& pDev : Devices)
 		{
-			pDev->transmit();
+			pDev->disconnect();      // Disconnect all remaining links on all devices
 		}
+	});
 
-		if (SimLog::Debug > 1)
-			SimLog::logFile << "*" << endl;
-		SimLog::Time++;
-	}
+	sim.runUntil(start + 10000);
 }
 
 /**/
-void waitToRestoreTest(std::vector<unique_ptr<Device>>& Devices)
+void waitToRestoreTest(SimulationEngine& sim)
 {
+	std::vector<unique_ptr<Device>>& Devices = sim.Devices;   // alias
 	int start = SimLog::Time;
 	// aliases
 	LinkAgg& dev0Lag = (LinkAgg&)*(Devices[0]->pComponents[1]);
 
 	cout << endl << endl << "   Wait-To-Restore Timer Tests:  " << endl << endl;
-	if (SimLog::Debug > 0)
+	if (SimLog::debug<0>())
 		SimLog::logFile << endl << endl << "   Wait-To-Restore Timer Tests:  " << endl << endl;
 
 	for (auto& pDev : Devices)
@@ -1112,239 +1265,165 @@ void waitToRestoreTest(std::vector<unique_ptr<Device>>& Devices)
 		pDev->reset();   // Reset all devices
 	}
 
-	for (int i = 0; i < 1000; i++)
-	{
-		if (SimLog::Time == start + 1)
-		{   // Set waitToRestoreTime of all AggPorts in Bridge 0 to 30
-			for (auto pPort : dev0Lag.pAggPorts)
-			{
-				pPort->set_aAggPortWTRTime(30);
-			}
-			// Set AggPorts 6 and 7 of Bridge 0 for dual-homing
-			//     (Change Aggregator 6 and AggPorts 6 and 7 to a new key,
-			//      and disable Aggregator 7)
-			dev0Lag.pAggregators[6]->set_aAggActorAdminKey(defaultActorKey + 0x100);
-			dev0Lag.pAggPorts[6]->set_aAggPortActorAdminKey(defaultActorKey + 0x100);
-			dev0Lag.pAggPorts[7]->set_aAggPortActorAdminKey(defaultActorKey + 0x100);
-			dev0Lag.pAggregators[7]->setEnabled(false);
+	sim.at(start + 1, [&]()
+	{   // Set waitToRestoreTime of all AggPorts in Bridge 0 to 30
+		for (auto pPort : dev0Lag.pAggPorts)
+		{
+			pPort->set_aAggPortWTRTime(30);
 		}
+		// Set AggPorts 6 and 7 of Bridge 0 for dual-homing
+		//     (Change Aggregator 6 and AggPorts 6 and 7 to a new key,
+		//      and disable Aggregator 7)
+		dev0Lag.pAggregators[6]->set_aAggActorAdminKey(defaultActorKey + 0x100);
+		dev0Lag.pAggPorts[6]->set_aAggPortActorAdminKey(defaultActorKey + 0x100);
+		dev0Lag.pAggPorts[7]->set_aAggPortActorAdminKey(defaultActorKey + 0x100);
+		dev0Lag.pAggregators[7]->setEnabled(false);
+	});
 
-		//  Make or break connections
+	//  Make or break connections
 
-		if (SimLog::Time == start + 10)
-		{   // Create three links between Bridge 0 and End Station 3.
-			Mac::Connect((Devices[0]->pMacs[0]), (Devices[3]->pMacs[0]), 5);
-			Mac::Connect((Devices[0]->pMacs[1]), (Devices[3]->pMacs[1]), 5);
-			Mac::Connect((Devices[0]->pMacs[2]), (Devices[3]->pMacs[2]), 5);
-		}
-		// Links 1, 2 and 3 come up in a LAG on Aggregators b00:200 and e03:200.
+	// Create three links between Bridge 0 and End Station 3.
+	sim.connect(start + 10, Devices[0]->pMacs[0], Devices[3]->pMacs[0], 5);
+	sim.connect(start + 10, Devices[0]->pMacs[1], Devices[3]->pMacs[1], 5);
+	sim.connect(start + 10, Devices[0]->pMacs[2], Devices[3]->pMacs[2], 5);
+	// Links 1, 2 and 3 come up in a LAG on Aggregators b00:200 and e03:200.
 
-		if (SimLog::Time == start + 10)
-		{   // Dual home Bridges 0 to Bridges 1 and 2.
-			Mac::Connect((Devices[0]->pMacs[6]), (Devices[1]->pMacs[6]), 5);
-			Mac::Connect((Devices[0]->pMacs[7]), (Devices[2]->pMacs[7]), 5);
-		}
-		// Link 7 comes up in a LAG on Aggregators b00:206 and b01:206.
-		// Link 8 has no available Aggregators.
+	// Dual home Bridges 0 to Bridges 1 and 2.
+	sim.connect(start + 10, Devices[0]->pMacs[6], Devices[1]->pMacs[6], 5);
+	sim.connect(start + 10, Devices[0]->pMacs[7], Devices[2]->pMacs[7], 5);
+	// Link 7 comes up in a LAG on Aggregators b00:206 and b01:206.
+	// Link 8 has no available Aggregators.
 
-		if (SimLog::Time == start + 100)
-		{
-			Mac::Disconnect((Devices[0]->pMacs[1]));
-			Mac::Disconnect((Devices[0]->pMacs[2]));
-		}
-		// Links 2 and 3 go down leaving just Link 1 in LAG between Bridge 0 and End Station 3.
+	sim.disconnect(start + 100, Devices[0]->pMacs[1]);
+	sim.disconnect(start + 100, Devices[0]->pMacs[2]);
+	// Links 2 and 3 go down leaving just Link 1 in LAG between Bridge 0 and End Station 3.
 
-		if (SimLog::Time == start + 115)
-		{
-			Mac::Connect((Devices[0]->pMacs[1]), (Devices[3]->pMacs[1]), 5);
-			Mac::Connect((Devices[0]->pMacs[2]), (Devices[3]->pMacs[2]), 5);
-		}
-		// Reconnect Links 2 and 3, starting WTR timers.
-
-		if (SimLog::Time == start + 120)
-		{
-			Mac::Disconnect((Devices[0]->pMacs[2]));
-		}
-		// Link 3 goes down again.
+	sim.connect(start + 115, Devices[0]->pMacs[1], Devices[3]->pMacs[1], 5);
+	sim.connect(start + 115, Devices[0]->pMacs[2], Devices[3]->pMacs[2], 5);
+	// Reconnect Links 2 and 3, starting WTR timers.
 
-		if (SimLog::Time == start + 125)
-		{
-			Mac::Connect((Devices[0]->pMacs[2]), (Devices[3]->pMacs[2]), 5);
-		}
-		// Reconnect Link 3, re-starting WTR timer.
+	sim.disconnect(start + 120, Devices[0]->pMacs[2]);
+	// Link 3 goes down again.
 
-		// Link 2 should re-join LAG at around time 155 (time 115 plus WTR plus a LACPDU round trip time)
-		// Link 3 should re-join LAG at around time 165
+	sim.connect(start + 125, Devices[0]->pMacs[2], Devices[3]->pMacs[2], 5);
+	// Reconnect Link 3, re-starting WTR timer.
 
-		if (SimLog::Time == start + 200)
-		{
-			Mac::Disconnect((Devices[0]->pMacs[1]));
-			Mac::Disconnect((Devices[0]->pMacs[2]));
-		}
-		// Links 2 and 3 go down leaving just Link 1 in LAG between Bridge 0 and End Station 3.
+	// Link 2 should re-join LAG at around time 155 (time 115 plus WTR plus a LACPDU round trip time)
+	// Link 3 should re-join LAG at around time 165
 
-		if (SimLog::Time == start + 215)
-		{
-			Mac::Connect((Devices[0]->pMacs[1]), (Devices[3]->pMacs[1]), 5);
-			Mac::Connect((Devices[0]->pMacs[2]), (Devices[3]->pMacs[2]), 5);
-		}
-		// Reconnect Links 2 and 3, starting WTR timers.
-		// Links 2 and 3 rejoin about time 255
+	sim.disconnect(start + 200, Devices[0]->pMacs[1]);
+	sim.disconnect(start + 200, Devices[0]->pMacs[2]);
+	// Links 2 and 3 go down leaving just Link 1 in LAG between Bridge 0 and End Station 3.
 
-		if (SimLog::Time == start + 230)
-		{
-			Mac::Disconnect((Devices[0]->pMacs[0]));
-		}
-		// Disconnect Link 1.
+	sim.connect(start + 215, Devices[0]->pMacs[1], Devices[3]->pMacs[1], 5);
+	sim.connect(start + 215, Devices[0]->pMacs[2], Devices[3]->pMacs[2], 5);
+	// Reconnect Links 2 and 3, starting WTR timers.
+	// Links 2 and 3 rejoin about time 255
 
-		if (SimLog::Time == start + 250)
-		{
-			Mac::Connect((Devices[0]->pMacs[0]), (Devices[3]->pMacs[0]), 5);
-		}
-		// Reconnect Link 1, starting WTR timer.
-		// Link 1 rejoins about time 290
+	sim.disconnect(start + 230, Devices[0]->pMacs[0]);
+	// Disconnect Link 1.
 
+	sim.connect(start + 250, Devices[0]->pMacs[0], Devices[3]->pMacs[0], 5);
+	// Reconnect Link 1, starting WTR timer.
+	// Link 1 rejoins about time 290
 
-		if (SimLog::Time == start + 300)
-			Mac::Disconnect((Devices[0]->pMacs[6]));
-		// Link 7 goes down allowing Link 8 to take over the Aggregator and come up with Bridge 2.
 
-		if (SimLog::Time == start + 350)
-			Mac::Connect((Devices[0]->pMacs[6]), (Devices[1]->pMacs[6]), 5);
-		// Reconnect Link 7, taking over LAG when WTR timer expires.
+	sim.disconnect(start + 300, Devices[0]->pMacs[6]);
+	// Link 7 goes down allowing Link 8 to take over the Aggregator and come up with Bridge 2.
 
-		if (SimLog::Time == start + 400)
-			Mac::Disconnect((Devices[0]->pMacs[7]));
-		// Link 8 goes down, to no effect.
+	sim.connect(start + 350, Devices[0]->pMacs[6], Devices[1]->pMacs[6], 5);
+	// Reconnect Link 7, taking over LAG when WTR timer expires.
 
-		if (SimLog::Time == start + 450)
-			Mac::Connect((Devices[0]->pMacs[7]), (Devices[2]->pMacs[7]), 5);
-		// Reconnect Link 8, still no effect.
+	sim.disconnect(start + 400, Devices[0]->pMacs[7]);
+	// Link 8 goes down, to no effect.
 
-		// So have links 1, 2, and 3 between bridge 0 and end station 3,
-		//   and link 7 between bridge 0 and 1, with link 8 having no available aggregators on bridge 0.
+	sim.connect(start + 450, Devices[0]->pMacs[7], Devices[2]->pMacs[7], 5);
+	// Reconnect Link 8, still no effect.
 
-		if (SimLog::Time == start + 500)
-		{	// Set waitToRestoreTime of all AggPorts in Bridge 0 to 30 with non-revertive mode
-			for (auto pPort : dev0Lag.pAggPorts)
-			{
-				pPort->set_aAggPortWTRTime(30 | 0x8000);
-			}
-			Mac::Disconnect((Devices[0]->pMacs[1]));
-			Mac::Disconnect((Devices[0]->pMacs[2]));
-		}
-		// Links 2 and 3 go down leaving just Link 1 in LAG between Bridge 0 and End Station 3.
-		// AggPorts b00:101 and b00:102 set non-revertive
+	// So have links 1, 2, and 3 between bridge 0 and end station 3,
+	//   and link 7 between bridge 0 and 1, with link 8 having no available aggregators on bridge 0.
 
-		if (SimLog::Time == start + 515)
+	sim.at(start + 500, [&]()
+	{	// Set waitToRestoreTime of all AggPorts in Bridge 0 to 30 with non-revertive mode
+		for (auto pPort : dev0Lag.pAggPorts)
 		{
-			Mac::Connect((Devices[0]->pMacs[1]), (Devices[3]->pMacs[1]), 5);
-			Mac::Connect((Devices[0]->pMacs[2]), (Devices[3]->pMacs[2]), 5);
+			pPort->set_aAggPortWTRTime(30 | 0x8000);
 		}
-		// Reconnect Links 2 and 3, starting WTR timers.
+		Mac::Disconnect((Devices[0]->pMacs[1]));
+		Mac::Disconnect((Devices[0]->pMacs[2]));
+	});
+	// Links 2 and 3 go down leaving just Link 1 in LAG between Bridge 0 and End Station 3.
+	// AggPorts b00:101 and b00:102 set non-revertive
 
-		if (SimLog::Time == start + 520)
-		{
-			Mac::Disconnect((Devices[0]->pMacs[2]));
-		}
-		// Link 3 goes down again.
+	sim.connect(start + 515, Devices[0]->pMacs[1], Devices[3]->pMacs[1], 5);
+	sim.connect(start + 515, Devices[0]->pMacs[2], Devices[3]->pMacs[2], 5);
+	// Reconnect Links 2 and 3, starting WTR timers.
 
-		if (SimLog::Time == start + 525)
-		{
-			Mac::Connect((Devices[0]->pMacs[2]), (Devices[3]->pMacs[2]), 5);
-		}
-		// Reconnect Link 3, re-starting WTR timer.
+	sim.disconnect(start + 520, Devices[0]->pMacs[2]);
+	// Link 3 goes down again.
 
-		// Links 2 and 3 do not re-join because non-revertive
+	sim.connect(start + 525, Devices[0]->pMacs[2], Devices[3]->pMacs[2], 5);
+	// Reconnect Link 3, re-starting WTR timer.
 
-		if (SimLog::Time == start + 600)
-		{
-			Mac::Disconnect((Devices[0]->pMacs[1]));
-			Mac::Disconnect((Devices[0]->pMacs[2]));
-		}
-		// Links 2 and 3 go down so still have just Link 1 in LAG between Bridge 0 and End Station 3.
+	// Links 2 and 3 do not re-join because non-revertive
 
-		if (SimLog::Time == start + 615)
-		{
-			Mac::Connect((Devices[0]->pMacs[1]), (Devices[3]->pMacs[1]), 5);
-			Mac::Connect((Devices[0]->pMacs[2]), (Devices[3]->pMacs[2]), 5);
-		}
-		// Reconnect Links 2 and 3, starting WTR timers.
+	sim.disconnect(start + 600, Devices[0]->pMacs[1]);
+	sim.disconnect(start + 600, Devices[0]->pMacs[2]);
+	// Links 2 and 3 go down so still have just Link 1 in LAG between Bridge 0 and End Station 3.
 
-		if (SimLog::Time == start + 630)
-		{
-			Mac::Disconnect((Devices[0]->pMacs[0]));
-		}
-		// Disconnect Link 1, setting non-revertive.
-		// Now all links are non-revertive so all get set to revertive, but link 1 set non-revertive
-		//    again because it is still down.
-		// Links 2 and 3 come up around time 655.
+	sim.connect(start + 615, Devices[0]->pMacs[1], Devices[3]->pMacs[1], 5);
+	sim.connect(start + 615, Devices[0]->pMacs[2], Devices[3]->pMacs[2], 5);
+	// Reconnect Links 2 and 3, starting WTR timers.
 
-		if (SimLog::Time == start + 650)
-		{
-			Mac::Connect((Devices[0]->pMacs[0]), (Devices[3]->pMacs[0]), 5);
-		}
-		// Reconnect Link 1, starting WTR timer.
-		// Link 1 still non-revertive, so does not become active (i.e. not sync, collecting, or distributing).
+	sim.disconnect(start + 630, Devices[0]->pMacs[0]);
+	// Disconnect Link 1, setting non-revertive.
+	// Now all links are non-revertive so all get set to revertive, but link 1 set non-revertive
+	//    again because it is still down.
+	// Links 2 and 3 come up around time 655.
 
+	sim.connect(start + 650, Devices[0]->pMacs[0], Devices[3]->pMacs[0], 5);
+	// Reconnect Link 1, starting WTR timer.
+	// Link 1 still non-revertive, so does not become active (i.e. not sync, collecting, or distributing).
 
-		if (SimLog::Time == start + 700)
-			Mac::Disconnect((Devices[0]->pMacs[6]));
-		// Link 7 goes down allowing Link 8 to take over the Aggregator and come up with Bridge 2.
 
-		if (SimLog::Time == start + 750)
-			Mac::Connect((Devices[0]->pMacs[6]), (Devices[1]->pMacs[6]), 5);
-		// Reconnect Link 7, to no effect because AggPort b00:106 is non-revertive.
+	sim.disconnect(start + 700, Devices[0]->pMacs[6]);
+	// Link 7 goes down allowing Link 8 to take over the Aggregator and come up with Bridge 2.
 
-		if (SimLog::Time == start + 800)
-			Mac::Disconnect((Devices[0]->pMacs[7]));
-		// Link 8 goes down, causing both AggPorts b00:106 and b00:107 to be set revertive, and Link 7 comes up.
+	sim.connect(start + 750, Devices[0]->pMacs[6], Devices[1]->pMacs[6], 5);
+	// Reconnect Link 7, to no effect because AggPort b00:106 is non-revertive.
 
-		if (SimLog::Time == start + 850)
-			Mac::Connect((Devices[0]->pMacs[7]), (Devices[2]->pMacs[7]), 5);
-		// Reconnect Link 8, no effect.
+	sim.disconnect(start + 800, Devices[0]->pMacs[7]);
+	// Link 8 goes down, causing both AggPorts b00:106 and b00:107 to be set revertive, and Link 7 comes up.
 
+	sim.connect(start + 850, Devices[0]->pMacs[7], Devices[2]->pMacs[7], 5);
+	// Reconnect Link 8, no effect.
 
-		if (SimLog::Time == start + 990)
-		{   // Restore all default values
-			for (auto pAgg : dev0Lag.pAggregators)
-			{
-				pAgg->set_aAggActorAdminKey(defaultActorKey);
-				pAgg->setEnabled(true);
-			}
-			for (auto pPort : dev0Lag.pAggPorts)
-			{
-				pPort->set_aAggPortWTRTime(0);
-			}
-			for (auto& pDev : Devices)
-			{
-				pDev->disconnect();      // Disconnect all remaining links on all devices
-			}
-		}
 
-		//  Run all state machines in all devices
-		for (auto& pDev : Devices)
+	sim.at(start + 990, [&]()
+	{   // Restore all default values
+		for (auto pAgg : dev0Lag.pAggregators)
 		{
-			pDev->timerTick();     // Decrement timers
-			pDev->run(true);       // Run device with single-step true
+			pAgg->set_aAggActorAdminKey(defaultActorKey);
+			pAgg->setEnabled(true);
+		}
+		for (auto pPort : dev0Lag.pAggPorts)
+		{
+			pPort->set_aAggPortWTRTime(0);
 		}
-
-		//  Transmit from any MAC with frames to transmit
 		for (auto& pDev : Devices)
 		{
-			pDev->transmit();
+			pDev->disconnect();      // Disconnect all remaining links on all devices
 		}
+	});
 
-		if (SimLog::Debug > 1)
-			SimLog::logFile << "*" << endl;
-		SimLog::Time++;
-	}
+	sim.runUntil(start + 1000);
 
 }
 
 /**/
-void adminVariableTest(std::vector<unique_ptr<Device>>& Devices)
+void adminVariableTest(SimulationEngine& sim)
 {
+	std::vector<unique_ptr<Device>>& Devices = sim.Devices;   // alias
 	int start = SimLog::Time;
 	// aliases
 	EndStn& dev3EndStn = (EndStn&)*(Devices[3]->pComponents[0]);
@@ -1355,7 +1434,7 @@ void adminVariableTest(std::vector<unique_ptr<Device>>& Devices)
 	unsigned short savedKey = dev0LinkAgg.pAggPorts[1]->get_aAggActorAdminKey();
 
 	cout << endl << endl << "   Writing Administrative Variables Tests:  " << endl << endl;
-	if (SimLog::Debug > 0)
+	if (SimLog::debug<0>())
 		SimLog::logFile << endl << endl << "   Writing Administrative Variables Tests:  " << endl << endl;
 
 	for (auto& pDev : Devices)
@@ -1363,128 +1442,569 @@ void adminVariableTest(std::vector<unique_ptr<Device>>& Devices)
 		pDev->reset();   // Reset all devices
 	}
 
+	//  Make or break connections
+
+	sim.at(start + 10, [&]()
+	{   
+		// Set PortAlgorithm to C_VID in all Bridge 1 Aggregators
+		for (auto& pAgg : dev1LinkAgg.pAggregators)
+		{
+			pAgg->set_aAggPortAlgorithm(Aggregator::portAlgorithms::C_VID);
+		}
+	});
+
+	// Create three links between Bridges 0 and 1.
+	sim.connect(start + 40, Devices[0]->pMacs[1], Devices[1]->pMacs[2], 5);
+	sim.connect(start + 40, Devices[0]->pMacs[2], Devices[1]->pMacs[3], 5);
+	sim.connect(start + 40, Devices[0]->pMacs[3], Devices[1]->pMacs[1], 5);
 
-	for (int i = 0; i < 1000; i++)
+	sim.at(start + 100, [&]()
 	{
+		dev0LinkAgg.pAggPorts[1]->set_aAggPortActorAdminKey(0x0246);       // change port key
+	});
 
-		//  Make or break connections
 
-		if (SimLog::Time == start + 10)
-		{   
-			// Set PortAlgorithm to C_VID in all Bridge 1 Aggregators
-			for (auto& pAgg : dev1LinkAgg.pAggregators)
-			{
-				pAgg->set_aAggPortAlgorithm(Aggregator::portAlgorithms::C_VID);
-			}
-		}
+	sim.at(start + 200, [&]()
+	{
+		dev0LinkAgg.pAggPorts[1]->set_aAggActorAdminKey(0x0246);           // change aggregator key
+	});
 
-		if (SimLog::Time == start + 40)
-		{   // Create three links between Bridges 0 and 1.
-			Mac::Connect((Devices[0]->pMacs[1]), (Devices[1]->pMacs[2]), 5);
-			Mac::Connect((Devices[0]->pMacs[2]), (Devices[1]->pMacs[3]), 5);
-			Mac::Connect((Devices[0]->pMacs[3]), (Devices[1]->pMacs[1]), 5);
-		}
+	sim.at(start + 300, [&]()
+	{
+		dev0LinkAgg.pAggPorts[2]->set_aAggActorSystemPriority(0x0135);     // change aggregator SysID (which changes LAG ID)
+	});
 
-		if (SimLog::Time == start + 100)
-		{
-			dev0LinkAgg.pAggPorts[1]->set_aAggPortActorAdminKey(0x0246);       // change port key
-		}
+	sim.at(start + 400, [&]()
+	{
+		dev0LinkAgg.pAggPorts[1]->set_aAggPortActorAdminKey(savedKey);     // restore port key
+		dev0LinkAgg.pAggPorts[1]->set_aAggActorAdminKey(savedKey);         // restore aggregator key
+		dev0LinkAgg.pAggPorts[2]->set_aAggActorSystemPriority(0);          // restore aggregator SysID (which changes LAG ID)
+	});
 
+/*
+	sim.at(start + 450, [&]()   // Patch up this link until Selection Logic bug is fixed
+	{   
+		dev0LinkAgg.pAggPorts[3]->setEnabled(false);
+	});
+	sim.at(start + 454, [&]()
+	{   
+		dev0LinkAgg.pAggPorts[3]->setEnabled(true);
+	});
+/**/
 
-		if (SimLog::Time == start + 200)
-		{
-			dev0LinkAgg.pAggPorts[1]->set_aAggActorAdminKey(0x0246);           // change aggregator key
-		}
+	sim.at(start + 500, [&]()
+	{
+		dev0LinkAgg.pAggPorts[1]->set_aAggPortLinkNumberID(18);            // change link number of b00:101
+	});
+
+	sim.at(start + 600, [&]()
+	{
+		dev0LinkAgg.pAggPorts[1]->set_aAggPortAlgorithm(Aggregator::portAlgorithms::C_VID);       // change port algorithm
+	});
+
+	sim.at(start + 630, [&]()
+	{
+		dev0LinkAgg.pAggPorts[2]->set_aAggPortLinkNumberID(18);             // create duplicate link number on b00:102
+	});
+
+	sim.at(start + 700, [&]()
+	{
+		dev0LinkAgg.pAggPorts[1]->set_aAggPortLinkNumberID(2);             // restore link number of b00:101
+	});
+
+	sim.at(start + 800, [&]()
+	{
+		dev0LinkAgg.pAggPorts[1]->set_aAggPortAlgorithm(Aggregator::portAlgorithms::UNSPECIFIED); // restore port algorithm
+	});
+
+	sim.at(start + 830, [&]()
+	{
+		dev0LinkAgg.pAggPorts[2]->set_aAggPortLinkNumberID(2);             // create duplicate link number on b00:102
+	});
+
+	sim.at(start + 860, [&]()
+	{
+		dev0LinkAgg.pAggPorts[2]->set_aAggPortLinkNumberID(3);             // restore link number of b00:102
+	});
 
-		if (SimLog::Time == start + 300)
+
+	sim.at(start + 990, [&]()
+	{
+		for (auto& pDev : Devices)
 		{
-			dev0LinkAgg.pAggPorts[2]->set_aAggActorSystemPriority(0x0135);     // change aggregator SysID (which changes LAG ID)
+			pDev->disconnect();      // Disconnect all remaining links on all devices
 		}
-
-		if (SimLog::Time == start + 400)
+		for (auto& pAgg : dev1LinkAgg.pAggregators)
 		{
-			dev0LinkAgg.pAggPorts[1]->set_aAggPortActorAdminKey(savedKey);     // restore port key
-			dev0LinkAgg.pAggPorts[1]->set_aAggActorAdminKey(savedKey);         // restore aggregator key
-			dev0LinkAgg.pAggPorts[2]->set_aAggActorSystemPriority(0);          // restore aggregator SysID (which changes LAG ID)
+			pAgg->set_aAggPortAlgorithm(Aggregator::portAlgorithms::UNSPECIFIED);
 		}
+	});
+
+	sim.runUntil(start + 1000);
+
+}
+
+/**/
 
 /*
-		if (SimLog::Time == start + 450)                 // Patch up this link until Selection Logic bug is fixed
-		{   
-			dev0LinkAgg.pAggPorts[3]->setEnabled(false);
-		}
-		if (SimLog::Time == start + 454)
-		{   
-			dev0LinkAgg.pAggPorts[3]->setEnabled(true);
-		}
+*   Class Scenario is the scaffold for a test that builds its own network of Devices, in a SimulationEngine
+*       separate from the main simulation.  The constructor writes the scenario's title, addBridge() and addEndStation()
+*       make the Devices, and link() schedules connecting two of them.  write() writes a report to the console and,
+*       when debugging, to the log file, and report() schedules one.  A report uses check() or checkAtMost() for each 
+*       result, which flags a result that is not as expected.  run() plays the scenario (resetting the Devices first) 
+*       and then finishes it by writing how many results were not as expected.  A scenario that is played more than
+*       once rewinds Time to its start before each replay.
+*/
+/**/
+class Scenario
+{
+public:
+	Scenario(const char* scenarioTitle);
+	~Scenario();
+	Scenario(Scenario& copySource) = delete;             // Disable copy constructor
+	Scenario& operator= (const Scenario&) = delete;      // Disable assignment operator
+
+	SimulationEngine net;
+	int start;                                           // Time the scenario began
+
+	Device& addBridge(int nMacs, unsigned short nAggregators = 0);
+	Device& addEndStation();
+	void link(Device& devA, int macA, Device& devB, int macB, int time = 10);     // Connect at start + time
+	void write(std::function<void(std::ostream&)> print);
+	void report(int time, std::function<void(std::ostream&)> print);             // Write a report at start + time
+	void check(std::ostream& out, const std::string& what, long long actual, long long expected);
+	void checkAtMost(std::ostream& out, const std::string& what, long long actual, long long limit);
+	void play(int duration = 1000);                      // Disconnects all links 5 ticks before the end
+	void rewind();                                       // Set Time back to start
+	void finish();
+	void run(int duration = 1000);                       // play() then finish()
+
+private:
+	std::string title;
+	int nChecks;
+	int nMismatches;
+};
 /**/
 
-		if (SimLog::Time == start + 500)
-		{
-			dev0LinkAgg.pAggPorts[1]->set_aAggPortLinkNumberID(18);            // change link number of b00:101
-		}
+Scenario::Scenario(const char* scenarioTitle)
+	: title(scenarioTitle)
+{
+	start = SimLog::Time;
+	nChecks = 0;
+	nMismatches = 0;
 
-		if (SimLog::Time == start + 600)
-		{
-			dev0LinkAgg.pAggPorts[1]->set_aAggPortAlgorithm(Aggregator::portAlgorithms::C_VID);       // change port algorithm
-		}
+	cout << endl << endl << "   " << title << " Tests:  " << endl << endl;
+	if (SimLog::debug<0>())
+		SimLog::logFile << endl << endl << "   " << title << " Tests:  " << endl << endl;
+}
 
-		if (SimLog::Time == start + 630)
-		{
-			dev0LinkAgg.pAggPorts[2]->set_aAggPortLinkNumberID(18);             // create duplicate link number on b00:102
-		}
+Scenario::~Scenario()
+{
+}
 
-		if (SimLog::Time == start + 700)
-		{
-			dev0LinkAgg.pAggPorts[1]->set_aAggPortLinkNumberID(2);             // restore link number of b00:101
-		}
+Device& Scenario::addBridge(int nMacs, unsigned short nAggregators)
+{
+	net.Devices.push_back(make_unique<Device>(nMacs));
+	net.Devices.back()->createBridge(CVlanEthertype, nAggregators);
+	return (*net.Devices.back());
+}
 
-		if (SimLog::Time == start + 800)
-		{
-			dev0LinkAgg.pAggPorts[1]->set_aAggPortAlgorithm(Aggregator::portAlgorithms::UNSPECIFIED); // restore port algorithm
-		}
+Device& Scenario::addEndStation()
+{
+	net.Devices.push_back(make_unique<Device>(2));
+	net.Devices.back()->createEndStation();
+	return (*net.Devices.back());
+}
 
-		if (SimLog::Time == start + 830)
-		{
-			dev0LinkAgg.pAggPorts[2]->set_aAggPortLinkNumberID(2);             // create duplicate link number on b00:102
-		}
+void Scenario::link(Device& devA, int macA, Device& devB, int macB, int time)
+{
+	net.connect(start + time, devA.pMacs[macA], devB.pMacs[macB], 5);
+}
 
-		if (SimLog::Time == start + 860)
-		{
-			dev0LinkAgg.pAggPorts[2]->set_aAggPortLinkNumberID(3);             // restore link number of b00:102
-		}
+void Scenario::write(std::function<void(std::ostream&)> print)
+{
+	std::ostringstream text;                 // Write the report once, so each result is only checked once
+	print(text);
+	cout << text.str();
+	if (SimLog::debug<0>())
+		SimLog::logFile << text.str();
+}
+
+void Scenario::report(int time, std::function<void(std::ostream&)> print)
+{
+	net.at(start + time, [this, print]() { write(print); });
+}
+
+void Scenario::check(std::ostream& out, const std::string& what, long long actual, long long expected)
+{
+	nChecks++;
+	out << "Time " << SimLog::Time << ":   " << what << ":  " << actual;
+	if (actual != expected)
+	{
+		nMismatches++;
+		out << "   *** MISMATCH:  expected " << expected << " ***";
+	}
+	out << endl;
+}
+
+void Scenario::checkAtMost(std::ostream& out, const std::string& what, long long actual, long long limit)
+{
+	nChecks++;
+	out << "Time " << SimLog::Time << ":   " << what << ":  " << actual;
+	if (actual > limit)
+	{
+		nMismatches++;
+		out << "   *** MISMATCH:  expected at most " << limit << " ***";
+	}
+	out << endl;
+}
+
+void Scenario::play(int duration)
+{
+	for (auto& pDev : net.Devices)
+	{
+		pDev->reset();   // Reset all devices
+	}
+	net.disconnectAll(start + duration - 5);
+	net.runUntil(start + duration);
+}
+
+void Scenario::rewind()
+{
+	SimLog::Time = start;
+}
+
+void Scenario::finish()
+{
+	write([this](std::ostream& out)
+	{
+		if (nMismatches == 0)
+			out << endl << "   " << title << " Tests:  all " << nChecks << " results as expected" << endl;
+		else
+			out << endl << "   *** " << title << " Tests:  " << nMismatches << " of " << nChecks << " results NOT as expected ***" << endl;
+	});
+}
 
+void Scenario::run(int duration)
+{
+	play(duration);
+	finish();
+}
 
-		if (SimLog::Time == start + 990)
+/**/
+
+/*
+*   A Bridge with eight Aggregation Ports sharing two Aggregators (createBridge with nAggregators), and three partner
+*   Bridges with an Aggregator for each port.  Four links to the first partner and three to the second each form a LAG
+*   on one of the two shared Aggregators.  A link to the third partner then finds no Aggregator available, until the
+*   links to the first partner are removed and its Aggregator is released.
+*/
+void sharedAggregatorTest()
+{
+	Scenario test("Shared Aggregator");
+	Device& shared = test.addBridge(8, 2);
+	Device& partner1 = test.addBridge(4);
+	Device& partner2 = test.addBridge(4);
+	Device& partner3 = test.addBridge(4);
+	LinkAgg& sharedLinkAgg = (LinkAgg&)*(shared.pComponents[1]);   // alias
+
+	auto checkAggregator = [&](std::ostream& out, int aggIndex, Device* pPartner, int nPorts)
+	{
+		Aggregator& agg = *sharedLinkAgg.pAggregators[aggIndex];
+		int attached = 0;
+		for (auto& pPort : sharedLinkAgg.pAggPorts)
+			attached += (pPort->get_aAggPortAttachedAggID() == agg.get_aAggID());
+		int partnerDevice = -1;
+		for (auto& pDev : test.net.Devices)
+			if (((Bridge&)*(pDev->pComponents[0])).SystemId.id == agg.get_aAggPartnerSystemID())
+				partnerDevice = pDev->getDeviceNumber();
+		std::string name = "Aggregator " + std::to_string(aggIndex);
+		test.check(out, name + " partner Device", partnerDevice, pPartner->getDeviceNumber());
+		test.check(out, name + " attached ports", attached, nPorts);
+	};
+
+	for (int i = 0; i < 4; i++)
+		test.link(shared, i, partner1, i);                   // First partner on ports 0-3
+	for (int i = 0; i < 3; i++)
+		test.link(shared, 4 + i, partner2, i);               // Second partner on ports 4-6
+	test.report(300, [&](std::ostream& out)
+	{
+		checkAggregator(out, 0, &partner1, 4);
+		checkAggregator(out, 1, &partner2, 3);
+	});
+
+	test.link(shared, 7, partner3, 0, 400);                  // Third partner on port 7
+	test.report(600, [&](std::ostream& out)
+	{
+		checkAggregator(out, 0, &partner1, 4);
+		checkAggregator(out, 1, &partner2, 3);
+		test.check(out, "Port 7 attached Aggregator ID", sharedLinkAgg.pAggPorts[7]->get_aAggPortAttachedAggID(), 0);
+	});
+
+	for (int i = 0; i < 4; i++)
+		test.net.disconnect(test.start + 700, shared.pMacs[i]);      // Remove the first partner's LAG
+	test.report(990, [&](std::ostream& out)
+	{
+		checkAggregator(out, 0, &partner3, 1);               // Port 7 has taken the released Aggregator
+		checkAggregator(out, 1, &partner2, 3);
+	});
+
+	test.run();
+}
+
+/*
+*   A Bridge with End Stations A, B and C on ports 0, 1 and 2, and a short FilteringDatabase agingTime.
+*   A frame from A to C is flooded, since C is unknown, and the Bridge learns A.  Frames from C to A are then
+*   forwarded only to A's port, until A's entry ages out and the next frame to A is flooded again.
+*/
+void filteringDatabaseTest()
+{
+	Scenario test("Filtering Database");
+	Device& bridgeDev = test.addBridge(4);
+	Device& devA = test.addEndStation();
+	Device& devB = test.addEndStation();
+	Device& devC = test.addEndStation();
+	// aliases
+	Bridge& bridge = (Bridge&)*(bridgeDev.pComponents[0]);
+	EndStn& stnA = (EndStn&)*(devA.pComponents[0]);
+	EndStn& stnB = (EndStn&)*(devB.pComponents[0]);
+	EndStn& stnC = (EndStn&)*(devC.pComponents[0]);
+
+	bridge.fdb.agingTime = 500;
+	test.link(bridgeDev, 0, devA, 0);
+	test.link(bridgeDev, 1, devB, 0);
+	test.link(bridgeDev, 2, devC, 0);
+
+	TrafficFlow& flowAC = stnA.addFlow(stnC.SystemId.addr);
+	TrafficFlow& flowCA = stnC.addFlow(stnA.SystemId.addr);
+	flowAC.frameBudget = 1;
+	flowCA.frameBudget = 1;
+	auto checkCounts = [&](std::ostream& out, int rxA, int rxB, int rxC, int entries)
+	{
+		test.check(out, "Frames received by A", stnA.rxFrameCount, rxA);
+		test.check(out, "Frames received by B", stnB.rxFrameCount, rxB);
+		test.check(out, "Frames received by C", stnC.rxFrameCount, rxC);
+		test.check(out, "Filtering Database entries", bridge.fdb.size(), entries);
+	};
+
+	test.net.at(test.start + 100, [&]() { flowAC.start(SimLog::Time); });   // C unknown:  flooded to B and C
+	test.net.at(test.start + 200, [&]() { flowCA.start(SimLog::Time); });   // A learned:  forwarded to A only
+	test.report(300, [&](std::ostream& out) { checkCounts(out, 1, 1, 1, 2); });
+	test.net.at(test.start + 500, [&]() { flowCA.start(SimLog::Time); });   // A's entry still current:  forwarded to A only
+	test.report(600, [&](std::ostream& out) { checkCounts(out, 2, 1, 1, 2); });
+	test.net.at(test.start + 800, [&]() { flowCA.start(SimLog::Time); });   // A's entry aged out:  flooded to A and B
+	test.report(900, [&](std::ostream& out)
+	{
+		checkCounts(out, 3, 2, 1, 1);
+		const FlowRxStats* pStats = stnA.getRxFlowStats(flowCA, 0);
+		test.check(out, "Duplicates received by A", pStats ? (long long)pStats->getDuplicates() : -1, 0);   // Each restart continues the sequence
+		test.check(out, "Frames lost by A", pStats ? (long long)pStats->getLost() : -1, 0);
+	});
+
+	test.run();
+}
+
+/*
+*   A C-VLAN Bridge with End Stations A, B, C and D on ports 0 to 3, all with pvid 10.
+*   VLAN 10 has A and C as untagged members and B as a tagged member;  D is not a member.
+*   Untagged and priority-tagged frames from A are classified to VLAN 10, and reach B tagged with VID 10 and C untagged.
+*   Frames from D are discarded at ingress.  Tagged frames from B to A (now learned) reach only A, untagged.
+*/
+void vlanTest()
+{
+	Scenario test("VLAN");
+	Device& bridgeDev = test.addBridge(4);
+	Device& devA = test.addEndStation();
+	Device& devB = test.addEndStation();
+	Device& devC = test.addEndStation();
+	Device& devD = test.addEndStation();
+	// aliases
+	Bridge& bridge = (Bridge&)*(bridgeDev.pComponents[0]);
+	EndStn& stnA = (EndStn&)*(devA.pComponents[0]);
+	EndStn& stnB = (EndStn&)*(devB.pComponents[0]);
+	EndStn& stnC = (EndStn&)*(devC.pComponents[0]);
+	EndStn& stnD = (EndStn&)*(devD.pComponents[0]);
+
+	for (auto& pPort : bridge.bPorts)
+		pPort->pvid = 10;
+	bridge.setVlanMember(10, 0, true);        // A untagged
+	bridge.setVlanMember(10, 1);              // B tagged
+	bridge.setVlanMember(10, 2, true);        // C untagged
+	test.link(bridgeDev, 0, devA, 0);
+	test.link(bridgeDev, 1, devB, 0);
+	test.link(bridgeDev, 2, devC, 0);
+	test.link(bridgeDev, 3, devD, 0);
+
+	TrafficFlow& flowA = stnA.addFlow(stnB.SystemId.addr);         // Untagged
+	TrafficFlow& flowD = stnD.addFlow(stnB.SystemId.addr);         // Untagged, from a non-member port
+	TrafficFlow& flowB = stnB.addFlow(stnA.SystemId.addr, 10);     // Tagged with VID 10
+	flowA.frameBudget = 2;
+	flowD.frameBudget = 2;
+	flowB.frameBudget = 2;
+	auto received = [](EndStn& station, TrafficFlow& flow, unsigned short vid)
+	{
+		const FlowRxStats* pStats = station.getRxFlowStats(flow, vid);
+		return (pStats ? (long long)pStats->getReceived() : 0);
+	};
+	auto receivedTestFrames = [](EndStn& station, EndStn& source, unsigned short vid)   // From generateTestFrame
+	{
+		const FlowRxStats* pStats = station.getRxFlowStats(source.SystemId.addr, vid);
+		return (pStats ? (long long)pStats->getReceived() : 0);
+	};
+	auto duplicates = [](EndStn& station)
+	{
+		long long count = 0;
+		for (auto& flowStats : station.rxFlows)
+			count += flowStats.second->getDuplicates();
+		return (count);
+	};
+
+	test.net.at(test.start + 100, [&]() { flowA.start(SimLog::Time); });   // B unknown:  B gets VID 10, C untagged
+	test.net.at(test.start + 200, [&]()
+	{
+		stnA.generateTestFrame(FramePool::makeShared<VlanTag>(CVlanEthertype, 0, 5, false));   // Priority-tagged:  same as untagged
+	});
+	test.net.at(test.start + 300, [&]() { flowD.start(SimLog::Time); });   // Discarded at ingress
+	test.net.at(test.start + 400, [&]() { flowB.start(SimLog::Time); });   // A learned:  A gets it untagged
+	test.report(500, [&](std::ostream& out)
+	{
+		test.check(out, "A received from B's flow untagged", received(stnA, flowB, 0), 2);
+		test.check(out, "A received", stnA.rxFrameCount, 2);
+		test.check(out, "B received from A's flow with VID 10", received(stnB, flowA, 10), 2);
+		test.check(out, "B received A's test frame with VID 10", receivedTestFrames(stnB, stnA, 10), 1);
+		test.check(out, "B received", stnB.rxFrameCount, 3);
+		test.check(out, "C received from A's flow untagged", received(stnC, flowA, 0), 2);
+		test.check(out, "C received A's test frame untagged", receivedTestFrames(stnC, stnA, 0), 1);
+		test.check(out, "C received", stnC.rxFrameCount, 3);
+		test.check(out, "D received", stnD.rxFrameCount, 0);
+		test.check(out, "Duplicates received by A, B and C", duplicates(stnA) + duplicates(stnB) + duplicates(stnC), 0);
+	});
+
+	test.run();
+}
+
+/*
+*   Three Bridges connected in a ring, with the loop guard enabled (maxHops = 8), and an End Station on Bridge 0 
+*   sending broadcast frames.  Every frame circulates the ring in both directions until the loop guard discards it, 
+*   so loopDiscards grows by two for each frame sent while the Bridge queues stay small, and the queues are empty 
+*   once the End Station stops sending.  Each direction passes Bridge 0 twice, so the End Station receives each 
+*   frame four times.  (With maxHops = 0 the frames circulate forever.)
+*/
+void loopGuardTest()
+{
+	Scenario test("Loop Guard");
+	Device* pBridges[3];
+	for (int i = 0; i < 3; i++)
+	{
+		pBridges[i] = &test.addBridge(3);
+		((Bridge&)*(pBridges[i]->pComponents[0])).maxHops = 8;
+	}
+	Device& stationDev = test.addEndStation();
+	EndStn& station = (EndStn&)*(stationDev.pComponents[0]);   // alias
+
+	for (int i = 0; i < 3; i++)
+		test.link(*pBridges[i], 0, *pBridges[(i + 1) % 3], 1);   // Ring
+	test.link(*pBridges[0], 2, stationDev, 0);
+
+	TrafficFlow& flow = station.addFlow(0xffffffffffff);     // Broadcast
+	flow.interval = 2;
+	flow.frameBudget = 20;
+	test.net.at(test.start + 100, [&]() { flow.start(SimLog::Time); });
+
+	auto checkLoopGuard = [&](std::ostream& out, bool finished)
+	{
+		long long discards = 0;
+		size_t highWater = 0;
+		size_t queued = 0;
+		for (auto pDev : pBridges)
 		{
-			for (auto& pDev : Devices)
+			discards += ((Bridge&)*(pDev->pComponents[0])).loopDiscards;
+			for (auto& pMac : pDev->pMacs)
 			{
-				pDev->disconnect();      // Disconnect all remaining links on all devices
-			}
-			for (auto& pAgg : dev1LinkAgg.pAggregators)
-			{
-				pAgg->set_aAggPortAlgorithm(Aggregator::portAlgorithms::UNSPECIFIED);
+				highWater = std::max(highWater, pMac->getRequestQueue().getHighWater());
+				queued += pMac->getRequestQueue().size();
 			}
 		}
-
-		//  Run all state machines in all devices
-		for (auto& pDev : Devices)
+		long long sent = flow.getFramesGenerated();
+		out << "Time " << SimLog::Time << ":   Sent " << sent << "  loop discards " << discards << "  queued " << queued
+			<< "  station received " << station.rxFrameCount << endl;
+		test.checkAtMost(out, "Queue high water", highWater, 8);
+		if (finished)
 		{
-			pDev->timerTick();     // Decrement timers
-			pDev->run(true);       // Run device with single-step true
+			test.check(out, "Loop discards", discards, 2 * sent);
+			test.check(out, "Frames queued", queued, 0);
+			test.check(out, "Frames received by End Station", station.rxFrameCount, 4 * sent);
 		}
+	};
+	for (int t : { 120, 140, 200 })
+		test.report(t, [&](std::ostream& out) { checkLoopGuard(out, false); });
+	test.report(900, [&](std::ostream& out) { checkLoopGuard(out, true); });
 
-		//  Transmit from any MAC with frames to transmit
-		for (auto& pDev : Devices)
-		{
-			pDev->transmit();
-		}
+	test.run();
+}
 
-		if (SimLog::Debug > 1)
-			SimLog::logFile << "*" << endl;
-		SimLog::Time++;
+/*
+*   Plays the same LACPv2 scenario (Port Conversation Mask TLVs and all) with one thread and again with four threads,
+*   capturing the log file and console messages each time, and checks that the two captures are identical.  The network is the one of the
+*   Shared Aggregator Tests.  The Devices are reset before each play, so state that reset() leaves uninitialized
+*   shows up as a difference too.  A first play, which is not compared, leaves the Devices in the state that both
+*   compared plays start from (reset() logs the Aggregator each port was last attached to).
+*/
+void threadCountTest()
+{
+	Scenario test("Thread Count");
+	Device& shared = test.addBridge(8, 2);
+	Device& partner1 = test.addBridge(4);
+	Device& partner2 = test.addBridge(4);
+	unsigned int savedThreadCount = Device::getThreadCount();
+	int savedDebug = SimLog::Debug;
+	const unsigned int threadCounts[3] = { 1, 1, 4 };
+	std::ostringstream logs[3];
+	std::ostringstream consoles[3];
+
+	for (int play = 0; play < 3; play++)
+	{
+		test.rewind();
+		for (int i = 0; i < 4; i++)
+			test.link(shared, i, partner1, i);
+		for (int i = 0; i < 3; i++)
+			test.link(shared, 4 + i, partner2, i);
+		for (int i = 0; i < 4; i++)
+			test.net.disconnect(test.start + 500, shared.pMacs[i]);
+
+		Device::setThreadCount(threadCounts[play]);
+		SimLog::Debug = 8;                                   // Log every LACPDU received
+		std::streambuf* pLogBuf = SimLog::logFile.rdbuf(logs[play].rdbuf());
+		std::streambuf* pConsoleBuf = SimLog::console.rdbuf(consoles[play].rdbuf());
+		test.play();
+		SimLog::logFile.rdbuf(pLogBuf);
+		SimLog::console.rdbuf(pConsoleBuf);
+		SimLog::Debug = savedDebug;
 	}
-
+	Device::setThreadCount(savedThreadCount);
+
+	std::istringstream serial(logs[1].str() + consoles[1].str());
+	std::istringstream parallel(logs[2].str() + consoles[2].str());
+	std::string serialLine;
+	std::string parallelLine;
+	int nLines = 0;
+	int nDifferent = 0;
+	bool moreSerial = true;
+	bool moreParallel = true;
+	while (true)
+	{
+		moreSerial = moreSerial && std::getline(serial, serialLine);          // getline() leaves the line empty at the end
+		moreParallel = moreParallel && std::getline(parallel, parallelLine);
+		if (!moreSerial && !moreParallel)
+			break;
+		nLines++;
+		nDifferent += (serialLine != parallelLine);
+	}
+	test.write([&](std::ostream& out)
+	{
+		out << "Time " << SimLog::Time << ":   " << nLines << " log and console lines with " << threadCounts[1] << " and " 
+			<< threadCounts[2] << " threads" << endl;
+		test.check(out, "Lines that differ", nDifferent, 0);
+	});
+	test.finish();
 }
-
-/**/
@@ -16,6 +16,7 @@ limitations under the License.
 
 #include "stdafx.h"
 #include "Mac.h"
+#include "ConsoleReport.h"
 
 /**/
 Iss::Iss()
@@ -84,6 +85,27 @@ unique_ptr<Frame> IssQ::Indication()
 		}
 }
 
+void IssQ::setQueueDepth(size_t depth)
+{
+	requests.setDepth(depth);
+	indications.setDepth(depth);
+}
+
+size_t IssQ::getQueueDepth() const
+{
+	return (requests.getDepth());
+}
+
+const FrameQueue& IssQ::getRequestQueue() const
+{
+	return (requests);
+}
+
+const FrameQueue& IssQ::getIndicationQueue() const
+{
+	return (indications);
+}
+
 /**/
 
 Component::Component(ComponentTypes thisType)
@@ -120,6 +142,16 @@ void Component::setSuspended(bool val)
 	suspended = val;
 }
 
+int Component::nextWakeup() const
+{
+	return (SimLog::Time);        // Unless the derived class knows better, it needs to run every tick
+}
+
+void Component::skipTicks(int /* ticks */)
+{
+	// No timers to advance
+}
+
 /**/
 
 
@@ -130,6 +162,9 @@ Mac::Mac()
 	macAddress = defaultOUI;
 //	macId.id = 0;
 	linkPartner = nullptr;
+	txFramesPerTick = 0;
+	txOctetsPerTick = 0;
+	txOctetCredit = 0;
 //	std::cout << "Mac Constructor called" << std::endl;
 };
 
@@ -140,6 +175,9 @@ Mac::Mac(unsigned short dev, unsigned short sap)
 	macAddress = defaultOUI + (dev * 0x10000) + sap;
 	macId.dev = dev;
 	macId.sap = sap;
+	txFramesPerTick = 0;
+	txOctetsPerTick = 0;
+	txOctetCredit = 0;
 //	std::cout << "Mac Constructor called:  device = " << macId.dev << "  sapId = " << macId.sap << std::endl;
 }
 
@@ -175,6 +213,8 @@ void Mac::Request(unique_ptr<Frame> pFrameIn)
 	pFrameIn->TimeStamp = SimLog::Time;   // Use frame time stamp to measure residence time in queue
 	if (getOperational() && !suspended)
 		requests.push(std::move(pFrameIn));  // A request sent to a non-operational ISS will be discarded.
+	else
+		framesDiscarded.increment();
 }
 
 unique_ptr<Frame> Mac::Indication()
@@ -184,6 +224,7 @@ unique_ptr<Frame> Mac::Indication()
 	{
 		unique_ptr<Frame> pFrame = std::move(indications.front());
 		indications.pop();
+		framesRx.increment();
 		return (std::move(pFrame));
 	}
 	else {
@@ -239,12 +280,54 @@ unsigned long Mac::getMacId() const
 	return macId.id;
 }
 
+void Mac::setBandwidth(unsigned int framesPerTick, unsigned int octetsPerTick)
+{
+	txFramesPerTick = framesPerTick;
+	txOctetsPerTick = octetsPerTick;
+	txOctetCredit = 0;
+}
+
+unsigned int Mac::getFramesPerTick() const
+{
+	return (txFramesPerTick);
+}
+
+unsigned int Mac::getOctetsPerTick() const
+{
+	return (txOctetsPerTick);
+}
+
+unsigned long long Mac::getFramesTx() const
+{
+	return (framesTx.get());
+}
+
+unsigned long long Mac::getFramesRx() const
+{
+	return (framesRx.get());
+}
+
+unsigned long long Mac::getFramesDiscarded() const
+{
+	return (framesDiscarded.get());
+}
+
+void Mac::clearStatistics()
+{
+	framesTx.clear();
+	framesRx.clear();
+	framesDiscarded.clear();
+	requests.clearStatistics();
+	indications.clearStatistics();
+}
+
 void Mac::reset()
 {
 	while (!requests.empty())        // Flush all frames in flight
 		requests.pop();
 	while (!indications.empty())     // Flush all frames already delivered 
 		indications.pop();
+	txOctetCredit = 0;
 }
 
 void Mac::timerTick()
@@ -264,27 +347,87 @@ void Mac::run(bool singleStep)
 }
 
 
+int Mac::nextWakeup() const
+{
+	int wakeup = SimLog::Never;
+
+	if (!suspended)
+	{
+		if (!indications.empty())                           // A delivered frame is waiting for the client
+			wakeup = SimLog::Time;
+		else if (!requests.empty())                         // A frame is in flight
+		{
+			if (getOperational())                           //    so wake up when the link delay has elapsed
+			{
+				wakeup = std::max(SimLog::Time, (requests.front())->TimeStamp + linkDelay);
+				unsigned short length = (requests.front())->getLength();
+				if (txOctetsPerTick && (txOctetCredit < length))  //    and enough credit has accumulated to send it
+				{
+					int creditTicks = (int)((length - txOctetCredit + txOctetsPerTick - 1) / txOctetsPerTick);
+					wakeup += creditTicks - 1;
+				}
+			}
+			else                                            //    or right away if Transmit will flush it
+				wakeup = SimLog::Time;
+		}
+	}
+	return (wakeup);
+}
+
+void Mac::skipTicks(int ticks)
+{
+	if (txOctetsPerTick && !requests.empty() && !suspended && getOperational())
+	{
+		int eligible = (requests.front())->TimeStamp + linkDelay;     // Credit accumulates only once the front frame could be sent
+		int creditTicks = std::min(ticks, SimLog::Time + ticks - eligible);
+		if (creditTicks > 0)
+			txOctetCredit += (unsigned long)creditTicks * txOctetsPerTick;
+	}
+}
+
 void Mac::Transmit()
 {
 	if (!requests.empty() && !suspended)
 	{
 		if (getOperational())
 		{
-			unsigned short txTime = (requests.front())->TimeStamp;
-			if (SimLog::Time >= (txTime + linkDelay))
+			unsigned int framesSent = 0;
+			if (SimLog::Time >= ((requests.front())->TimeStamp + linkDelay))
+				txOctetCredit += txOctetsPerTick;
+			while (!requests.empty() && ((txFramesPerTick == 0) || (framesSent < txFramesPerTick)) &&
+				(SimLog::Time >= ((requests.front())->TimeStamp + linkDelay)))
 			{
+				if (txOctetsPerTick)
+				{
+					unsigned short length = (requests.front())->getLength();
+					if (txOctetCredit < length)
+						break;                                                  // wait for more credit
+					txOctetCredit -= length;
+				}
 				unique_ptr<Frame> pTempFrame = std::move(requests.front());     // move the pointer to the frame from the requests queue to the temp variable
 				requests.pop();                                                 // pop the null pointer left on the queue after the move
+				framesSent++;
 				if (linkPartner && linkPartner->enabled && !(linkPartner->suspended))
 				{
 					linkPartner->indications.push(std::move(pTempFrame));       // push the pointer to the frame onto the other MAC indications queue
+					framesTx.increment();
+				}
+				else
+				{
+					framesDiscarded.increment();
 				}
 			}
+			if (requests.empty())
+				txOctetCredit = 0;                                              // an idle link does not save up credit for a later burst
 		}
 		else  // can get here if this Mac or its Partner were disabled without disconnecting
 		{
 			while (!requests.empty())        // Flush all frames in flight
+			{
 				requests.pop();
+				framesDiscarded.increment();
+			}
+			txOctetCredit = 0;
 //			while (!indications.empty())     // Flush all frames already delivered (is this desirable?)
 //				indications.pop();
 		}
@@ -297,12 +440,14 @@ void Mac::Connect(shared_ptr<Mac> macA, shared_ptr<Mac> macB, unsigned short del
 	if (macA->linkPartner) Disconnect(macA);
 	if (macB->linkPartner) Disconnect(macB);
 
-	if (SimLog::Debug > 0) SimLog::logFile << endl << "Time " << SimLog::Time << ":    ***** Connecting  "
-		<< hex << "  MAC " << macA->macId.dev << ":" << macA->macId.sap << " to MAC "
-		<< macB->macId.dev << ":" << macB->macId.sap << " *****" << dec << endl;
-	cout << endl << "Time " << SimLog::Time << ":    ***** Connecting  " 
+	if (SimLog::debug<0>()) SimLog::logFile << endl << "Time " << SimLog::Time << ":    ***** Connecting  "
 		<< hex << "  MAC " << macA->macId.dev << ":" << macA->macId.sap << " to MAC "
 		<< macB->macId.dev << ":" << macB->macId.sap << " *****" << dec << endl;
+	if (ConsoleReport::lineByLine)
+		SimLog::console << endl << "Time " << SimLog::Time << ":    ***** Connecting  " 
+			<< hex << "  MAC " << macA->macId.dev << ":" << macA->macId.sap << " to MAC "
+			<< macB->macId.dev << ":" << macB->macId.sap << " *****" << dec << endl;
+	ConsoleReport::count(ConsoleReport::LINK_CONNECT);
 
 	macA->linkPartner = macB;
 	macB->linkPartner = macA;
@@ -314,23 +459,31 @@ void Mac::Disconnect(shared_ptr<Mac> macA)
 {
 	if (macA->linkPartner)
 	{
-		if (SimLog::Debug > 0) SimLog::logFile << endl << "Time " << SimLog::Time << ":    ***** Disconnecting  "
-			<< hex << "  MAC " << macA->macId.dev << ":" << macA->macId.sap << " to MAC "
-			<< macA->linkPartner->macId.dev << ":" << macA->linkPartner->macId.sap << " *****" << dec << endl;
-		cout << endl << "Time " << SimLog::Time << ":    ***** Disconnecting  "
+		if (SimLog::debug<0>()) SimLog::logFile << endl << "Time " << SimLog::Time << ":    ***** Disconnecting  "
 			<< hex << "  MAC " << macA->macId.dev << ":" << macA->macId.sap << " to MAC "
 			<< macA->linkPartner->macId.dev << ":" << macA->linkPartner->macId.sap << " *****" << dec << endl;
+		if (ConsoleReport::lineByLine)
+			SimLog::console << endl << "Time " << SimLog::Time << ":    ***** Disconnecting  "
+				<< hex << "  MAC " << macA->macId.dev << ":" << macA->macId.sap << " to MAC "
+				<< macA->linkPartner->macId.dev << ":" << macA->linkPartner->macId.sap << " *****" << dec << endl;
+		ConsoleReport::count(ConsoleReport::LINK_DISCONNECT);
 
 		if (macA->linkPartner->linkPartner == macA)    // if Partner's Partner is this Mac
 		{
 			while (!(macA->linkPartner->requests.empty()))        // Flush all Partner's frames in flight
+			{
 				macA->linkPartner->requests.pop();
+				macA->linkPartner->framesDiscarded.increment();
+			}
 //			while (!(macA->linkPartner->indications.empty()))     // Flush all frames already delivered to Partner (is this desirable?)
 //				macA->linkPartner->indications.pop();
 			macA->linkPartner->linkPartner = nullptr;             // then clear linkPartner's link
 		}
 		while (!(macA->requests.empty()))        // Flush all frames in flight
+		{
 			macA->requests.pop();
+			macA->framesDiscarded.increment();
+		}
 //		while (!(macA->indications.empty()))     // Flush all frames already delivered (is this desirable?)
 //			macA->indications.pop();
 		macA->linkPartner = nullptr;             // clear this Mac's link
@@ -16,6 +16,8 @@ limitations under the License.
 
 #pragma once
 #include "Frame.h"
+#include "FrameQueue.h"
+#include "Metrics.h"
 // #include "queue.h"
 
 
@@ -72,9 +74,14 @@ public:
 	virtual void Request(unique_ptr<Frame> pFrameIn) override;
 	virtual unique_ptr<Frame> Indication() override;
 
+	void setQueueDepth(size_t depth);             // Capacity of request and indication queues;  discards any queued frames
+	size_t getQueueDepth() const;
+	const FrameQueue& getRequestQueue() const;    // Access to queue statistics (drops, high water mark)
+	const FrameQueue& getIndicationQueue() const;
+
 protected:         
-	std::queue<unique_ptr<Frame>> requests;     
-	std::queue<unique_ptr<Frame>> indications;
+	FrameQueue requests;     
+	FrameQueue indications;
 };
 
 
@@ -110,6 +117,11 @@ public:
 	virtual void timerTick() = 0;              // Decrements any timers associated with this component (when not suspended).
 	virtual void run(bool singleStep) = 0;     // Executes operational methods of the component (when not suspended).
 
+	// Event scheduling:  allows the simulation to skip ticks in which no component has anything to do.
+	virtual int nextWakeup() const;            // Earliest Time at which timerTick() and run() may change more than a timer count.
+	                                           //     Default is the current Time, i.e. a component that cannot predict must run every tick.
+	virtual void skipTicks(int ticks);         // Advances timers as if timerTick() was called "ticks" times with nothing to run.
+
 protected:
 	ComponentTypes type;      // Read-only by the simulation;  set by the constructor
 	bool suspended;           // Read-write by the simulation;  inhibits timerTick() and run() operations
@@ -126,6 +138,10 @@ protected:
 *      Frames across those Links.  Per the IEEE 802 Client/Service model, a service request from a client at the SAP
 *      of one MAC results in a service indication (with identical parameters) provided to the client at the SAP of the
 *      connected MAC after a Link specific time delay.
+*   Each call to Transmit (once per tick) sends every queued frame whose link delay has elapsed, up to the transmit
+*      bandwidth of the Mac:  a maximum number of frames per tick and/or octets per tick (zero means unlimited, the default).
+*      With an octet limit, a frame longer than one tick's worth of octets waits for enough credit to accumulate, which
+*      models the serialization delay of the link.  Credit does not accumulate while there is nothing to transmit.
 *   The Mac class inherits both an enabled (from IssQ) and suspended (from Component) variable.  
 *      A Mac will not transmit or receive while suspended (however it may continue to receive when in a suspended Device).
 *          Being suspended does not automatically make a Mac non-operational.
@@ -153,10 +169,19 @@ public:
 	virtual unsigned short getDevNum() const;             // Identifies the Device containing this MAC
 	virtual unsigned long getMacId() const;               // Union of the Device Number and SAP Identifier
 	virtual void updateMacSystemId(unsigned long long value);
+	void setBandwidth(unsigned int framesPerTick, unsigned int octetsPerTick = 0);   // Transmit limits (0 is unlimited)
+	unsigned int getFramesPerTick() const;
+	unsigned int getOctetsPerTick() const;
+	unsigned long long getFramesTx() const;               // Frames sent across the link
+	unsigned long long getFramesRx() const;               // Frames passed to the client
+	unsigned long long getFramesDiscarded() const;        // Requests discarded because the Mac or link was not operational
+	void clearStatistics();                               // Also clears the queue statistics
 
 	virtual void reset() override;
 	virtual void timerTick() override;
 	virtual void run(bool singleStep) override;
+	virtual int nextWakeup() const override;
+	virtual void skipTicks(int ticks) override;
 
 	virtual void Transmit();       
 	  
@@ -169,5 +194,13 @@ protected:
 
 	shared_ptr<Mac> linkPartner;
 	unsigned short linkDelay;
+
+	unsigned int txFramesPerTick;
+	unsigned int txOctetsPerTick;
+	unsigned long txOctetCredit;                // Octets that may be sent before the next frame has to wait
+
+	StatCounter framesTx;
+	StatCounter framesRx;
+	StatCounter framesDiscarded;
 };
 
@@ -0,0 +1,177 @@
+/*
+Copyright 2017 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include "stdafx.h"
+#include "Metrics.h"
+#include "Device.h"
+
+
+StatCounter::StatCounter()
+	: count(0)
+{
+}
+
+StatCounter::~StatCounter()
+{
+}
+
+void StatCounter::increment()
+{
+	count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+void StatCounter::add(unsigned long long n)
+{
+	count.store(count.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+unsigned long long StatCounter::get() const
+{
+	return (count.load(std::memory_order_relaxed));
+}
+
+void StatCounter::clear()
+{
+	count.store(0, std::memory_order_relaxed);
+}
+
+/**/
+
+Metrics::Metrics()
+{
+}
+
+Metrics::~Metrics()
+{
+}
+
+std::vector<Metrics::Sample> Metrics::collect(const std::vector<unique_ptr<Device>>& Devices)
+{
+	std::vector<Sample> samples;
+
+	for (auto& pDev : Devices)
+	{
+		unsigned short dev = pDev->getDeviceNumber();
+
+		for (auto& pMac : pDev->pMacs)
+		{
+			unsigned short id = pMac->getSapId();
+			samples.push_back({ dev, "Mac", id, "framesTx", pMac->getFramesTx() });
+			samples.push_back({ dev, "Mac", id, "framesRx", pMac->getFramesRx() });
+			samples.push_back({ dev, "Mac", id, "framesDiscarded", pMac->getFramesDiscarded() });
+			samples.push_back({ dev, "Mac", id, "requestQueueDrops", pMac->getRequestQueue().getDrops() });
+			samples.push_back({ dev, "Mac", id, "requestQueueHighWater", pMac->getRequestQueue().getHighWater() });
+			samples.push_back({ dev, "Mac", id, "indicationQueueDrops", pMac->getIndicationQueue().getDrops() });
+			samples.push_back({ dev, "Mac", id, "indicationQueueHighWater", pMac->getIndicationQueue().getHighWater() });
+		}
+
+		for (auto& pComp : pDev->pComponents)
+		{
+			switch (pComp->getCompType())
+			{
+			case LINK_AGG:
+			{
+				LinkAgg& lag = (LinkAgg&)*pComp;
+				for (auto& pAgg : lag.pAggregators)
+				{
+					unsigned short id = pAgg->get_aAggID();
+					samples.push_back({ dev, "Aggregator", id, "aAggFramesTxOK", pAgg->get_aAggFramesTxOK() });
+					samples.push_back({ dev, "Aggregator", id, "aAggFramesRxOK", pAgg->get_aAggFramesRxOK() });
+					samples.push_back({ dev, "Aggregator", id, "aAggFramesDiscardedOnTx", pAgg->get_aAggFramesDiscardedOnTx() });
+					samples.push_back({ dev, "Aggregator", id, "aAggFramesDiscardedOnRx", pAgg->get_aAggFramesDiscardedOnRx() });
+				}
+				for (auto& pPort : lag.pAggPorts)
+				{
+					unsigned short id = pPort->get_aAggPortID();
+					samples.push_back({ dev, "AggPort", id, "aAggPortStatsLACPDUsTx", pPort->get_aAggPortStatsLACPDUsTx() });
+					samples.push_back({ dev, "AggPort", id, "aAggPortStatsLACPDUsRx", pPort->get_aAggPortStatsLACPDUsRx() });
+					samples.push_back({ dev, "AggPort", id, "stateMachineTransitions", pPort->get_stateMachineTransitions() });
+				}
+				break;
+			}
+			case END_STATION:
+				samples.push_back({ dev, "EndStn", 0, "framesRx", ((EndStn&)*pComp).rxFrameCount });
+				break;
+			case BRIDGE:
+				samples.push_back({ dev, "Bridge", 0, "loopDiscards", ((Bridge&)*pComp).loopDiscards });
+				break;
+			default:
+				break;
+			}
+		}
+	}
+
+	return (samples);
+}
+
+void Metrics::writeCsv(const std::vector<unique_ptr<Device>>& Devices, std::ostream& out)
+{
+	out << "Time,Device,Object,Id,Counter,Value" << endl;
+	for (auto& sample : collect(Devices))
+	{
+		out << SimLog::Time << "," << sample.device << "," << sample.object << "," << sample.id << ","
+			<< sample.counter << "," << sample.value << "\n";
+	}
+	out.flush();
+}
+
+void Metrics::writeJson(const std::vector<unique_ptr<Device>>& Devices, std::ostream& out)
+{
+	std::vector<Sample> samples = collect(Devices);
+
+	out << "{\"time\": " << SimLog::Time << ", \"counters\": [";
+	for (size_t i = 0; i < samples.size(); i++)
+	{
+		Sample& sample = samples[i];
+		out << ((i == 0) ? "\n  " : ",\n  ") << "{\"device\": " << sample.device << ", \"object\": \"" << sample.object
+			<< "\", \"id\": " << sample.id << ", \"counter\": \"" << sample.counter << "\", \"value\": " << sample.value << "}";
+	}
+	out << "\n]}" << endl;
+}
+
+void Metrics::clear(const std::vector<unique_ptr<Device>>& Devices)
+{
+	for (auto& pDev : Devices)
+	{
+		for (auto& pMac : pDev->pMacs)
+			pMac->clearStatistics();
+
+		for (auto& pComp : pDev->pComponents)
+		{
+			switch (pComp->getCompType())
+			{
+			case LINK_AGG:
+			{
+				LinkAgg& lag = (LinkAgg&)*pComp;
+				for (auto& pAgg : lag.pAggregators)
+					pAgg->clearStatistics();
+				for (auto& pPort : lag.pAggPorts)
+					pPort->clearStatistics();
+				break;
+			}
+			case END_STATION:
+				((EndStn&)*pComp).rxFrameCount = 0;
+				break;
+			case BRIDGE:
+				((Bridge&)*pComp).loopDiscards = 0;
+				break;
+			default:
+				break;
+			}
+		}
+	}
+}
@@ -0,0 +1,86 @@
+/*
+Copyright 2017 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#pragma once
+#include <atomic>
+#include <vector>
+
+class Device;
+
+
+/*
+*   Class StatCounter is a statistics counter that can be read from any thread while it is being counted.
+*       Each counter is written by only one thread at a time (the thread running the Device that owns it), so
+*       counting is a relaxed load and store rather than an atomic read-modify-write, and costs no more than
+*       incrementing an ordinary variable.
+*/
+/**/
+class StatCounter
+{
+public:
+	StatCounter();
+	~StatCounter();
+	StatCounter(StatCounter& copySource) = delete;             // Disable copy constructor
+	StatCounter& operator= (const StatCounter&) = delete;      // Disable assignment operator
+
+	void increment();
+	void add(unsigned long long n);
+	unsigned long long get() const;
+	void clear();
+
+private:
+	std::atomic<unsigned long long> count;
+};
+/**/
+
+
+/*
+*   Class Metrics takes a snapshot of the statistics counters of every Device in a simulation and writes it as CSV
+*       (one line per counter:  Time, Device, object, identifier, counter name, value) or as JSON (the same values as
+*       an array of objects).  The counters included are:
+*       -- Mac:  frames transmitted, received, and discarded, and the drops and high water mark of each queue.
+*       -- Aggregator:  the aAgg statistics for frames transmitted, received, and discarded on transmit and receive.
+*       -- Aggregation Port:  LACPDUs transmitted and received, and state machine transitions.
+*       -- End Station frames received, and Bridge frames discarded by the loop guard.
+*   A snapshot should be taken between ticks (e.g. between calls to SimulationEngine::runUntil), when no Device is running.
+*/
+/**/
+class Metrics
+{
+public:
+	Metrics();
+	~Metrics();
+	Metrics(Metrics& copySource) = delete;             // Disable copy constructor
+	Metrics& operator= (const Metrics&) = delete;      // Disable assignment operator
+
+	static void writeCsv(const std::vector<unique_ptr<Device>>& Devices, std::ostream& out);
+	static void writeJson(const std::vector<unique_ptr<Device>>& Devices, std::ostream& out);
+	static void clear(const std::vector<unique_ptr<Device>>& Devices);   // Zero all the statistics counters
+
+private:
+	struct Sample
+	{
+		unsigned short device;
+		const char* object;
+		unsigned short id;
+		const char* counter;
+		unsigned long long value;
+	};
+
+	static std::vector<Sample> collect(const std::vector<unique_ptr<Device>>& Devices);
+};
+/**/
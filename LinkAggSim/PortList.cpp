@@ -0,0 +1,95 @@
+/*
+Copyright 2017 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include "stdafx.h"
+#include "PortList.h"
+
+
+void PortList::push_back(unsigned short val)
+{
+	size_t word = val / 64;
+	if (word >= members.size())
+		members.resize(word + 1, 0);
+	members[word] |= (1ULL << (val % 64));
+	values.push_back(val);
+}
+
+void PortList::remove(unsigned short val)
+{
+	if (contains(val))
+	{
+		values.erase(std::remove(values.begin(), values.end(), val), values.end());
+		members[val / 64] &= ~(1ULL << (val % 64));
+	}
+}
+
+bool PortList::contains(unsigned short val) const
+{
+	size_t word = val / 64;
+	return ((word < members.size()) && ((members[word] >> (val % 64)) & 1));
+}
+
+void PortList::sort()
+{
+	std::sort(values.begin(), values.end());
+}
+
+void PortList::clear()
+{
+	values.clear();
+	std::fill(members.begin(), members.end(), 0);
+}
+
+bool PortList::empty() const
+{
+	return (values.empty());
+}
+
+size_t PortList::size() const
+{
+	return (values.size());
+}
+
+unsigned short PortList::front() const
+{
+	return (values.front());
+}
+
+unsigned short PortList::back() const
+{
+	return (values.back());
+}
+
+PortList::const_iterator PortList::begin() const
+{
+	return (values.begin());
+}
+
+PortList::const_iterator PortList::end() const
+{
+	return (values.end());
+}
+
+bool PortList::operator== (const PortList& other) const
+{
+	return (values == other.values);
+}
+
+bool PortList::operator!= (const PortList& other) const
+{
+	return (values != other.values);
+}
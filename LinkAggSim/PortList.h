@@ -0,0 +1,53 @@
+/*
+Copyright 2017 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#pragma once
+#include <vector>
+
+
+/*
+*   Class PortList is a list of small unsigned values (Aggregation Port indexes, Aggregator identifiers, Link Numbers) 
+*       used for the port and link lists of an Aggregator.  It keeps the values in a contiguous vector in the order 
+*       they were added (or sorted), and a bitmap of the values on the list so testing membership is a single bit test.
+*   Like the std::list it replaces, a value can be on the list more than once and remove() deletes every copy.
+*       The bitmap grows to fit the largest value ever added.
+*/
+/**/
+class PortList
+{
+public:
+	typedef std::vector<unsigned short>::const_iterator const_iterator;
+
+	void push_back(unsigned short val);
+	void remove(unsigned short val);             // Remove all copies of val
+	bool contains(unsigned short val) const;
+	void sort();                                 // Put values in ascending order
+	void clear();
+	bool empty() const;
+	size_t size() const;
+	unsigned short front() const;                // List must not be empty
+	unsigned short back() const;
+	const_iterator begin() const;
+	const_iterator end() const;
+	bool operator== (const PortList& other) const;   // Same values in the same order
+	bool operator!= (const PortList& other) const;
+
+private:
+	std::vector<unsigned short> values;
+	std::vector<unsigned long long> members;     // Bit set for each value on the list
+};
+/**/
@@ -0,0 +1,102 @@
+/*
+Copyright 2017 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "stdafx.h"
+#include "SimulationEngine.h"
+#include "ConsoleReport.h"
+
+
+SimulationEngine::SimulationEngine()
+	: skipIdle(true),
+	eventCount(0)
+{
+}
+
+SimulationEngine::~SimulationEngine()
+{
+	Devices.clear();
+}
+
+void SimulationEngine::at(int time, std::function<void()> action)
+{
+	ScheduledEvent event;
+	event.time = time;
+	event.sequence = eventCount++;
+	event.action = move(action);
+	events.push(move(event));
+}
+
+void SimulationEngine::connect(int time, shared_ptr<Mac> macA, shared_ptr<Mac> macB, unsigned short delay)
+{
+	at(time, [macA, macB, delay]() { Mac::Connect(macA, macB, delay); });
+}
+
+void SimulationEngine::disconnect(int time, shared_ptr<Mac> mac)
+{
+	at(time, [mac]() { Mac::Disconnect(mac); });
+}
+
+void SimulationEngine::disconnectAll(int time)
+{
+	at(time, [this]()
+	{
+		for (auto& pDev : Devices)
+		{
+			pDev->disconnect();      // Disconnect all remaining links on all devices
+		}
+	});
+}
+
+int SimulationEngine::nextEventTime() const
+{
+	if (events.empty())
+		return (SimLog::Never);
+	return (events.top().time);
+}
+
+void SimulationEngine::step()
+{
+	while (!events.empty() && (events.top().time <= SimLog::Time))
+	{
+		std::function<void()> action = events.top().action;
+		events.pop();                                 // Pop first, since the action may schedule more actions
+		ConsoleReport::flushBuffer();                 // Keep console messages ahead of anything the action writes to cout
+		action();
+	}
+
+	//  Run all state machines in all devices, then transmit from any MAC with frames to transmit
+	Device::tick(Devices);
+	ConsoleReport::update();
+
+	if (SimLog::debug<1>())
+		SimLog::logFile << "*" << endl;
+	SimLog::Time++;
+}
+
+void SimulationEngine::runUntil(int endTime)
+{
+	while (SimLog::Time < endTime)
+	{
+		if (skipIdle && !SimLog::debug<8>())          // Above Debug 8 the log records state every tick, so run them all
+		{
+			Device::skipIdleTicks(Devices, std::min(nextEventTime(), endTime));
+			if (SimLog::Time >= endTime)
+				break;
+		}
+		step();
+	}
+	ConsoleReport::flush();
+}
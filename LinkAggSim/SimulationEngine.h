@@ -0,0 +1,79 @@
+/*
+Copyright 2017 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+#include <functional>
+#include "Device.h"
+#include "Mac.h"
+
+
+/*
+*   Class SimulationEngine owns the Devices of a simulation and runs the main simulation loop.
+*       Actions that change the network (connecting or disconnecting links, enabling or disabling a Mac or Aggregator,
+*       writing administrative variables, ...) are scheduled for a given Time and kept in a time-ordered event queue,
+*       rather than being tested for on every tick.  Actions scheduled for the same Time run in the order they were scheduled.
+*   Each step() runs the actions due at the current Time, then one tick of all Devices (timerTick, run, transmit),
+*       then increments Time.
+*   runUntil() steps until Time reaches the given end time.  When skipIdle is true it jumps over any ticks in which no
+*       Device has anything to do, but never past the next scheduled action (see Device::skipIdleTicks).
+*       Ticks are never skipped when SimLog::Debug is above 8, since those levels log port state and Selection Logic
+*       results on every tick and the log should not depend on skipIdle.
+*       Console reporting is brought up to date each step, and flushed when runUntil() returns (see ConsoleReport).
+*/
+/**/
+class SimulationEngine
+{
+public:
+	SimulationEngine();
+	~SimulationEngine();
+	SimulationEngine(SimulationEngine& copySource) = delete;             // Disable copy constructor
+	SimulationEngine& operator= (const SimulationEngine&) = delete;      // Disable assignment operator
+
+	std::vector<unique_ptr<Device>> Devices;     // All Devices in the simulation
+	bool skipIdle;                               // If true, runUntil() skips ticks in which no Device has anything to do
+
+	void at(int time, std::function<void()> action);                     // Schedule an action for the start of Time "time"
+	void connect(int time, shared_ptr<Mac> macA, shared_ptr<Mac> macB, unsigned short delay);   // Schedule Mac::Connect
+	void disconnect(int time, shared_ptr<Mac> mac);                      // Schedule Mac::Disconnect
+	void disconnectAll(int time);                                        // Schedule disconnect of all Macs in all Devices
+	template <class T> void setEnabled(int time, shared_ptr<T> pObj, bool val)   // Schedule setEnabled on a Mac, Aggregator, ...
+	{
+		at(time, [pObj, val]() { pObj->setEnabled(val); });
+	}
+
+	int nextEventTime() const;                   // Time of the earliest scheduled action (SimLog::Never if none)
+	void step();                                 // Run actions scheduled for the current Time, tick all Devices, increment Time
+	void runUntil(int endTime);                  // Step until Time reaches endTime
+
+private:
+	struct ScheduledEvent
+	{
+		int time;
+		unsigned long sequence;                  // Order in which scheduled, so simultaneous actions run in that order
+		std::function<void()> action;
+	};
+	struct LaterEvent
+	{
+		bool operator()(const ScheduledEvent& a, const ScheduledEvent& b) const
+		{
+			return ((a.time > b.time) || ((a.time == b.time) && (a.sequence > b.sequence)));
+		}
+	};
+
+	std::priority_queue<ScheduledEvent, std::vector<ScheduledEvent>, LaterEvent> events;
+	unsigned long eventCount;
+};
+/**/
@@ -0,0 +1,104 @@
+/*
+Copyright 2017 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "stdafx.h"
+#include "ThreadPool.h"
+
+
+ThreadPool::ThreadPool(unsigned int nThreads)
+	: pTask(nullptr),
+	taskCount(0),
+	nextTask(0),
+	busyWorkers(0),
+	generation(0),
+	shutdown(false)
+{
+	for (unsigned int i = 1; i < nThreads; i++)      // The calling thread is the first thread of the pool
+		workers.push_back(std::thread(&ThreadPool::workerLoop, this));
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		shutdown = true;
+	}
+	startWork.notify_all();
+	for (auto& worker : workers)
+		worker.join();
+}
+
+unsigned int ThreadPool::getThreadCount() const
+{
+	return (workers.size() + 1);
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& task)
+{
+	if (workers.empty() || (count < 2))             // Nothing to gain from handing work to other threads
+	{
+		for (size_t i = 0; i < count; i++)
+			task(i);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		pTask = &task;
+		taskCount = count;
+		nextTask = 0;
+		busyWorkers = workers.size();
+		generation++;
+	}
+	startWork.notify_all();
+
+	runTasks();                                     // Calling thread claims tasks along with the workers
+
+	std::unique_lock<std::mutex> guard(lock);       // Barrier:  wait until every worker has run out of tasks
+	workDone.wait(guard, [this] { return (busyWorkers == 0); });
+	pTask = nullptr;
+}
+
+void ThreadPool::workerLoop()
+{
+	unsigned long lastGeneration = 0;
+
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> guard(lock);
+			startWork.wait(guard, [this, lastGeneration] { return (shutdown || (generation != lastGeneration)); });
+			if (shutdown)
+				return;
+			lastGeneration = generation;
+		}
+
+		runTasks();
+
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			busyWorkers--;
+			if (busyWorkers == 0)
+				workDone.notify_one();
+		}
+	}
+}
+
+void ThreadPool::runTasks()
+{
+	for (size_t i = nextTask++; i < taskCount; i = nextTask++)
+		(*pTask)(i);
+}
@@ -0,0 +1,61 @@
+/*
+Copyright 2017 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <vector>
+
+
+/*
+*   Class ThreadPool is a fixed set of worker threads used to run one phase of a simulation tick (e.g. run or transmit)
+*       on many Devices at once.
+*       parallelFor(count, task) calls task(0) through task(count - 1), with each index claimed by exactly one thread,
+*       and returns only when all of them have completed.  That return is the barrier between simulation phases.
+*       The calling thread works alongside the workers, so a pool of one thread has no workers and runs everything in order.
+*       The pool does nothing to make the tasks deterministic; that is up to the caller (see Device::tick).
+*/
+/**/
+class ThreadPool
+{
+public:
+	ThreadPool(unsigned int nThreads);          // Total threads including the calling thread
+	~ThreadPool();
+	ThreadPool(ThreadPool& copySource) = delete;             // Disable copy constructor
+	ThreadPool& operator= (const ThreadPool&) = delete;      // Disable assignment operator
+
+	unsigned int getThreadCount() const;
+	void parallelFor(size_t count, const std::function<void(size_t)>& task);
+
+private:
+	void workerLoop();
+	void runTasks();
+
+	std::vector<std::thread> workers;
+	std::mutex lock;
+	std::condition_variable startWork;
+	std::condition_variable workDone;
+	const std::function<void(size_t)>* pTask;
+	size_t taskCount;
+	std::atomic<size_t> nextTask;
+	unsigned int busyWorkers;
+	unsigned long generation;                   // Incremented each time work is handed to the workers
+	bool shutdown;
+};
+/**/
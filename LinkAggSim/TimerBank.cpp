@@ -0,0 +1,126 @@
+/*
+Copyright 2017 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include "stdafx.h"
+#include "TimerBank.h"
+
+
+TimerBank::TimerBank(int nTimers)
+	: timers(nTimers)
+{
+}
+
+TimerBank::~TimerBank()
+{
+}
+
+unsigned short TimerBank::addSlot()
+{
+	for (auto& timerArray : timers)
+		timerArray.push_back(0);
+	return ((unsigned short)(timers[0].size() - 1));
+}
+
+int& TimerBank::timer(int id, unsigned short index)
+{
+	return (timers[id][index]);
+}
+
+void TimerBank::timerTick()
+{
+	for (auto& timerArray : timers)
+	{
+		int* pTimer = timerArray.data();
+		size_t n = timerArray.size();
+		for (size_t i = 0; i < n; i++)
+			pTimer[i] -= (pTimer[i] > 0);       // Branch-free so the loop vectorizes
+	}
+}
+
+void TimerBank::skipTicks(int ticks)
+{
+	for (auto& timerArray : timers)
+	{
+		for (auto& t : timerArray)
+			t = std::max(0, t - ticks);
+	}
+}
+
+int TimerBank::nextWakeup() const
+{
+	int wakeup = SimLog::Never;
+
+	for (auto& timerArray : timers)
+	{
+		for (int t : timerArray)
+		{
+			if (t > 0)                                          // A timer at value n reaches zero n-1 ticks from now,
+				wakeup = std::min(wakeup, SimLog::Time + t - 1);  //    since timerTick() precedes run() in every tick
+		}
+	}
+	return (wakeup);
+}
+
+size_t TimerBank::size() const
+{
+	return (timers.empty() ? 0 : timers[0].size());
+}
+
+void TimerBank::moveSlot(Slot& slot, std::shared_ptr<TimerBank> pNewBank)
+{
+	unsigned short newIndex = pNewBank->addSlot();
+	for (size_t id = 0; id < pNewBank->timers.size(); id++)
+	{
+		pNewBank->timers[id][newIndex] = slot.pBank->timers[id][slot.index];
+	}
+	slot.pBank = pNewBank;
+	slot.index = newIndex;
+}
+
+
+BankTimer::BankTimer(TimerBank::Slot& slot, int id)
+	: slot(slot), id(id)
+{
+}
+
+BankTimer::operator int() const
+{
+	return (slot.pBank->timer(id, slot.index));
+}
+
+BankTimer& BankTimer::operator= (int val)
+{
+	slot.pBank->timer(id, slot.index) = val;
+	return (*this);
+}
+
+BankTimer& BankTimer::operator= (const BankTimer& other)
+{
+	slot.pBank->timer(id, slot.index) = (int)other;
+	return (*this);
+}
+
+BankTimer& BankTimer::operator-- ()
+{
+	slot.pBank->timer(id, slot.index)--;
+	return (*this);
+}
+
+int BankTimer::operator-- (int)
+{
+	return (slot.pBank->timer(id, slot.index)--);
+}
@@ -0,0 +1,80 @@
+/*
+Copyright 2017 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#pragma once
+#include <vector>
+#include <memory>
+
+
+/*
+*   Class TimerBank holds the state machine timers of a set of ports as a structure of arrays:  one contiguous array 
+*       for each kind of timer, indexed by the port's slot number.  A timer tick decrements every running timer of every
+*       port with one simple loop per array (which the compiler can vectorize), without touching the rest of the port.
+*   A port owns a TimerBank::Slot, which identifies its bank and slot, and accesses each timer through a BankTimer.
+*       A port starts with a private bank of its own, and its timers can be moved to a shared bank with moveSlot.
+*   A timer with value n > 0 reaches zero after n ticks.  Timers stop at zero.
+*/
+/**/
+class TimerBank
+{
+public:
+	TimerBank(int nTimers);
+	~TimerBank();
+	TimerBank(TimerBank& copySource) = delete;             // Disable copy constructor
+	TimerBank& operator= (const TimerBank&) = delete;      // Disable assignment operator
+
+	struct Slot
+	{
+		std::shared_ptr<TimerBank> pBank;
+		unsigned short index;
+	};
+
+	unsigned short addSlot();                    // Returns index of a new slot with all timers zero
+	int& timer(int id, unsigned short index);
+	void timerTick();                            // Decrement every running timer
+	void skipTicks(int ticks);                   // Same result as calling timerTick() "ticks" times
+	int nextWakeup() const;                      // Time of the last tick before the first running timer expires
+	size_t size() const;                         // Number of slots
+
+	static void moveSlot(Slot& slot, std::shared_ptr<TimerBank> pNewBank);   // Move a port's timers to another bank
+
+private:
+	std::vector<std::vector<int>> timers;        // timers[id][index]
+};
+
+
+/*
+*   Class BankTimer is a reference to one timer of a port in a TimerBank.  It can be used like an int variable
+*       (assigned, compared, decremented) by the state machines.
+*/
+class BankTimer
+{
+public:
+	BankTimer(TimerBank::Slot& slot, int id);
+	BankTimer(const BankTimer& copySource) = delete;   // Disable copy constructor (a copy would refer to the same timer)
+
+	operator int() const;
+	BankTimer& operator= (int val);
+	BankTimer& operator= (const BankTimer& other);     // Copies the value, not the reference
+	BankTimer& operator-- ();
+	int operator-- (int);
+
+private:
+	TimerBank::Slot& slot;
+	int id;
+};
+/**/
@@ -0,0 +1,239 @@
+/*
+Copyright 2017 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include "stdafx.h"
+#include "Trace.h"
+#include "AggPort.h"
+#include "Lacpdu.h"
+
+
+TraceLog::TraceLog()
+{
+}
+
+
+TraceLog::~TraceLog()
+{
+}
+
+bool TraceLog::enabled = false;
+thread_local TraceBuffer* TraceLog::pBuffer = &TraceLog::mainBuffer;
+TraceBuffer TraceLog::mainBuffer;
+std::ofstream TraceLog::traceFile;
+std::thread TraceLog::flusher;
+std::mutex TraceLog::lock;
+std::condition_variable TraceLog::blockReady;
+std::deque<TraceBuffer> TraceLog::fullBlocks;
+std::vector<TraceBuffer> TraceLog::spareBlocks;
+bool TraceLog::shutdown = false;
+
+
+bool TraceLog::open(const std::string& fileName)
+{
+	close();
+
+	traceFile.open(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!traceFile.is_open())
+		return (false);
+
+	unsigned int recordSize = sizeof(TraceRecord);
+	traceFile.write(traceMagic, sizeof(traceMagic));
+	traceFile.write((const char*)&traceVersion, sizeof(traceVersion));
+	traceFile.write((const char*)&recordSize, sizeof(recordSize));
+
+	mainBuffer.clear();
+	mainBuffer.reserve(blockRecords);
+	shutdown = false;
+	flusher = std::thread(&TraceLog::flushLoop);
+	enabled = true;
+
+	return (true);
+}
+
+void TraceLog::close()
+{
+	if (!enabled)
+		return;
+
+	if (!mainBuffer.empty())
+		submit();
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		shutdown = true;
+	}
+	blockReady.notify_one();
+	flusher.join();
+
+	traceFile.close();
+	spareBlocks.clear();
+	enabled = false;
+}
+
+TraceBuffer* TraceLog::redirect(TraceBuffer* pNewBuffer)
+{
+	TraceBuffer* pOldBuffer = pBuffer;
+	pBuffer = pNewBuffer;
+	return (pOldBuffer);
+}
+
+void TraceLog::append(TraceBuffer& capture)
+{
+	if (capture.empty())
+		return;
+
+	mainBuffer.insert(mainBuffer.end(), capture.begin(), capture.end());
+	capture.clear();
+	if (mainBuffer.size() >= blockRecords)
+		submit();
+}
+
+void TraceLog::record(const TraceRecord& rec)
+{
+	pBuffer->push_back(rec);
+	if ((pBuffer == &mainBuffer) && (mainBuffer.size() >= blockRecords))
+		submit();
+}
+
+/*
+*   submit hands the main buffer to the background thread, and replaces it with a buffer the background thread
+*      has already written (if there is one), so once tracing is under way no memory is allocated for the records.
+*/
+void TraceLog::submit()
+{
+	TraceBuffer nextBlock;
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		fullBlocks.push_back(move(mainBuffer));
+		if (!spareBlocks.empty())
+		{
+			nextBlock = move(spareBlocks.back());
+			spareBlocks.pop_back();
+		}
+	}
+	blockReady.notify_one();
+
+	mainBuffer = move(nextBlock);
+	mainBuffer.reserve(blockRecords);
+}
+
+void TraceLog::flushLoop()
+{
+	std::unique_lock<std::mutex> guard(lock);
+	while (true)
+	{
+		blockReady.wait(guard, [] { return (shutdown || !fullBlocks.empty()); });
+		if (fullBlocks.empty())                    // Shut down, and every block has been written
+			break;
+
+		TraceBuffer block = move(fullBlocks.front());
+		fullBlocks.pop_front();
+		guard.unlock();                            // Write without holding the lock so the simulation never waits for the file
+
+		traceFile.write((const char*)block.data(), block.size() * sizeof(TraceRecord));
+		block.clear();
+
+		guard.lock();
+		spareBlocks.push_back(move(block));
+	}
+	traceFile.flush();
+}
+
+
+/*
+*   The frame header is packed as the destination and source addresses followed by one field for each Sdu, 
+*      with the Sdu EtherType in bits 16..31 and either the VLAN tag TCI or the Sdu subType in bits 0..15.
+*/
+void TraceLog::packFrameHeader(TraceRecord& rec, const Frame& frame)
+{
+	const unsigned char maxFields = sizeof(rec.fields) / sizeof(rec.fields[0]);
+
+	rec.fields[0] = frame.MacDA;
+	rec.fields[1] = frame.MacSA;
+	rec.nFields = 2;
+	shared_ptr<Sdu> pSdu = frame.pNextSdu;
+	while (pSdu && (rec.nFields < maxFields))
+	{
+		unsigned short value = pSdu->subType;
+		if ((pSdu->etherType == CVlanEthertype) || (pSdu->etherType == SVlanEthertype))
+			value = ((VlanTag&)(*pSdu)).Vtag.tci;
+		rec.fields[rec.nFields++] = ((unsigned long long)pSdu->etherType << 16) | value;
+		pSdu = pSdu->pNextSdu;
+	}
+}
+
+void TraceLog::lagRxFrame(const AggPort& port, const Frame& frame)
+{
+	TraceRecord rec = {};
+	rec.time = SimLog::Time;
+	rec.event = TraceRecord::LAG_RX_FRAME;
+	rec.device = port.actorSystem.addrMid;
+	rec.port = port.actorPort.num;
+	packFrameHeader(rec, frame);
+	record(rec);
+}
+
+void TraceLog::lagTxFrame(const Aggregator& agg, const Frame& frame)
+{
+	TraceRecord rec = {};
+	rec.time = SimLog::Time;
+	rec.event = TraceRecord::LAG_TX_FRAME;
+	rec.device = agg.actorSystem.addrMid;
+	rec.port = agg.aggregatorIdentifier;
+	packFrameHeader(rec, frame);
+	record(rec);
+}
+
+void TraceLog::lacpPortState(AggPort& port)
+{
+	TraceRecord rec = {};
+	rec.time = SimLog::Time;
+	rec.event = TraceRecord::LACP_PORT_STATE;
+	rec.device = port.get_aAggActorSystemID();
+	rec.port = port.get_aAggPortActorPort();
+	rec.nFields = 4;
+	rec.fields[0] = (unsigned long long)port.RxSmState | ((unsigned long long)port.MuxSmState << 8)
+		| ((unsigned long long)port.PerSmState << 16) | ((unsigned long long)port.TxSmState << 24)
+		| ((unsigned long long)port.portSelected << 32) | ((unsigned long long)port.pIss->getOperational() << 40)
+		| ((unsigned long long)(bool)(port.actorOperPortState.distributing) << 41) | ((unsigned long long)port.NTT << 42);
+	rec.fields[1] = (unsigned int)(int)port.periodicTimer;
+	rec.fields[2] = (unsigned int)(int)port.currentWhileTimer;
+	rec.fields[3] = (unsigned int)(int)port.waitToRestoreTimer;
+	record(rec);
+}
+
+void TraceLog::lacpduRx(const AggPort& port, const Lacpdu& rxLacpdu)
+{
+	TraceRecord rec = {};
+	rec.time = SimLog::Time;
+	rec.event = TraceRecord::LACPDU_RX;
+	rec.device = port.actorSystem.addrMid;
+	rec.port = port.actorPort.num;
+	rec.nFields = 5;
+	rec.fields[0] = (unsigned int)rxLacpdu.TimeStamp | ((unsigned long long)rxLacpdu.portAlgorithmTlv << 32)
+		| ((unsigned long long)rxLacpdu.portConversationIdDigestTlv << 33)
+		| ((unsigned long long)rxLacpdu.portConversationServiceMappingDigestTlv << 34)
+		| ((unsigned long long)rxLacpdu.portConversationMaskTlvs << 35);
+	rec.fields[1] = rxLacpdu.actorSystem.id;
+	rec.fields[2] = (unsigned long long)rxLacpdu.actorPort.id | ((unsigned long long)rxLacpdu.actorKey << 32)
+		| ((unsigned long long)rxLacpdu.actorState.state << 48);
+	rec.fields[3] = rxLacpdu.partnerSystem.id;
+	rec.fields[4] = (unsigned long long)rxLacpdu.partnerPort.id | ((unsigned long long)rxLacpdu.partnerKey << 32)
+		| ((unsigned long long)rxLacpdu.partnerState.state << 48);
+	record(rec);
+}
+
+
@@ -0,0 +1,112 @@
+/*
+Copyright 2017 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#pragma once
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include "Frame.h"
+
+class Aggregator;
+class AggPort;
+class Lacpdu;
+
+
+/*
+*   Struct TraceRecord is one event in the binary trace log:  the Time, the device and port it happened at, what kind of
+*       event it was, and up to six fields whose meaning depends on the event.  Records are a fixed 64 octets so a
+*       buffer of them can be written to (and read from) the trace file without any formatting.
+*/
+/**/
+struct TraceRecord
+{
+	enum events : unsigned char { NO_EVENT, LAG_RX_FRAME, LAG_TX_FRAME, LACP_PORT_STATE, LACPDU_RX };
+
+	int time;
+	events event;
+	unsigned char nFields;
+	unsigned short port;                 // Port number or Aggregator identifier
+	unsigned long long device;           // System address (middle bits) or full System ID
+	unsigned long long fields[6];
+};
+/**/
+
+typedef std::vector<TraceRecord> TraceBuffer;
+
+/*
+*   Class TraceLog is the binary alternative to writing debug messages to SimLog::logFile.  Formatting text with iostreams
+*       dominates the run time of large simulations at high SimLog::Debug levels, so when a trace file is open the busiest
+*       messages (frames received and transmitted by Link Aggregation, the per-port state machine summary, and received
+*       LACPDUs) are instead recorded as TraceRecords.  decode() turns a trace file back into the text those messages
+*       would have written to the log file.
+*   Records go into the buffer of the thread that records them without taking any lock.  The main thread's buffer is
+*       handed to a background thread that writes it to the trace file each time it fills.  While Devices run in parallel
+*       each thread records to the buffer of the Device it is running (see redirect), and Device::tick appends those
+*       buffers to the main buffer in Device order, so the trace file is the same for any number of threads.
+*   The trace file is a short header followed by the records exactly as they are in memory, so it is read back by a
+*       TraceDecoder built for the same platform.  decode() and print() are in TraceDecode.cpp, which TraceDecoder is
+*       built from, so decoding does not run the simulator (or rewrite its log file).
+*/
+/**/
+class TraceLog
+{
+public:
+	TraceLog();
+	~TraceLog();
+	TraceLog(TraceLog& copySource) = delete;             // Disable copy constructor
+	TraceLog& operator= (const TraceLog&) = delete;      // Disable assignment operator
+
+	static bool enabled;                                  // True while a trace file is open
+
+	static bool open(const std::string& fileName);       // Start tracing to fileName (returns false if it can't be created)
+	static void close();                                  // Write any buffered records and stop tracing
+
+	static TraceBuffer* redirect(TraceBuffer* pNewBuffer);   // Record this thread's events to pNewBuffer; returns the previous buffer
+	static void append(TraceBuffer& capture);                // Move records captured while running in parallel to the main buffer
+
+	static void lagRxFrame(const AggPort& port, const Frame& frame);
+	static void lagTxFrame(const Aggregator& agg, const Frame& frame);
+	static void lacpPortState(AggPort& port);
+	static void lacpduRx(const AggPort& port, const Lacpdu& rxLacpdu);
+
+	static int decode(const std::string& fileName, std::ostream& out);   // Returns the number of records decoded (-1 if not a trace file)
+	static void print(const TraceRecord& rec, std::ostream& out);        // Writes the text message for one record
+
+private:
+	static const size_t blockRecords = 4096;             // Records in a buffer handed to the background thread
+	static const char traceMagic[8];                      // First octets of a trace file
+	static const unsigned int traceVersion = 1;
+
+	static void record(const TraceRecord& rec);
+	static void packFrameHeader(TraceRecord& rec, const Frame& frame);
+	static void printFrameHeader(const TraceRecord& rec, std::ostream& out);
+	static void submit();
+	static void flushLoop();
+
+	static thread_local TraceBuffer* pBuffer;
+	static TraceBuffer mainBuffer;
+	static std::ofstream traceFile;
+	static std::thread flusher;
+	static std::mutex lock;
+	static std::condition_variable blockReady;
+	static std::deque<TraceBuffer> fullBlocks;           // Waiting to be written by the background thread
+	static std::vector<TraceBuffer> spareBlocks;         // Written and ready to be reused
+	static bool shutdown;
+};
+/**/
@@ -0,0 +1,122 @@
+/*
+Copyright 2017 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include "stdafx.h"
+#include "Trace.h"
+
+
+/*
+*   The functions that read a trace file back are kept apart from the rest of TraceLog so that the TraceDecoder tool
+*       can be built from this file and stdafx.cpp, without the simulation.
+*/
+const char TraceLog::traceMagic[8] = { 'L', 'A', 'G', 'T', 'R', 'A', 'C', 'E' };
+const unsigned int TraceLog::traceVersion;
+
+
+int TraceLog::decode(const std::string& fileName, std::ostream& out)
+{
+	std::ifstream inFile(fileName, std::ios::in | std::ios::binary);
+	char magic[sizeof(traceMagic)];
+	unsigned int version = 0;
+	unsigned int recordSize = 0;
+
+	inFile.read(magic, sizeof(magic));
+	inFile.read((char*)&version, sizeof(version));
+	inFile.read((char*)&recordSize, sizeof(recordSize));
+	if (!inFile || !std::equal(magic, magic + sizeof(magic), traceMagic) ||
+		(version != traceVersion) || (recordSize != sizeof(TraceRecord)))
+		return (-1);
+
+	int count = 0;
+	TraceBuffer block(blockRecords);
+	while (inFile)
+	{
+		inFile.read((char*)block.data(), block.size() * sizeof(TraceRecord));
+		size_t nRecords = (size_t)inFile.gcount() / sizeof(TraceRecord);
+		for (size_t i = 0; i < nRecords; i++)
+			print(block[i], out);
+		count += nRecords;
+	}
+	out.flush();
+
+	return (count);
+}
+
+void TraceLog::printFrameHeader(const TraceRecord& rec, std::ostream& out)     // Same text as Frame::PrintFrameHeader
+{
+	out << hex << rec.fields[0] << ":" << rec.fields[1];
+	for (unsigned char i = 2; i < rec.nFields; i++)
+	{
+		unsigned short etherType = (unsigned short)(rec.fields[i] >> 16);
+		unsigned short value = (unsigned short)rec.fields[i];
+		if (etherType == CVlanEthertype) out << ":CVtag=" << value;
+		else if (etherType == SVlanEthertype) out << ":SVtag=" << value;
+		else out << ":" << etherType << ":" << (short)value;
+	}
+	out << dec;
+}
+
+/*
+*   print writes the same text that the code recording each event writes to SimLog::logFile when not tracing.
+*/
+void TraceLog::print(const TraceRecord& rec, std::ostream& out)
+{
+	switch (rec.event)
+	{
+	case TraceRecord::LAG_RX_FRAME:
+		out << "Time " << rec.time << "    Lag in Device:Port " << hex << rec.device << ":" << rec.port << " receiving frame ";
+		printFrameHeader(rec, out);
+		out << dec << endl;
+		break;
+	case TraceRecord::LAG_TX_FRAME:
+		out << "Time " << rec.time << ":   Device:Aggregator " << hex << rec.device << ":" << rec.port << " transmitting frame ";
+		printFrameHeader(rec, out);
+		out << dec << endl;
+		break;
+	case TraceRecord::LACP_PORT_STATE:
+		out << "Time " << rec.time << ":  Sys " << hex << rec.device << ":  Port " << hex << rec.port << dec
+			<< ": RxSM " << (rec.fields[0] & 0xff) << " MuxSM " << ((rec.fields[0] >> 8) & 0xff)
+			<< " PerSM " << ((rec.fields[0] >> 16) & 0xff) << " TxSM " << ((rec.fields[0] >> 24) & 0xff)
+			<< " PerT " << (int)rec.fields[1] << " RxT " << (int)rec.fields[2]
+			<< " WtrT " << (int)rec.fields[3]
+			<< " Up " << ((rec.fields[0] >> 40) & 1)
+			<< " Sel " << ((rec.fields[0] >> 32) & 0xff)
+			<< " Dist " << ((rec.fields[0] >> 41) & 1)
+			<< " NTT " << ((rec.fields[0] >> 42) & 1)
+			<< endl;
+		break;
+	case TraceRecord::LACPDU_RX:
+		out << "Time " << rec.time << ":  Device:Port " << hex << rec.device << ":" << rec.port
+			<< " received LACPDU sent at time " << dec << (int)rec.fields[0];
+		if ((rec.fields[0] >> 32) & 1) out << "  AlgTlv";
+		if ((rec.fields[0] >> 33) & 1) out << "  ConvDigTlv";
+		if ((rec.fields[0] >> 34) & 1) out << "  SvcDigTlv";
+		if ((rec.fields[0] >> 35) & 1) out << "  ConvMaskTlv";
+		out << endl;
+		out << "     Actor : " << hex << rec.fields[1] << ":" << (rec.fields[2] & 0xffffffff)
+			<< "  Key " << ((rec.fields[2] >> 32) & 0xffff) << "  sync " << ((rec.fields[2] >> 51) & 1)
+			<< "  coll " << ((rec.fields[2] >> 52) & 1) << "  dist " << ((rec.fields[2] >> 53) & 1);
+		out << dec << endl;
+		out << "   Partner : " << hex << rec.fields[3] << ":" << (rec.fields[4] & 0xffffffff)
+			<< "  Key " << ((rec.fields[4] >> 32) & 0xffff) << "  sync " << ((rec.fields[4] >> 51) & 1)
+			<< "  coll " << ((rec.fields[4] >> 52) & 1) << "  dist " << ((rec.fields[4] >> 53) & 1) << dec << endl;
+		break;
+	default:
+		out << "Time " << rec.time << ":  Unknown trace event " << (int)rec.event << endl;
+		break;
+	}
+}
@@ -0,0 +1,202 @@
+/*
+Copyright 2017 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include "stdafx.h"
+#include "Traffic.h"
+#include <cmath>
+
+
+
+TrafficFlow::TrafficFlow(unsigned long long flowDA, unsigned long long flowSA, unsigned short flowVid, unsigned short flowPriority)
+{
+	MacDA = flowDA;
+	MacSA = flowSA;
+	flowId = 0;
+	vid = flowVid;
+	vlanType = CVlanEthertype;
+	priority = flowPriority;
+	arrivalType = CONSTANT;
+	interval = 1;
+	burstSize = 1;
+	frameBudget = 0;
+	seed = 1;
+
+	dueTime = SimLog::Never;
+	poissonTime = 0;
+	burstRemaining = 0;
+	framesGenerated = 0;
+	sequenceNumber = 0;
+	randomState = seed;
+}
+
+TrafficFlow::~TrafficFlow()
+{
+}
+
+void TrafficFlow::start(int startTime)
+{
+	framesGenerated = 0;
+	randomState = seed;
+	burstRemaining = burstSize;
+	dueTime = startTime;
+	poissonTime = startTime;
+	if (arrivalType == POISSON)
+	{
+		poissonTime += poissonGap();
+		dueTime = (int)poissonTime;
+	}
+}
+
+void TrafficFlow::stop()
+{
+	dueTime = SimLog::Never;
+}
+
+int TrafficFlow::nextDue() const
+{
+	if (frameBudget && (framesGenerated >= frameBudget))
+		return (SimLog::Never);
+	return (dueTime);
+}
+
+unsigned int TrafficFlow::getFramesGenerated() const
+{
+	return (framesGenerated);
+}
+
+unique_ptr<Frame> TrafficFlow::nextFrame()
+{
+	shared_ptr<Sdu> pSdu = FramePool::makeShared<TestSdu>(sequenceNumber++, flowId);
+	unique_ptr<Frame> pFrame = make_unique<Frame>(MacDA, MacSA, move(pSdu));
+	if (vid)
+		pFrame = pFrame->InsertTag(FramePool::makeShared<VlanTag>(vlanType, vid, priority));
+	pFrame->Priority = priority;
+	pFrame->TimeStamp = SimLog::Time;
+	framesGenerated++;
+
+	switch (arrivalType)                             // Schedule the next frame
+	{
+	case POISSON:
+		poissonTime += poissonGap();
+		dueTime = std::max(dueTime, (int)poissonTime);
+		break;
+	case BURST:
+		if (--burstRemaining > 0)
+			break;                                   // Rest of burst is due now
+		burstRemaining = burstSize;
+		dueTime += std::max(interval, 1);
+		break;
+	default:
+		dueTime += std::max(interval, 1);
+		break;
+	}
+	return (pFrame);
+}
+
+double TrafficFlow::poissonGap()
+{
+	randomState = (randomState * 1664525) + 1013904223;          // 32 bit linear congruential generator (same on every platform)
+	double uniform = (randomState + 0.5) / 4294967296.0;         // (0,1)
+	return (-log(uniform) * std::max(interval, 1));
+}
+
+
+
+FlowRxStats::FlowRxStats()
+	: received(0), duplicates(0), outOfOrder(0), highestSequence(-1)
+{
+	for (auto& count : latency)
+		count = 0;
+}
+
+FlowRxStats::~FlowRxStats()
+{
+}
+
+void FlowRxStats::record(int sequenceNumber, int frameLatency)
+{
+	received.fetch_add(1, std::memory_order_relaxed);
+	if (sequenceNumber < 0)
+		return;
+
+	size_t word = sequenceNumber / 64;
+	unsigned long long bit = 1ULL << (sequenceNumber % 64);
+	if (word >= seen.size())
+		seen.resize(std::max(word + 1, 2 * seen.size()), 0);
+	if (seen[word] & bit)
+	{
+		duplicates.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+	seen[word] |= bit;
+
+	if (sequenceNumber < highestSequence.load(std::memory_order_relaxed))
+		outOfOrder.fetch_add(1, std::memory_order_relaxed);
+	else
+		highestSequence.store(sequenceNumber, std::memory_order_relaxed);
+
+	int bucket = 0;
+	while ((bucket < latencyBuckets - 1) && (frameLatency >= (1 << bucket)))
+		bucket++;
+	latency[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+unsigned long FlowRxStats::getReceived() const
+{
+	return (received.load(std::memory_order_relaxed));
+}
+
+unsigned long FlowRxStats::getLost() const
+{
+	long expected = highestSequence.load(std::memory_order_relaxed) + 1;
+	long unique = getReceived() - getDuplicates();
+	return ((expected > unique) ? (expected - unique) : 0);
+}
+
+unsigned long FlowRxStats::getDuplicates() const
+{
+	return (duplicates.load(std::memory_order_relaxed));
+}
+
+unsigned long FlowRxStats::getOutOfOrder() const
+{
+	return (outOfOrder.load(std::memory_order_relaxed));
+}
+
+unsigned long FlowRxStats::getLatencyCount(int bucket) const
+{
+	if ((bucket < 0) || (bucket >= latencyBuckets))
+		return (0);
+	return (latency[bucket].load(std::memory_order_relaxed));
+}
+
+void FlowRxStats::print(std::ostream& out) const
+{
+	out << "received " << getReceived() << "  lost " << getLost() << "  duplicates " << getDuplicates()
+		<< "  out of order " << getOutOfOrder() << endl << "       latency:";
+	for (int bucket = 0; bucket < latencyBuckets; bucket++)
+	{
+		if (getLatencyCount(bucket))
+		{
+			if (bucket < latencyBuckets - 1)
+				out << "  <" << (1 << bucket) << ":" << getLatencyCount(bucket);
+			else
+				out << "  >=" << (1 << (bucket - 1)) << ":" << getLatencyCount(bucket);
+		}
+	}
+	out << endl;
+}
@@ -0,0 +1,117 @@
+/*
+Copyright 2017 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#pragma once
+#include <atomic>
+#include "Frame.h"
+
+
+/*
+*   Class TrafficFlow generates a stream of test frames with the same addresses, VLAN, and priority.
+*       A flow is added to an End Station (EndStn::addFlow), which transmits the flow's frames as they become due.
+*   Frame arrivals can be:
+*       -- CONSTANT:  one frame every interval ticks.
+*       -- POISSON:  exponentially distributed gaps with a mean of interval ticks (so several frames can be due in one tick).
+*       -- BURST:  burstSize back-to-back frames every interval ticks.
+*   The flow stops after frameBudget frames (zero for no limit).  The Poisson gaps come from a generator seeded by the 
+*       flow's seed, so a simulation with Poisson flows is repeatable.
+*   Each frame carries a TestSdu with the flow's flowId and sequence number, behind a VLAN tag of vlanType if vid is non-zero.
+*       Sequence numbers continue across a restart, so a receiver sees one stream however often the flow is started.
+*       Frames and Sdus come from the FramePool, so a running flow does not allocate from the heap.
+*/
+/**/
+class TrafficFlow
+{
+public:
+	enum arrivals { CONSTANT, POISSON, BURST };
+
+	TrafficFlow(unsigned long long flowDA, unsigned long long flowSA, unsigned short flowVid = 0, unsigned short flowPriority = 0);
+	~TrafficFlow();
+	TrafficFlow(TrafficFlow& copySource) = delete;             // Disable copy constructor
+	TrafficFlow& operator= (const TrafficFlow&) = delete;      // Disable assignment operator
+
+	unsigned long long MacDA;
+	unsigned long long MacSA;
+	unsigned short flowId;           // Distinguishes flows from the same source (EndStn::addFlow numbers them from 1)
+	unsigned short vid;              // VLAN Identifier (0 for untagged frames)
+	unsigned short vlanType;         // Tag type when vid is non-zero
+	unsigned short priority;
+	arrivals arrivalType;
+	int interval;                    // Ticks between frames (CONSTANT), mean ticks between frames (POISSON), or between bursts (BURST)
+	int burstSize;                   // Frames per burst (BURST)
+	unsigned int frameBudget;        // Total frames to generate (0 for no limit)
+	unsigned int seed;               // Seed for POISSON arrivals
+
+	void start(int startTime);       // Schedule the first frame (and restart the budget)
+	void stop();
+	int nextDue() const;             // Time the next frame is due (Never if stopped or the budget is used up)
+	unique_ptr<Frame> nextFrame();   // Builds the next frame and schedules the one after it
+	unsigned int getFramesGenerated() const;   // Including frames discarded because the End Station's port was down
+
+private:
+	int dueTime;
+	double poissonTime;              // Arrival time of the next POISSON frame before rounding to a tick
+	int burstRemaining;              // Frames left in the current burst
+	unsigned int framesGenerated;
+	int sequenceNumber;
+	unsigned int randomState;
+
+	double poissonGap();             // Next exponentially distributed gap (in ticks, before rounding)
+};
+/**/
+
+
+/*
+*   Class FlowRxStats accumulates the receive statistics of one flow of test frames at an End Station, where a flow is 
+*       identified by source address, flowId, and VLAN Identifier and its frames are numbered by the sequence number in the TestSdu.
+*   For each frame received it counts:
+*       -- duplicates:  a sequence number that has already been received.
+*       -- outOfOrder:  a sequence number lower than one already received (and not a duplicate).
+*       -- latency:  ticks from creation of the TestSdu to reception, in a histogram with power of two buckets.
+*   Frames lost are the sequence numbers up to the highest received that have not been received (a frame still in
+*       flight counts as lost until it arrives).
+*   Only the End Station's own thread records frames, but the counters are atomic so they can be read from another
+*       thread while Devices are running in parallel.
+*/
+/**/
+class FlowRxStats
+{
+public:
+	FlowRxStats();
+	~FlowRxStats();
+	FlowRxStats(FlowRxStats& copySource) = delete;             // Disable copy constructor
+	FlowRxStats& operator= (const FlowRxStats&) = delete;      // Disable assignment operator
+
+	static const int latencyBuckets = 16;    // Bucket 0 counts latency 0, bucket k counts [2^(k-1), 2^k), last bucket counts the rest
+
+	void record(int sequenceNumber, int latency);
+	unsigned long getReceived() const;
+	unsigned long getLost() const;
+	unsigned long getDuplicates() const;
+	unsigned long getOutOfOrder() const;
+	unsigned long getLatencyCount(int bucket) const;
+	void print(std::ostream& out) const;
+
+private:
+	std::atomic<unsigned long> received;
+	std::atomic<unsigned long> duplicates;
+	std::atomic<unsigned long> outOfOrder;
+	std::atomic<long> highestSequence;           // -1 until a frame is received
+	std::array<std::atomic<unsigned long>, latencyBuckets> latency;
+	std::vector<unsigned long long> seen;        // Bit set for each sequence number received
+};
+/**/
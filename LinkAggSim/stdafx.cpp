@@ -15,8 +15,11 @@ SimLog::~SimLog()
 
 // SimLog;  // init globals: Time and logfile
 int SimLog::Time = 0;
+const int SimLog::Never;
 int SimLog::Debug = 0;
-std::ofstream SimLog::logFile("LinkAggSim output.txt");
+std::ofstream SimLog::outputFile;     // Opened by the simulator's main, so TraceDecoder does not rewrite it
+thread_local std::ostream SimLog::logFile(SimLog::outputFile.rdbuf());
+thread_local std::ostream SimLog::console(std::cout.rdbuf());
 
 
 // TODO: reference any additional headers you need in STDAFX.H
@@ -22,7 +22,12 @@
 #include <list>
 #include <bitset>
 #include <map>
+#include <unordered_map>
+#include <set>
+#include <tuple>
 #include <string>
+#include <algorithm>
+#include <sstream>
 
 
 using std::cout;
@@ -39,9 +44,22 @@ using std::move;
 /*
 *   Class SimLog contains static variables to have global scope in the simulation:
 *      -- Time:  Each time increment is one single-step of the simulation.  No direct correlation to any unit of real time.
-*      -- logFile:  a text file for messages regarding events in the simulation.
+*      -- outputFile:  a text file for messages regarding events in the simulation (opened when the simulation starts).
+*      -- logFile:  the stream messages for outputFile are written to.  It is per-thread so that when Devices run in
+*            parallel each Device's messages can be captured and then written to outputFile in Device order (see Device::tick).
+*      -- console:  the stream for messages to the console window, per-thread for the same reason.
+*      -- Never:  a Time that is never reached, returned as the wakeup time of a component with nothing scheduled.
+*      -- Debug:  the level of detail of the messages written to logFile.  Code that writes a message at level N
+*            tests debug<N>(), which is true when Debug is greater than N.
+*      -- MaxDebug:  the greatest Debug level a build can use, set at compile time by SIMLOG_MAX_DEBUG.
+*            debug<N>() is the constant false for any N at or above MaxDebug, so the compiler removes those messages
+*            entirely.  The Release configuration sets MaxDebug to the level the test program runs at.
 */
 /**/
+#ifndef SIMLOG_MAX_DEBUG
+#define SIMLOG_MAX_DEBUG 100
+#endif
+
 class SimLog
 {
 public:
@@ -49,8 +67,17 @@ public:
 	~SimLog();
 
 	static int Time;
-	static std::ofstream logFile;
+	static const int Never = 0x7fffffff;
+	static std::ofstream outputFile;
+	static thread_local std::ostream logFile;
+	static thread_local std::ostream console;
 	static int Debug;
+	static const int MaxDebug = SIMLOG_MAX_DEBUG;
+
+	template <int level> static bool debug()
+	{
+		return ((level < MaxDebug) && (Debug > level));
+	}
 };
 /**/
 
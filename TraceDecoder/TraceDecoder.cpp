@@ -0,0 +1,45 @@
+/*
+Copyright 2017 Stephen Haddock Consulting, LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+// TraceDecoder.cpp : Defines the entry point for the trace decoder console application.
+//
+
+#include "stdafx.h"
+#include "Trace.h"
+
+
+int _tmain(int argc, _TCHAR* argv[])
+{
+	//
+	//  TraceDecoder <file> writes the messages in a trace file recorded by "LinkAggSim -trace <file>" to the console,
+	//      in the same text the simulator writes to its log file when it is not tracing.  It is a separate program so
+	//      that decoding a trace does not rewrite the log file of the traced run.
+	//
+	if (argc != 2)
+	{
+		std::cerr << "Usage:  TraceDecoder <trace file>" << endl;
+		return (1);
+	}
+	std::basic_string<_TCHAR> value(argv[1]);
+	std::string fileName(value.begin(), value.end());
+
+	int nRecords = TraceLog::decode(fileName, cout);
+	if (nRecords < 0)
+		std::cerr << fileName << " is not a trace file" << endl;
+	return (nRecords < 0);
+}
+